@@ -0,0 +1,154 @@
+// =============================================
+// File: BackgroundIO.cpp
+// Category: Main Loader Orchestration
+// Purpose: Implements the bounded background I/O job queue and its worker thread.
+// =============================================
+#include "BackgroundIO.h"
+#include "Logger.h"
+#include "ModuleThread.h"
+#include <windows.h>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <algorithm>
+
+namespace {
+    constexpr size_t MAX_PENDING_JOBS = 64;
+
+    struct Job {
+        std::string name;
+        std::function<bool()> task;
+    };
+
+    std::mutex g_laneMutex;
+    std::condition_variable g_laneChanged;
+    std::deque<Job> g_pending;
+    BackgroundIOStats g_stats;
+    size_t g_holds = 0;
+    bool g_running = false;         // A job is executing
+    bool g_stopping = false;
+    bool g_laneAlive = false;       // The lane thread exists (and holds the module)
+
+    void runJob(Job& job) {
+        auto start = std::chrono::steady_clock::now();
+        bool succeeded = false;
+        try {
+            succeeded = job.task();
+        }
+        catch (const std::exception& e) {
+            log("Background job '" + job.name + "' threw: " + e.what(), LOG_WARNING, "BackgroundIO");
+        }
+        catch (...) {
+            log("Background job '" + job.name + "' threw an unknown error", LOG_WARNING, "BackgroundIO");
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        {
+            std::lock_guard<std::mutex> lock(g_laneMutex);
+            g_running = false;
+            if (succeeded) g_stats.completed++;
+            else g_stats.failed++;
+        }
+        g_laneChanged.notify_all();
+
+        if (succeeded) {
+            LOG_AT(LOG_DEBUG, "BackgroundIO", "Background job '", job.name, "' done in ", static_cast<long long>(elapsed.count()), " ms");
+        }
+        else {
+            log("Background job '" + job.name + "' failed", LOG_WARNING, "BackgroundIO");
+        }
+    }
+
+    void laneMain() {
+        // Lowers both CPU and I/O priority, so the game's own reads go first
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(g_laneMutex);
+                g_laneChanged.wait(lock, []() { return g_stopping || g_pending.empty() || g_holds == 0; });
+                if (g_stopping || g_pending.empty()) {
+                    // Leave once idle, taking the lane's reference on the module
+                    // with it, so a FreeLibrary after startup can unload the DLL;
+                    // the next submit starts a new lane
+                    g_laneAlive = false;
+                    return;
+                }
+                job = std::move(g_pending.front());
+                g_pending.pop_front();
+                g_running = true;
+            }
+            runJob(job);
+        }
+    }
+}
+
+bool submitBackgroundJob(const std::string& name, std::function<bool()> task) {
+    {
+        std::lock_guard<std::mutex> lock(g_laneMutex);
+        // The newer closure captured the newer state (config, file list), so
+        // it replaces the waiting one and keeps that job's place in the queue
+        auto queued = std::find_if(g_pending.begin(), g_pending.end(), [&](const Job& job) { return job.name == name; });
+        if (queued != g_pending.end()) {
+            queued->task = std::move(task);
+            g_stats.replaced++;
+            LOG_AT(LOG_TRACE, "BackgroundIO", "Background job replaced while queued: ", name);
+            return true;
+        }
+        // The lane holds a reference on the module while it runs, so detach
+        // never has to wait for it (see startModuleThread)
+        if (!g_stopping && !g_laneAlive && g_pending.size() < MAX_PENDING_JOBS) {
+            g_laneAlive = startModuleThread(laneMain);
+        }
+        if (!g_laneAlive || g_stopping || g_pending.size() >= MAX_PENDING_JOBS) {
+            g_stats.rejected++;
+            LOG_AT(LOG_DEBUG, "BackgroundIO", "Background job not queued: ", name);
+            return false;
+        }
+        g_pending.push_back(Job{ name, std::move(task) });
+    }
+    g_laneChanged.notify_all();
+    return true;
+}
+
+BackgroundIOHold::BackgroundIOHold() {
+    std::lock_guard<std::mutex> lock(g_laneMutex);
+    g_holds++;
+}
+
+BackgroundIOHold::~BackgroundIOHold() {
+    {
+        std::lock_guard<std::mutex> lock(g_laneMutex);
+        g_holds--;
+    }
+    g_laneChanged.notify_all();
+}
+
+void stopBackgroundIO() {
+    {
+        std::lock_guard<std::mutex> lock(g_laneMutex);
+        if (g_stopping) {
+            return;
+        }
+        g_stopping = true;
+        g_stats.cancelled += g_pending.size();
+        if (!g_pending.empty()) {
+            LOG_AT(LOG_DEBUG, "BackgroundIO", "Cancelled ", g_pending.size(), " background job(s) at shutdown");
+        }
+        g_pending.clear();
+    }
+    g_laneChanged.notify_all();
+}
+
+bool waitForBackgroundIdle(unsigned int timeoutMs) {
+    std::unique_lock<std::mutex> lock(g_laneMutex);
+    return g_laneChanged.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+        []() { return !g_running && (g_pending.empty() || g_stopping); });
+}
+
+BackgroundIOStats getBackgroundIOStats() {
+    std::lock_guard<std::mutex> lock(g_laneMutex);
+    return g_stats;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+// =============================================
+// File: BackgroundIO.h
+// Category: Main Loader Orchestration
+// Purpose: Declares the low-priority lane for backups and other non-critical file work.
+// =============================================
+#pragma once
+#include <functional>
+#include <string>
+
+// Queues a job on the background I/O lane: one thread at background CPU and
+// I/O priority, started when a job is queued and gone once the queue is
+// empty. It holds a reference on the DLL while it exists (startModuleThread),
+// so an unload never pulls code out from under a job. Never blocks. Returns false when the
+// job will not run (queue full, lane stopped or not startable). A job named
+// like one still waiting replaces that job's task in place. The task returns
+// its success.
+bool submitBackgroundJob(const std::string& name, std::function<bool()> task);
+
+// While any hold exists, queued jobs wait instead of starting, so the lane
+// never competes with startup for the disk or the backup store lock
+class BackgroundIOHold {
+public:
+    BackgroundIOHold();
+    ~BackgroundIOHold();
+    BackgroundIOHold(const BackgroundIOHold&) = delete;
+    BackgroundIOHold& operator=(const BackgroundIOHold&) = delete;
+};
+
+// Drops every job that has not started and stops the lane without waiting
+// (call from DLL_PROCESS_DETACH). A job already running is left to finish, or
+// to die with the process; its files are written atomically either way.
+void stopBackgroundIO();
+
+// Blocks until no job is queued or running, or the timeout elapses
+bool waitForBackgroundIdle(unsigned int timeoutMs);
+
+struct BackgroundIOStats {
+    size_t completed = 0;
+    size_t failed = 0;
+    size_t cancelled = 0;       // Dropped by stopBackgroundIO()
+    size_t rejected = 0;        // Refused by submitBackgroundJob()
+    size_t replaced = 0;        // Queued tasks superseded by a newer one of the same name
+};
+
+BackgroundIOStats getBackgroundIOStats();
\ No newline at end of file
@@ -0,0 +1,250 @@
+// =============================================
+// File: BackupDelta.cpp
+// Category: HKS Backup Store
+// Purpose: Implements content-defined chunking and the delta encoder/decoder.
+// =============================================
+#include "BackupDelta.h"
+#include "ContentHash.h"
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    // "LLDELTA1" + base hash (hex) + varint base size + varint target size, then ops
+    constexpr std::string_view DELTA_MAGIC = "LLDELTA1";
+    constexpr size_t HASH_HEX_LENGTH = 32;
+    constexpr char OP_COPY = 'C';       // varint base offset, varint length
+    constexpr char OP_LITERAL = 'L';    // varint length, bytes
+
+    // Chunk boundaries: ~320 bytes on average, never shorter than 64 bytes or
+    // longer than 4 KB. Small chunks keep two nearby edits from hiding the
+    // unchanged lines between them.
+    constexpr size_t MIN_CHUNK = 64;
+    constexpr size_t MAX_CHUNK = 4096;
+    // Bit k of the gear hash only sees the last k+1 bytes, so test the top
+    // bits; low bits would repeat on every run of similar text
+    constexpr std::uint64_t BOUNDARY_MASK = ((1ULL << 8) - 1) << 56;
+
+    // Random per-byte values for the gear rolling hash (splitmix64 sequence)
+    constexpr std::array<std::uint64_t, 256> makeGearTable() {
+        std::array<std::uint64_t, 256> table{};
+        std::uint64_t state = 0x4C75614C6F616465ULL;
+        for (auto& value : table) {
+            state += 0x9E3779B97F4A7C15ULL;
+            std::uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            value = z ^ (z >> 31);
+        }
+        return table;
+    }
+    constexpr std::array<std::uint64_t, 256> GEAR = makeGearTable();
+
+    // Length of the chunk starting at data[0]. The gear hash only depends on
+    // the last 64 bytes, so boundaries move with the content, not the offset.
+    size_t nextChunkLength(std::string_view data) {
+        if (data.size() <= MIN_CHUNK) {
+            return data.size();
+        }
+        size_t limit = data.size() < MAX_CHUNK ? data.size() : MAX_CHUNK;
+        std::uint64_t hash = 0;
+        for (size_t i = 0; i < limit; ++i) {
+            hash = (hash << 1) + GEAR[static_cast<unsigned char>(data[i])];
+            if (i >= MIN_CHUNK && (hash & BOUNDARY_MASK) == 0) {
+                return i + 1;
+            }
+        }
+        return limit;
+    }
+
+    struct Range {
+        size_t offset;
+        size_t length;
+    };
+
+    // Copy ops refer to base offsets, literal ops to target offsets
+    struct Op {
+        bool copy;
+        size_t offset;
+        size_t length;
+    };
+
+    void putVarint(std::string& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    bool getVarint(std::string_view& in, std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+            auto byte = static_cast<unsigned char>(in.front());
+            in.remove_prefix(1);
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void pushOp(std::vector<Op>& ops, bool copy, size_t offset, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        if (!ops.empty() && ops.back().copy == copy && ops.back().offset + ops.back().length == offset) {
+            ops.back().length += length;
+            return;
+        }
+        ops.push_back({ copy, offset, length });
+    }
+
+    // Chunk matches stop at chunk edges; grow each copy into the literal
+    // bytes around it so only the bytes that really changed stay literal.
+    void tightenLiterals(std::vector<Op>& ops, std::string_view base, std::string_view target) {
+        for (size_t i = 0; i < ops.size(); ++i) {
+            Op& literal = ops[i];
+            if (literal.copy) {
+                continue;
+            }
+            if (i > 0) {
+                Op& before = ops[i - 1];
+                while (literal.length > 0 && before.offset + before.length < base.size() &&
+                    base[before.offset + before.length] == target[literal.offset]) {
+                    ++before.length;
+                    ++literal.offset;
+                    --literal.length;
+                }
+            }
+            if (i + 1 < ops.size()) {
+                Op& after = ops[i + 1];
+                while (literal.length > 0 && after.offset > 0 &&
+                    base[after.offset - 1] == target[literal.offset + literal.length - 1]) {
+                    --after.offset;
+                    ++after.length;
+                    --literal.length;
+                }
+            }
+        }
+    }
+}
+
+std::string encodeDelta(const std::string& baseHash, std::string_view base, std::string_view target) {
+    // Index base chunks by content; the first occurrence wins
+    std::unordered_map<std::uint64_t, Range> index;
+    index.reserve(base.size() / 256 + 1);
+    for (size_t offset = 0; offset < base.size();) {
+        size_t length = nextChunkLength(base.substr(offset));
+        index.emplace(hashBuffer(base.data() + offset, length).low, Range{ offset, length });
+        offset += length;
+    }
+
+    std::vector<Op> ops;
+    for (size_t offset = 0; offset < target.size();) {
+        size_t length = nextChunkLength(target.substr(offset));
+        auto it = index.find(hashBuffer(target.data() + offset, length).low);
+        bool matched = it != index.end() && it->second.length == length &&
+            std::memcmp(base.data() + it->second.offset, target.data() + offset, length) == 0;
+        if (matched) {
+            pushOp(ops, true, it->second.offset, length);
+        }
+        else {
+            pushOp(ops, false, offset, length);
+        }
+        offset += length;
+    }
+    tightenLiterals(ops, base, target);
+
+    std::string delta(DELTA_MAGIC);
+    delta += baseHash;
+    putVarint(delta, base.size());
+    putVarint(delta, target.size());
+    for (const Op& op : ops) {
+        if (op.length == 0) {
+            continue;
+        }
+        if (op.copy) {
+            delta.push_back(OP_COPY);
+            putVarint(delta, op.offset);
+            putVarint(delta, op.length);
+        }
+        else {
+            delta.push_back(OP_LITERAL);
+            putVarint(delta, op.length);
+            delta.append(target.data() + op.offset, op.length);
+        }
+    }
+    return delta;
+}
+
+bool readDeltaBase(std::string_view delta, std::string& outBaseHash) {
+    if (delta.size() < DELTA_MAGIC.size() + HASH_HEX_LENGTH || delta.substr(0, DELTA_MAGIC.size()) != DELTA_MAGIC) {
+        return false;
+    }
+    outBaseHash = std::string(delta.substr(DELTA_MAGIC.size(), HASH_HEX_LENGTH));
+    return true;
+}
+
+bool applyDelta(std::string_view base, std::string_view delta,
+    const std::function<bool(std::string_view piece)>& write, std::string& outError) {
+    std::string baseHash;
+    if (!readDeltaBase(delta, baseHash)) {
+        outError = "Not a backup delta";
+        return false;
+    }
+    delta.remove_prefix(DELTA_MAGIC.size() + HASH_HEX_LENGTH);
+
+    std::uint64_t baseSize = 0, targetSize = 0;
+    if (!getVarint(delta, baseSize) || !getVarint(delta, targetSize)) {
+        outError = "Truncated delta header";
+        return false;
+    }
+    if (baseSize != base.size()) {
+        outError = "Delta was made against a different base";
+        return false;
+    }
+
+    std::uint64_t produced = 0;
+    while (!delta.empty()) {
+        char op = delta.front();
+        delta.remove_prefix(1);
+
+        std::uint64_t offset = 0, length = 0;
+        std::string_view piece;
+        if (op == OP_COPY) {
+            if (!getVarint(delta, offset) || !getVarint(delta, length) ||
+                offset > base.size() || length > base.size() - offset) {
+                outError = "Corrupt copy in delta";
+                return false;
+            }
+            piece = base.substr(static_cast<size_t>(offset), static_cast<size_t>(length));
+        }
+        else if (op == OP_LITERAL) {
+            if (!getVarint(delta, length) || length > delta.size()) {
+                outError = "Corrupt literal in delta";
+                return false;
+            }
+            piece = delta.substr(0, static_cast<size_t>(length));
+            delta.remove_prefix(static_cast<size_t>(length));
+        }
+        else {
+            outError = "Unknown delta operation";
+            return false;
+        }
+
+        if (!write(piece)) {
+            return false;
+        }
+        produced += length;
+    }
+
+    if (produced != targetSize) {
+        outError = "Delta produced " + std::to_string(produced) + " of " + std::to_string(targetSize) + " bytes";
+        return false;
+    }
+    return true;
+}
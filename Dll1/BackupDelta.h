@@ -0,0 +1,22 @@
+// =============================================
+// File: BackupDelta.h
+// Category: HKS Backup Store
+// Purpose: Declares the binary delta format used for compact HKS backup revisions.
+// =============================================
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+
+// Encodes target as copies from base plus literal bytes. Both inputs are
+// split with content-defined chunking, so an edit only disturbs the chunks
+// around it and the rest of the file is matched again right after.
+std::string encodeDelta(const std::string& baseHash, std::string_view base, std::string_view target);
+
+// Reads the base hash recorded by encodeDelta; false if delta is not one
+bool readDeltaBase(std::string_view delta, std::string& outBaseHash);
+
+// Rebuilds the target by passing its base ranges and literals to write, in
+// order, without assembling it; stops when write returns false
+bool applyDelta(std::string_view base, std::string_view delta,
+    const std::function<bool(std::string_view piece)>& write, std::string& outError);
@@ -0,0 +1,632 @@
+// =============================================
+// File: BackupStore.cpp
+// Category: HKS Backup Store
+// Purpose: Implements blob storage, catalog and retention for HKS backups.
+// =============================================
+#include "BackupStore.h"
+#include "BackupDelta.h"
+#include "ContentHash.h"
+#include "FileIO.h"
+#include "Logger.h"
+#include "PathUtils.h"
+#include "StartupProfiler.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <map>
+#include <algorithm>
+#include <mutex>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* CATALOG_HEADER = "LuaLoaderBackupCatalog 2";
+    const char* CATALOG_HEADER_V1 = "LuaLoaderBackupCatalog 1";    // No base field; still read
+
+    // Hashing runs in parallel; everything touching the catalog or objects/ takes this
+    std::mutex g_storeMutex;
+
+    // Catalog line: "timestamp<TAB>hash<TAB>size<TAB>context<TAB>linkName<TAB>source<TAB>base"
+    std::string formatEntry(const BackupEntry& entry) {
+        std::ostringstream line;
+        line << static_cast<long long>(entry.timestamp) << '\t' << entry.hash << '\t' << entry.size << '\t'
+            << entry.context << '\t' << entry.linkName << '\t' << entry.source << '\t' << entry.base << '\n';
+        return line.str();
+    }
+
+    // Lines from older versions stop after context or source
+    bool parseEntry(std::string_view line, BackupEntry& entry) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        std::vector<std::string> fields;
+        for (size_t start = 0;;) {
+            size_t tab = line.find('\t', start);
+            fields.emplace_back(line.substr(start, tab == std::string_view::npos ? std::string_view::npos : tab - start));
+            if (tab == std::string_view::npos) break;
+            start = tab + 1;
+        }
+        if (fields.size() < 4) {
+            return false;
+        }
+        entry.hash = fields[1];
+        entry.context = fields[3];
+        entry.linkName = fields.size() > 4 ? fields[4] : std::string();
+        entry.source = fields.size() > 5 ? fields[5] : std::string();
+        entry.base = fields.size() > 6 ? fields[6] : std::string();
+        entry.baseKnown = fields.size() > 6;
+        try {
+            entry.timestamp = static_cast<std::time_t>(std::stoll(fields[0]));
+            entry.size = std::stoull(fields[2]);
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+        ContentHash check;
+        return parseHexString(entry.hash, check) && (entry.base.empty() || parseHexString(entry.base, check));
+    }
+
+    bool isCatalogHeader(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return line == CATALOG_HEADER || line == CATALOG_HEADER_V1;
+    }
+
+    // Visits entries newest first until visit returns false. The catalog is
+    // mapped and walked back from its end, so only the lines the caller
+    // gets to are read; a lookup near the tail costs the same for any size.
+    bool scanCatalogNewestFirst(const std::string& backupDir, const std::function<bool(const BackupEntry&)>& visit) {
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        MappedFile catalog;
+        if (!catalog.open(getBackupCatalogPath(backupDir))) {
+            return false;
+        }
+        std::string_view data = catalog.view();
+        size_t headerEnd = data.find('\n');
+        if (headerEnd == std::string_view::npos || !isCatalogHeader(data.substr(0, headerEnd))) {
+            log("Backup catalog has an unknown format: " + getBackupCatalogPath(backupDir), LOG_WARNING, "BackupStore");
+            return false;
+        }
+
+        size_t bodyStart = headerEnd + 1;
+        size_t pos = data.size();
+        while (pos > bodyStart) {
+            size_t lineEnd = data[pos - 1] == '\n' ? pos - 1 : pos;
+            size_t lineStart = lineEnd > bodyStart ? data.rfind('\n', lineEnd - 1) + 1 : bodyStart;
+            std::string_view line = data.substr(lineStart, lineEnd - lineStart);
+            pos = lineStart;
+            StartupProfiler::count(StartupProfiler::FS_READ_BYTES, line.size() + 1);
+
+            BackupEntry entry;
+            if (parseEntry(line, entry)) {
+                if (!visit(entry)) {
+                    break;
+                }
+            }
+            else if (!line.empty()) {
+                LOG_AT(LOG_DEBUG, "BackupStore", "Skipping malformed catalog line: ", line);
+            }
+        }
+        return true;
+    }
+
+    bool appendCatalogEntry(const std::string& backupDir, const BackupEntry& entry) {
+        std::string catalogPath = getBackupCatalogPath(backupDir);
+        std::error_code ec;
+        bool isNew = !pfs::exists(catalogPath, ec);
+
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        std::ofstream out(catalogPath, std::ios::binary | std::ios::app);
+        if (!out.is_open()) {
+            return false;
+        }
+        std::string data = isNew ? std::string(CATALOG_HEADER) + "\n" : std::string();
+        data += formatEntry(entry);
+        out << data;
+        StartupProfiler::count(StartupProfiler::FS_WRITE_BYTES, data.size());
+        return !out.fail();
+    }
+
+    bool rewriteCatalog(const std::string& backupDir, const std::vector<BackupEntry>& entries) {
+        std::string data = std::string(CATALOG_HEADER) + "\n";
+        for (const auto& entry : entries) {
+            data += formatEntry(entry);
+        }
+        AtomicFileWriter writer(getBackupCatalogPath(backupDir));
+        return writer.open() && writer.write(data) && writer.commit();
+    }
+
+    std::string formatBackupName(const std::string& sourcePath, std::time_t timestamp, const std::string& context) {
+        std::tm tm;
+        localtime_s(&tm, &timestamp);
+        char dateStr[32];
+        std::strftime(dateStr, sizeof(dateStr), "%Y-%m-%d_%H-%M-%S", &tm);
+
+        std::string name = fs::path(sourcePath).filename().string() + ".backup_" + dateStr;
+        if (!context.empty()) {
+            name += "_" + context;
+        }
+        return name;
+    }
+
+    // Base hash of a stored delta; false if the hash is stored as a full blob
+    bool readStoredDeltaBase(const std::string& backupDir, const std::string& hash, std::string& outBaseHash) {
+        MappedFile delta;
+        return delta.open(getBackupDeltaPath(backupDir, hash)) && readDeltaBase(delta.view(), outBaseHash);
+    }
+
+    // Newest full blob of the same file; deltas are made against it
+    bool findDeltaBase(const std::string& backupDir, const std::string& source, std::string& outHash) {
+        bool found = false;
+        std::error_code ec;
+        scanCatalogNewestFirst(backupDir, [&](const BackupEntry& entry) {
+            bool sameSource = entry.source.empty() || entry.source == source;
+            bool maybeFull = !entry.baseKnown || entry.base.empty();
+            if (sameSource && maybeFull && pfs::exists(getBackupBlobPath(backupDir, entry.hash), ec)) {
+                outHash = entry.hash;
+                found = true;
+            }
+            return !found;
+        });
+        return found;
+    }
+
+    // Returns true and fills outDelta when a delta is worth storing
+    bool tryEncodeDelta(const std::string& backupDir, const std::string& source, std::string_view content,
+        std::string& outBaseHash, std::string& outDelta) {
+        if (!findDeltaBase(backupDir, source, outBaseHash)) {
+            return false;
+        }
+        MappedFile base;
+        if (!base.open(getBackupBlobPath(backupDir, outBaseHash))) {
+            return false;
+        }
+        outDelta = encodeDelta(outBaseHash, base.view(), content);
+        // Past half the file, a fresh base keeps later deltas small
+        return outDelta.size() <= content.size() / 2;
+    }
+}
+
+std::string getBackupObjectsDir(const std::string& backupDir) {
+    return backupDir + "/objects";
+}
+
+std::string getBackupCatalogPath(const std::string& backupDir) {
+    return backupDir + "/backup_catalog.txt";
+}
+
+std::string getBackupBlobPath(const std::string& backupDir, const std::string& hash) {
+    return getBackupObjectsDir(backupDir) + "/" + hash + ".hks";
+}
+
+std::string getBackupDeltaPath(const std::string& backupDir, const std::string& hash) {
+    return getBackupObjectsDir(backupDir) + "/" + hash + ".delta";
+}
+
+bool readBackupCatalog(const std::string& backupDir, std::vector<BackupEntry>& outEntries) {
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    std::ifstream in(getBackupCatalogPath(backupDir), std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || !isCatalogHeader(line)) {
+        log("Backup catalog has an unknown format: " + getBackupCatalogPath(backupDir), LOG_WARNING, "BackupStore");
+        return false;
+    }
+
+    while (std::getline(in, line)) {
+        StartupProfiler::count(StartupProfiler::FS_READ_BYTES, line.size() + 1);
+        BackupEntry entry;
+        if (parseEntry(line, entry)) {
+            outEntries.push_back(entry);
+        }
+        else if (!line.empty()) {
+            LOG_AT(LOG_DEBUG, "BackupStore", "Skipping malformed catalog line: ", line);
+        }
+    }
+    return true;
+}
+
+// Retention pass for callers already holding g_storeMutex
+static size_t pruneBackupsLocked(const std::string& backupDir, const BackupRetention& retention);
+
+bool storeBackup(const std::string& sourcePath, const std::string& backupDir, const std::string& context,
+    bool useDeltas, const BackupRetention& retention, BackupResult& outResult) {
+    // Hashing reads the whole file, which also proves it is readable
+    MappedFile source;
+    if (!source.open(sourcePath)) {
+        log("Cannot read file for backup: " + sourcePath, LOG_WARNING, "BackupStore");
+        return false;
+    }
+    std::string_view content = source.view();
+    if (content.empty()) {
+        log("File is empty, skipping backup: " + sourcePath, LOG_WARNING, "BackupStore");
+        return false;
+    }
+
+    std::string hash = toHexString(hashBuffer(content.data(), content.size()));
+    std::string objectsDir = getBackupObjectsDir(backupDir);
+    outResult.blobPath = normalizePath(getBackupBlobPath(backupDir, hash));
+
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    std::error_code ec;
+    fs::create_directories(objectsDir, ec);
+    if (ec) {
+        log("Failed to create backup directory: " + ec.message(), LOG_ERROR, "BackupStore");
+        return false;
+    }
+
+    BackupEntry entry;
+    entry.timestamp = std::time(nullptr);
+    entry.hash = hash;
+    entry.size = content.size();
+    entry.context = context;
+    entry.source = fs::path(sourcePath).filename().string();
+
+    auto blobSize = pfs::file_size(outResult.blobPath, ec);
+    outResult.deduplicated = !ec && blobSize == content.size();
+    if (!outResult.deduplicated) {
+        std::string deltaPath = normalizePath(getBackupDeltaPath(backupDir, hash));
+        if (pfs::exists(deltaPath, ec)) {
+            outResult.deduplicated = true;
+            outResult.delta = true;
+            outResult.blobPath = deltaPath;
+            readStoredDeltaBase(backupDir, hash, entry.base);
+        }
+    }
+
+    std::string baseHash, delta;
+    if (!outResult.deduplicated && useDeltas && tryEncodeDelta(backupDir, entry.source, content, baseHash, delta)) {
+        outResult.delta = true;
+        outResult.blobPath = normalizePath(getBackupDeltaPath(backupDir, hash));
+        AtomicFileWriter blob(outResult.blobPath);
+        if (!blob.open() || !blob.write(delta) || !blob.commit()) {
+            log("Backup creation failed: " + blob.lastError(), LOG_ERROR, "BackupStore");
+            return false;
+        }
+        outResult.storedBytes = delta.size();
+        entry.base = baseHash;
+        LOG_AT(LOG_DEBUG, "BackupStore", "Stored delta of ", delta.size(), " bytes against ", baseHash);
+    }
+    else if (!outResult.deduplicated) {
+        // Blobs appear under their final name only once complete
+        AtomicFileWriter blob(outResult.blobPath);
+        if (!blob.open() || !blob.write(content) || !blob.commit()) {
+            log("Backup creation failed: " + blob.lastError(), LOG_ERROR, "BackupStore");
+            return false;
+        }
+        outResult.storedBytes = content.size();
+
+        // A named hardlink keeps new versions easy to find by hand; it costs no space
+        std::string linkName = formatBackupName(sourcePath, entry.timestamp, context);
+        std::string linkPath = normalizePath(backupDir + "/" + linkName);
+        fs::create_hard_link(outResult.blobPath, linkPath, ec);
+        if (!ec) {
+            entry.linkName = linkName;
+            outResult.linkPath = linkPath;
+        }
+        else {
+            LOG_AT(LOG_DEBUG, "BackupStore", "Hardlink not created (", ec.message(), "); blob only: ", outResult.blobPath);
+        }
+    }
+    source.close();
+
+    if (!appendCatalogEntry(backupDir, entry)) {
+        log("Failed to update backup catalog: " + getBackupCatalogPath(backupDir), LOG_WARNING, "BackupStore");
+    }
+
+    if (retention.keepCount > 0 || retention.maxBytes > 0) {
+        outResult.pruned = pruneBackupsLocked(backupDir, retention);
+    }
+    return true;
+}
+
+size_t pruneBackups(const std::string& backupDir, const BackupRetention& retention) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    return pruneBackupsLocked(backupDir, retention);
+}
+
+static size_t pruneBackupsLocked(const std::string& backupDir, const BackupRetention& retention) {
+    std::vector<BackupEntry> entries;
+    if (!readBackupCatalog(backupDir, entries) || entries.empty()) {
+        return 0;
+    }
+
+    // Entries from older catalogs do not say whether they are deltas; look
+    // once, so the rewritten catalog records it
+    auto resolveBase = [&](BackupEntry& entry) {
+        if (!entry.baseKnown) {
+            readStoredDeltaBase(backupDir, entry.hash, entry.base);
+            entry.baseKnown = true;
+        }
+    };
+
+    // Bytes an object takes in objects/: the full blob or the delta, whichever is stored
+    auto storedBytes = [&](const std::string& hash) -> unsigned long long {
+        std::error_code sizeError;
+        auto size = pfs::file_size(getBackupBlobPath(backupDir, hash), sizeError);
+        if (sizeError) {
+            size = pfs::file_size(getBackupDeltaPath(backupDir, hash), sizeError);
+        }
+        return sizeError ? 0 : static_cast<unsigned long long>(size);
+    };
+
+    // Several scripts share one catalog, so the limits apply to each source
+    // on its own: walk from the end and stop taking a source's entries at
+    // either limit. The size limit counts what is on disk: each distinct
+    // object once, plus the full blob a kept delta needs, rather than the
+    // logical size of every entry.
+    struct SourceBudget {
+        size_t count = 0;
+        unsigned long long bytes = 0;
+        std::set<std::string> objects;
+        bool full = false;
+        bool injectionKept = false;
+    };
+    std::map<std::string, SourceBudget> budgets;
+    std::vector<bool> keep(entries.size(), false);
+    for (size_t i = entries.size(); i-- > 0;) {
+        BackupEntry& entry = entries[i];
+        SourceBudget& budget = budgets[entry.source];
+        // Cleanup restores the pre-injection copy, so each source's newest
+        // one stays whatever the limits say
+        bool pinned = entry.context == "injection" && !budget.injectionKept;
+        if (pinned) {
+            budget.injectionKept = true;
+        }
+        if (budget.full && !pinned) {
+            continue;
+        }
+        if (!pinned && retention.keepCount > 0 && budget.count >= retention.keepCount) {
+            budget.full = true;
+            continue;
+        }
+
+        unsigned long long addedBytes = 0;
+        bool newObject = budget.objects.count(entry.hash) == 0;
+        bool newBase = false;
+        if (retention.maxBytes > 0) {
+            resolveBase(entry);
+            newBase = !entry.base.empty() && entry.base != entry.hash && budget.objects.count(entry.base) == 0;
+            if (newObject) addedBytes += storedBytes(entry.hash);
+            if (newBase) addedBytes += storedBytes(entry.base);
+        }
+        // A source's most recent backup always survives, even if it alone exceeds the limit
+        if (!pinned && retention.maxBytes > 0 && addedBytes > 0 && budget.count > 0 && budget.bytes + addedBytes > retention.maxBytes) {
+            budget.full = true;
+            continue;
+        }
+        if (newObject) budget.objects.insert(entry.hash);
+        if (newBase) budget.objects.insert(entry.base);
+        if (!pinned) {
+            budget.count++;
+            budget.bytes += addedBytes;
+        }
+        keep[i] = true;
+    }
+
+    std::vector<BackupEntry> kept;
+    std::vector<BackupEntry> dropped;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        (keep[i] ? kept : dropped).push_back(entries[i]);
+    }
+    size_t removed = dropped.size();
+    if (removed == 0) {
+        return 0;
+    }
+
+    // Deltas still need the full blob they were made against
+    std::set<std::string> liveBlobs;
+    for (auto& entry : kept) {
+        resolveBase(entry);
+        liveBlobs.insert(entry.hash);
+        if (!entry.base.empty()) liveBlobs.insert(entry.base);
+    }
+
+    if (!rewriteCatalog(backupDir, kept)) {
+        log("Failed to rewrite backup catalog during pruning", LOG_WARNING, "BackupStore");
+        return 0;
+    }
+
+    // Only blobs that dropped entries referred to can have become unused, so
+    // the catalog alone says what to delete; objects/ is never listed
+    std::set<std::string> keptLinks;
+    for (const auto& entry : kept) {
+        if (!entry.linkName.empty()) keptLinks.insert(entry.linkName);
+    }
+    std::set<std::string> deadBlobs;
+    std::error_code ec;
+    for (auto& entry : dropped) {
+        resolveBase(entry);
+        if (!entry.linkName.empty() && keptLinks.count(entry.linkName) == 0) {
+            fs::remove(backupDir + "/" + entry.linkName, ec);
+        }
+        if (liveBlobs.count(entry.hash) == 0) deadBlobs.insert(entry.hash);
+        if (!entry.base.empty() && liveBlobs.count(entry.base) == 0) deadBlobs.insert(entry.base);
+    }
+    for (const auto& hash : deadBlobs) {
+        // Stored as one or the other; removing the missing one is a no-op
+        fs::remove(getBackupBlobPath(backupDir, hash), ec);
+        fs::remove(getBackupDeltaPath(backupDir, hash), ec);
+    }
+
+    log("Backup retention removed " + std::to_string(removed) + " old entr" + (removed == 1 ? "y" : "ies"), LOG_INFO, "BackupStore");
+    return removed;
+}
+
+namespace {
+    using ContentSink = std::function<bool(std::string_view piece)>;
+
+    // Passes the stored bytes for hash to sink in order: a full blob as one
+    // mapped view, a delta as the base ranges and literals it rebuilds from,
+    // never assembled in memory. outMissing tells a deleted blob apart from a
+    // damaged one.
+    bool streamStoredContent(const std::string& backupDir, const std::string& hash, const ContentSink& sink,
+        std::string& outError, bool& outMissing, bool& outFromDelta) {
+        outMissing = false;
+        outFromDelta = false;
+        MappedFile blob;
+        if (blob.open(getBackupBlobPath(backupDir, hash))) {
+            return sink(blob.view());
+        }
+
+        MappedFile delta;
+        std::string baseHash;
+        if (!delta.open(getBackupDeltaPath(backupDir, hash)) || !readDeltaBase(delta.view(), baseHash)) {
+            outError = "backup content missing";
+            outMissing = true;
+            return false;
+        }
+        MappedFile base;
+        if (!base.open(getBackupBlobPath(backupDir, baseHash))) {
+            outError = "delta base " + baseHash + " missing";
+            outMissing = true;
+            return false;
+        }
+        outFromDelta = true;
+        return applyDelta(base.view(), delta.view(), sink, outError);
+    }
+
+    // Streams the content for hash to sink (if any) while hashing it; true
+    // once every byte went through and the result still hashes to that value
+    bool streamVerifiedContent(const std::string& backupDir, const std::string& hash, const ContentSink& sink,
+        std::string& outError, bool& outMissing, bool& outFromDelta, unsigned long long& outSize) {
+        ContentHasher hasher;
+        bool streamed = streamStoredContent(backupDir, hash, [&](std::string_view piece) {
+            hasher.update(piece);
+            return !sink || sink(piece);
+        }, outError, outMissing, outFromDelta);
+        outSize = hasher.length();
+        if (!streamed) {
+            return false;
+        }
+        if (toHexString(hasher.finish()) != hash) {
+            outError = "content does not match its hash";
+            return false;
+        }
+        return true;
+    }
+
+    // The output is only replaced once the streamed content matched its hash
+    bool restoreLocked(const std::string& backupDir, const std::string& hash, const std::string& outputPath) {
+        AtomicFileWriter out(outputPath);
+        if (!out.open()) {
+            log("Restore failed: " + out.lastError(), LOG_ERROR, "BackupStore");
+            return false;
+        }
+
+        std::string error;
+        bool missing = false;
+        bool fromDelta = false;
+        unsigned long long size = 0;
+        bool verified = streamVerifiedContent(backupDir, hash, [&](std::string_view piece) {
+            if (!out.write(piece)) {
+                error = out.lastError();
+                return false;
+            }
+            return true;
+        }, error, missing, fromDelta, size);
+        if (!verified) {
+            // The writer discards its temp file when it goes out of scope uncommitted
+            log("Cannot restore backup " + hash + ": " + error, LOG_ERROR, "BackupStore");
+            return false;
+        }
+        if (!out.commit()) {
+            log("Restore failed: " + out.lastError(), LOG_ERROR, "BackupStore");
+            return false;
+        }
+        LOG_AT(LOG_DEBUG, "BackupStore", "Restored ", hash, fromDelta ? " from delta" : "", " to ", outputPath);
+        return true;
+    }
+
+    bool findLatestLocked(const std::string& backupDir, const std::string& source, const std::string& context, BackupEntry& outEntry) {
+        bool found = false;
+        scanCatalogNewestFirst(backupDir, [&](const BackupEntry& entry) {
+            if ((entry.source.empty() || entry.source == source) && (context.empty() || entry.context == context)) {
+                outEntry = entry;
+                found = true;
+            }
+            return !found;
+        });
+        return found;
+    }
+
+    bool verifyLocked(const std::string& backupDir, const BackupEntry& entry, std::string& outError, bool& outMissing) {
+        bool fromDelta = false;
+        unsigned long long size = 0;
+        if (!streamVerifiedContent(backupDir, entry.hash, nullptr, outError, outMissing, fromDelta, size)) {
+            return false;
+        }
+        if (size != entry.size) {
+            outError = "size " + std::to_string(size) + " does not match catalog size " + std::to_string(entry.size);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool restoreBackup(const std::string& backupDir, const std::string& hash, const std::string& outputPath) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    return restoreLocked(backupDir, hash, outputPath);
+}
+
+bool findLatestBackup(const std::string& backupDir, const std::string& source, const std::string& context, BackupEntry& outEntry) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    return findLatestLocked(backupDir, source, context, outEntry);
+}
+
+bool restoreLatestBackup(const std::string& backupDir, const std::string& source, const std::string& context,
+    const std::string& outputPath, BackupEntry* outRestored) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    BackupEntry entry;
+    if (!findLatestLocked(backupDir, source, context, entry)) {
+        log("No " + (context.empty() ? std::string() : context + " ") + "backup of " + source + " in the catalog", LOG_WARNING, "BackupStore");
+        return false;
+    }
+    if (!restoreLocked(backupDir, entry.hash, outputPath)) {
+        return false;
+    }
+    if (outRestored) {
+        *outRestored = entry;
+    }
+    return true;
+}
+
+bool verifyBackup(const std::string& backupDir, const BackupEntry& entry, std::string& outError) {
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    bool missing = false;
+    return verifyLocked(backupDir, entry, outError, missing);
+}
+
+BackupVerifyReport verifyBackupStore(const std::string& backupDir) {
+    BackupVerifyReport report;
+    std::lock_guard<std::mutex> lock(g_storeMutex);
+    std::vector<BackupEntry> entries;
+    if (!readBackupCatalog(backupDir, entries)) {
+        return report;
+    }
+
+    // Entries sharing a hash share the stored content; check each once
+    std::set<std::string> seen;
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (!seen.insert(it->hash).second) {
+            continue;
+        }
+        report.checked++;
+        std::string error;
+        bool missing = false;
+        if (!verifyLocked(backupDir, *it, error, missing)) {
+            (missing ? report.missing : report.corrupt)++;
+            log("Backup " + it->hash + " (" + it->source + ", " + it->context + ") failed verification: " + error, LOG_WARNING, "BackupStore");
+        }
+    }
+
+    log("Verified " + std::to_string(report.checked) + " stored backup(s): " + std::to_string(report.missing) + " missing, " +
+        std::to_string(report.corrupt) + " corrupt", (report.missing || report.corrupt) ? LOG_WARNING : LOG_INFO, "BackupStore");
+    return report;
+}
\ No newline at end of file
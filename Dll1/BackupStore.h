@@ -0,0 +1,87 @@
+// =============================================
+// File: BackupStore.h
+// Category: HKS Backup Store
+// Purpose: Declares the content-addressed, deduplicating HKS backup store.
+// =============================================
+#pragma once
+#include <string>
+#include <vector>
+#include <ctime>
+
+// Limits applied after every backup, to each source's entries separately;
+// zero means unlimited. A source's newest "injection" entry is always kept.
+struct BackupRetention {
+    unsigned keepCount = 0;                 // Newest catalog entries to keep per source
+    unsigned long long maxBytes = 0;        // Size of the stored blobs per source
+};
+
+// One backup event. Several entries may share a blob when content repeats.
+struct BackupEntry {
+    std::time_t timestamp = 0;
+    std::string hash;           // Hex content hash naming the blob
+    unsigned long long size = 0;
+    std::string context;        // "launch", "injection", "cleanup", ...
+    std::string linkName;       // Human-readable hardlink to the blob, if one was made
+    std::string source;         // File name of the backed-up script (empty in older catalogs)
+    std::string base;           // Full blob a delta was made against; empty for a full blob
+    bool baseKnown = true;      // False for entries from catalogs that did not record base
+};
+
+struct BackupResult {
+    bool deduplicated = false;  // Content matched an existing blob; nothing was copied
+    bool delta = false;         // Stored as a delta against an earlier full blob
+    unsigned long long storedBytes = 0;
+    std::string blobPath;
+    std::string linkPath;
+    size_t pruned = 0;          // Catalog entries removed by retention
+};
+
+// Layout inside the backup folder:
+//   objects/<hash>.hks                            one blob per distinct content
+//   objects/<hash>.delta                          or, in delta mode, a delta against a .hks blob
+//   backup_catalog.txt                            append-only entries, newest last
+//   <file>.backup_<date>_<context>                hardlink to a new blob
+std::string getBackupObjectsDir(const std::string& backupDir);
+std::string getBackupCatalogPath(const std::string& backupDir);
+std::string getBackupBlobPath(const std::string& backupDir, const std::string& hash);
+std::string getBackupDeltaPath(const std::string& backupDir, const std::string& hash);
+
+// Stores a backup of sourcePath. Identical content only adds a catalog entry.
+// Safe to call from several threads; catalog updates are serialized.
+// With useDeltas, new content is stored as a delta against the newest full
+// blob of the same file; a full blob is written instead when there is none or the delta would
+// be more than half the size of the file.
+bool storeBackup(const std::string& sourcePath, const std::string& backupDir, const std::string& context,
+    bool useDeltas, const BackupRetention& retention, BackupResult& outResult);
+
+// Writes the backup with the given hash to outputPath, rebuilding deltas on the
+// fly. The content is checked against its hash before outputPath is replaced.
+bool restoreBackup(const std::string& backupDir, const std::string& hash, const std::string& outputPath);
+
+// Reads the catalog in file order (oldest first); false if it is missing or unreadable
+bool readBackupCatalog(const std::string& backupDir, std::vector<BackupEntry>& outEntries);
+
+// Newest entry for a script (file name) and context, read backwards from the
+// end of the catalog so the cost does not grow with its length. An empty
+// context matches any.
+bool findLatestBackup(const std::string& backupDir, const std::string& source, const std::string& context, BackupEntry& outEntry);
+
+// Restores the newest backup of source with that context to outputPath
+bool restoreLatestBackup(const std::string& backupDir, const std::string& source, const std::string& context,
+    const std::string& outputPath, BackupEntry* outRestored = nullptr);
+
+// Checks that an entry's stored content exists and matches its size and hash
+bool verifyBackup(const std::string& backupDir, const BackupEntry& entry, std::string& outError);
+
+struct BackupVerifyReport {
+    size_t checked = 0;         // Distinct hashes in the catalog
+    size_t missing = 0;
+    size_t corrupt = 0;
+};
+
+// Verifies every distinct hash the catalog refers to
+BackupVerifyReport verifyBackupStore(const std::string& backupDir);
+
+// Applies retention and deletes the blobs and links only dropped entries referred
+// to, working from the catalog alone; returns entries removed
+size_t pruneBackups(const std::string& backupDir, const BackupRetention& retention);
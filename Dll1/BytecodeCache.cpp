@@ -0,0 +1,244 @@
+// =============================================
+// File: BytecodeCache.cpp
+// Category: Lua Setup Script Generation
+// Purpose: Precompiles Lua modules to bytecode chunks keyed by source content hash.
+// =============================================
+#include "BytecodeCache.h"
+#include "ContentHash.h"
+#include "Logger.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
+#include "lua.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Index entry remembered between launches so unchanged sources are not even read
+    struct IndexEntry {
+        std::uintmax_t size = 0;
+        long long mtime = 0;
+        std::string hash;
+
+        bool operator==(const IndexEntry& other) const {
+            return size == other.size && mtime == other.mtime && hash == other.hash;
+        }
+    };
+
+    const char* INDEX_FILE_NAME = "index.txt";
+    const char* CHUNK_EXTENSION = ".luac";
+
+    // Index format: one "name<TAB>size<TAB>mtime<TAB>hash" line per module
+    std::map<std::string, IndexEntry> readIndex(const std::string& indexPath) {
+        std::map<std::string, IndexEntry> index;
+        std::ifstream in(indexPath);
+        if (!in.is_open()) {
+            return index;
+        }
+
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            IndexEntry entry;
+            if (std::getline(fields, name, '\t') && fields >> entry.size >> entry.mtime >> entry.hash) {
+                index[name] = entry;
+            }
+        }
+        return index;
+    }
+
+    std::string formatIndex(const std::map<std::string, IndexEntry>& index) {
+        std::ostringstream out;
+        for (const auto& [name, entry] : index) {
+            out << name << '\t' << entry.size << '\t' << entry.mtime << '\t' << entry.hash << '\n';
+        }
+        return out.str();
+    }
+
+    bool readSource(const std::string& path, std::string& outSource) {
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return false;
+        }
+        outSource.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        StartupProfiler::count(StartupProfiler::FS_READ_BYTES, outSource.size());
+        return !in.bad();
+    }
+
+    int bytecodeWriter(lua_State*, const void* data, size_t size, void* userData) {
+        static_cast<std::string*>(userData)->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+
+    // Compiles source text to a binary chunk using the vendored parser and dumper
+    bool compileChunk(lua_State* L, const std::string& chunkName, const std::string& source,
+        std::string& outBytecode, std::string& outError) {
+        lua_settop(L, 0);
+        int status = luaL_loadbufferx(L, source.data(), source.size(), chunkName.c_str(), "t");
+        if (status != LUA_OK) {
+            const char* message = lua_tostring(L, -1);
+            outError = message ? message : "unknown compile error";
+            lua_settop(L, 0);
+            return false;
+        }
+
+        outBytecode.clear();
+        status = lua_dump(L, bytecodeWriter, &outBytecode, 0);
+        lua_settop(L, 0);
+        if (status != 0 || outBytecode.empty()) {
+            outError = "bytecode dump failed";
+            return false;
+        }
+        return true;
+    }
+}
+
+std::string getBytecodeCacheDir(const std::string& modulePath) {
+    return modulePath + "/_module_loader/bytecode";
+}
+
+const char* getBytecodeRuntimeVersion() {
+    return LUA_VERSION;
+}
+
+BytecodeCacheResult updateBytecodeCache(const std::string& modulePath, const std::vector<ModuleEntry>& modules) {
+    BytecodeCacheResult result;
+    std::string cacheDir = getBytecodeCacheDir(modulePath);
+    std::string indexPath = cacheDir + "/" + INDEX_FILE_NAME;
+
+    try {
+        fs::create_directories(cacheDir);
+    }
+    catch (const std::exception& e) {
+        log("Cannot create bytecode cache directory: " + std::string(e.what()), LOG_WARNING, "BytecodeCache");
+        return result;
+    }
+
+    std::map<std::string, IndexEntry> oldIndex = readIndex(indexPath);
+
+    // A source written in the same clock tick as the index may have changed
+    // after it was recorded without changing its mtime; hash those instead
+    std::error_code ec;
+    long long indexTime = static_cast<long long>(fs::last_write_time(indexPath, ec).time_since_epoch().count());
+    if (ec) {
+        indexTime = 0;
+    }
+    std::map<std::string, IndexEntry> newIndex;
+    lua_State* L = nullptr;
+
+    // New chunks and the index are committed together once compilation is
+    // done. The cache is rebuilt from sources if lost, so skip the flushes.
+    AtomicWriteBatch writes(FsyncPolicy::Never);
+    std::vector<std::string> compiledModules;
+    bool racyEntries = false;
+
+    for (const auto& module : modules) {
+        std::string sourcePath = modulePath + "/" + module.name + ".lua";
+
+        // Fast path: size and full-resolution mtime unchanged, written before
+        // the index, and the chunk is still on disk
+        auto previous = oldIndex.find(module.name);
+        if (previous != oldIndex.end() &&
+            previous->second.size == module.size &&
+            previous->second.mtime == module.mtime &&
+            module.mtime < indexTime &&
+            pfs::exists(cacheDir + "/" + previous->second.hash + CHUNK_EXTENSION)) {
+            newIndex[module.name] = previous->second;
+            result.chunkFiles[module.name] = previous->second.hash + CHUNK_EXTENSION;
+            result.reused++;
+            continue;
+        }
+
+        if (previous != oldIndex.end() && module.mtime >= indexTime) {
+            racyEntries = true;
+        }
+
+        std::string source;
+        if (!readSource(sourcePath, source)) {
+            log("Cannot read module for precompile: " + sourcePath, LOG_WARNING, "BytecodeCache");
+            result.failed++;
+            continue;
+        }
+
+        IndexEntry entry{ module.size, module.mtime, toHexString(hashBuffer(source.data(), source.size())) };
+        std::string chunkFile = entry.hash + CHUNK_EXTENSION;
+        std::string chunkPath = cacheDir + "/" + chunkFile;
+
+        // Touched but identical content: keep the existing chunk
+        if (pfs::exists(chunkPath)) {
+            newIndex[module.name] = entry;
+            result.chunkFiles[module.name] = chunkFile;
+            result.reused++;
+            continue;
+        }
+
+        if (!L) {
+            L = luaL_newstate();
+            if (!L) {
+                log("Cannot create Lua state for precompile", LOG_WARNING, "BytecodeCache");
+                result.failed++;
+                break;
+            }
+        }
+
+        std::string bytecode, error;
+        if (!compileChunk(L, "@" + sourcePath, source, bytecode, error)) {
+            log("Precompile failed for " + module.name + ": " + error, LOG_WARNING, "BytecodeCache");
+            result.failed++;
+            continue;
+        }
+
+        LOG_AT(LOG_TRACE, "BytecodeCache", "Compiled ", module.name, " (", bytecode.size(), " bytes)");
+        writes.add(chunkPath, std::move(bytecode));
+        compiledModules.push_back(module.name);
+
+        newIndex[module.name] = entry;
+        result.chunkFiles[module.name] = chunkFile;
+        result.compiled++;
+    }
+
+    if (L) {
+        lua_close(L);
+    }
+
+    // Rewriting the index after a racy entry moves its time past that source,
+    // so the next launch can take the fast path again
+    if (newIndex != oldIndex || racyEntries) {
+        writes.add(indexPath, formatIndex(newIndex));
+    }
+    if (writes.size() > 0 && !writes.commit()) {
+        log("Cannot write bytecode cache: " + writes.lastError(), LOG_WARNING, "BytecodeCache");
+        for (const auto& name : compiledModules) {
+            result.chunkFiles.erase(name);
+        }
+        result.failed += result.compiled;
+        result.compiled = 0;
+    }
+
+    // Drop chunks no module refers to anymore
+    std::set<std::string> liveChunks;
+    for (const auto& [name, file] : result.chunkFiles) {
+        liveChunks.insert(file);
+    }
+    try {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(cacheDir, ec)) {
+            if (entry.path().extension() == CHUNK_EXTENSION &&
+                liveChunks.find(entry.path().filename().string()) == liveChunks.end()) {
+                fs::remove(entry.path(), ec);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_AT(LOG_TRACE, "BytecodeCache", "Bytecode cache pruning failed: ", e.what());
+    }
+
+    LOG_AT(LOG_DEBUG, "BytecodeCache", "Bytecode cache: ", result.compiled, " compiled, ",
+        result.reused, " reused, ", result.failed, " failed");
+    return result;
+}
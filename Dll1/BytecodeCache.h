@@ -0,0 +1,26 @@
+// =============================================
+// File: BytecodeCache.h
+// Category: Lua Setup Script Generation
+// Purpose: Declares the persistent bytecode cache built with the vendored Lua toolchain.
+// =============================================
+#pragma once
+#include "ModuleManifest.h"
+#include <string>
+#include <vector>
+#include <map>
+
+struct BytecodeCacheResult {
+    std::map<std::string, std::string> chunkFiles;  // Module name -> chunk file name in the cache dir
+    size_t compiled = 0;
+    size_t reused = 0;
+    size_t failed = 0;
+};
+
+// Directory holding the cached chunks (<modulePath>/_module_loader/bytecode)
+std::string getBytecodeCacheDir(const std::string& modulePath);
+
+// Version string the cached chunks were compiled for (matches Lua's _VERSION)
+const char* getBytecodeRuntimeVersion();
+
+// Compiles each module into a content-hash-keyed chunk, recompiling only changed sources
+BytecodeCacheResult updateBytecodeCache(const std::string& modulePath, const std::vector<ModuleEntry>& modules);
@@ -5,49 +5,91 @@
 // =============================================
 #include "Cleanup.h"
 #include "HksInjector.h"  // For universal backup function
+#include "BackupStore.h"
 #include "Logger.h"
 #include "PathUtils.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
 #include <filesystem>
-#include <fstream>
+#include <string_view>
 #include <vector>
+#include <set>
 #include <algorithm>
 
 namespace fs = std::filesystem;
 
 namespace {
-    // Utility: Read file content into vector of lines
-    std::vector<std::string> readFileLines(const std::string& filePath) {
-        std::vector<std::string> lines;
-        std::ifstream file(filePath);
-
-        if (!file.is_open()) {
-            log("Failed to open file for reading: " + filePath, LOG_ERROR, "Cleanup");
-            return lines;
+    // One line of a mapped file. text stops before the "\r\n" or "\n", as a
+    // text-mode getline would; end is the offset just past it, so byte ranges
+    // keep the file's own line endings.
+    struct LineSpan {
+        size_t begin = 0;
+        size_t end = 0;
+        std::string_view text;
+    };
+
+    // Walks a buffer line by line without copying
+    class LineCursor {
+    public:
+        explicit LineCursor(std::string_view data) : data_(data) {}
+
+        bool next(LineSpan& line) {
+            if (pos_ >= data_.size()) {
+                return false;
+            }
+            size_t newline = data_.find('\n', pos_);
+            size_t textEnd = newline == std::string_view::npos ? data_.size() : newline;
+            if (newline != std::string_view::npos && textEnd > pos_ && data_[textEnd - 1] == '\r') {
+                --textEnd;
+            }
+            line.begin = pos_;
+            line.end = newline == std::string_view::npos ? data_.size() : newline + 1;
+            line.text = data_.substr(pos_, textEnd - pos_);
+            pos_ = line.end;
+            return true;
         }
 
-        std::string line;
-        while (std::getline(file, line)) {
-            lines.push_back(line);
+        bool peek(LineSpan& line) const {
+            LineCursor copy = *this;
+            return copy.next(line);
         }
-        file.close();
 
-        return lines;
+    private:
+        std::string_view data_;
+        size_t pos_ = 0;
+    };
+
+    bool contains(std::string_view text, std::string_view needle) {
+        return text.find(needle) != std::string_view::npos;
+    }
+
+    bool isBlankLine(std::string_view text) {
+        return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+    }
+
+    bool isInjectionStart(std::string_view text, const LineCursor& cursor) {
+        LineSpan next;
+        return contains(text, "-- ========================================") &&
+            cursor.peek(next) && contains(next.text, "-- Lua Loader");
     }
 
-    // Utility: Write vector of lines to file
-    bool writeFileLines(const std::string& filePath, const std::vector<std::string>& lines) {
-        std::ofstream file(filePath);
+    bool isInjectionEnd(std::string_view text) {
+        return contains(text, "dofile(") && contains(text, "module_loader_setup.lua");
+    }
 
-        if (!file.is_open()) {
-            log("Failed to open file for writing: " + filePath, LOG_ERROR, "Cleanup");
+    // Puts back the copy of hksPath taken just before it was injected
+    bool restoreFromInjectionBackup(const std::string& hksPath, const std::string& backupDir) {
+        if (backupDir.empty()) {
+            log("No backup folder to restore " + hksPath + " from - file left unchanged", LOG_ERROR, "Cleanup");
             return false;
         }
-
-        for (const auto& line : lines) {
-            file << line << "\n";
+        BackupEntry restored;
+        if (!restoreLatestBackup(backupDir, fs::path(hksPath).filename().string(), "injection", hksPath, &restored)) {
+            log("Unable to restore " + hksPath + " from its pre-injection backup - file left unchanged", LOG_ERROR, "Cleanup");
+            return false;
         }
-        file.close();
-
+        log("Restored " + fs::path(hksPath).filename().string() + " from its pre-injection backup (" +
+            restored.hash.substr(0, 12) + ")", LOG_INFO, "Cleanup");
         return true;
     }
 }
@@ -62,7 +104,8 @@ namespace Cleanup {
 
         bool allOperationsSuccessful = true;
         int operationsCompleted = 0;
-        int totalOperations = 3;
+        int totalOperations = 4;
+        std::set<std::string> backupDirs;       // Stores the HKS targets back up into
 
         // Operation 1: Remove _module_loader directory
         if (!config.modulePath.absolutePath.empty()) {
@@ -76,7 +119,7 @@ namespace Cleanup {
             }
         }
         else {
-            log("Module path not configured - skipping directory cleanup", LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "Module path not configured - skipping directory cleanup");
             operationsCompleted++;
         }
 
@@ -92,37 +135,63 @@ namespace Cleanup {
             }
         }
         else {
-            log("Module path not configured - skipping flag file cleanup", LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "Module path not configured - skipping flag file cleanup");
             operationsCompleted++;
         }
 
-        // Operation 3: Clean HKS injection
+        // Operation 3: Clean HKS injection from every target
         if (!config.gameScriptPath.absolutePath.empty()) {
-            std::string hksPath = config.gameScriptPath.absolutePath + "/c0000.hks";
             log("Starting HKS injection cleanup", LOG_INFO, "Cleanup");
 
-            if (fs::exists(hksPath)) {
+            bool allTargetsClean = true;
+            for (const auto& hksPath : resolveHksTargets(config)) {
+                if (!pfs::exists(hksPath)) {
+                    LOG_AT(LOG_DEBUG, "Cleanup", "HKS file not found - no injection to clean: ", hksPath);
+                    continue;
+                }
+
                 // Use universal backup function with cleanup context
+                std::string backupDir = resolveHksBackupDir(hksPath, config);
+                backupDirs.insert(backupDir);
                 createHksBackup(hksPath, config, "cleanup");
 
-                if (cleanupHksInjection(hksPath)) {
-                    operationsCompleted++;
-                }
-                else {
-                    log("HKS injection cleanup encountered issues", LOG_WARNING, "Cleanup");
-                    allOperationsSuccessful = false;
+                if (!cleanupHksInjection(hksPath, backupDir)) {
+                    log("HKS injection cleanup encountered issues: " + hksPath, LOG_WARNING, "Cleanup");
+                    allTargetsClean = false;
                 }
             }
-            else {
-                log("HKS file not found - no injection to clean", LOG_DEBUG, "Cleanup");
+
+            if (allTargetsClean) {
                 operationsCompleted++;
             }
+            else {
+                allOperationsSuccessful = false;
+            }
         }
         else {
-            log("Game script path not configured - skipping HKS cleanup", LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "Game script path not configured - skipping HKS cleanup");
             operationsCompleted++;
         }
 
+        // Operation 4: Check the backups that remain the way back to the original scripts
+        bool backupsIntact = true;
+        for (const auto& backupDir : backupDirs) {
+            if (!pfs::exists(getBackupCatalogPath(backupDir))) {
+                continue;
+            }
+            BackupVerifyReport report = verifyBackupStore(backupDir);
+            if (report.missing > 0 || report.corrupt > 0) {
+                log("Backup store has damaged entries: " + backupDir, LOG_WARNING, "Cleanup");
+                backupsIntact = false;
+            }
+        }
+        if (backupsIntact) {
+            operationsCompleted++;
+        }
+        else {
+            allOperationsSuccessful = false;
+        }
+
         // Final status report
         log("==========================================", LOG_INFO, "Cleanup");
 
@@ -147,8 +216,8 @@ namespace Cleanup {
         std::string loaderDirectory = modulePath + "/_module_loader";
 
         try {
-            if (!fs::exists(loaderDirectory)) {
-                log("Module loader directory not found (already clean)", LOG_DEBUG, "Cleanup");
+            if (!pfs::exists(loaderDirectory)) {
+                LOG_AT(LOG_DEBUG, "Cleanup", "Module loader directory not found (already clean)");
                 return true;
             }
 
@@ -192,7 +261,7 @@ namespace Cleanup {
 
         for (const auto& flagPath : flagFilePaths) {
             try {
-                if (fs::exists(flagPath)) {
+                if (pfs::exists(flagPath)) {
                     fs::remove(flagPath);
                     filesRemoved++;
                     log("Removed flag file: " + fs::path(flagPath).filename().string(), LOG_INFO, "Cleanup");
@@ -205,138 +274,165 @@ namespace Cleanup {
         }
 
         if (filesRemoved == 0) {
-            log("No flag files found (already clean)", LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "No flag files found (already clean)");
         }
 
         return allFilesProcessed;
     }
 
-    bool cleanupHksInjection(const std::string& hksPath) {
-        if (!fs::exists(hksPath)) {
-            log("HKS file not found: " + hksPath, LOG_DEBUG, "Cleanup");
+    bool cleanupHksInjection(const std::string& hksPath, const std::string& backupDir) {
+        if (!pfs::exists(hksPath)) {
+            LOG_AT(LOG_DEBUG, "Cleanup", "HKS file not found: ", hksPath);
             return true;
         }
 
-        auto lines = readFileLines(hksPath);
-        if (lines.empty()) {
+        MappedFile hksMap;
+        if (!hksMap.open(hksPath) || hksMap.view().empty()) {
             log("Unable to read HKS file content", LOG_ERROR, "Cleanup");
             return false;
         }
-
-        log("Read " + std::to_string(lines.size()) + " lines from HKS file", LOG_DEBUG, "Cleanup");
-
-        std::vector<std::string> cleanedLines;
+        std::string_view content = hksMap.view();
+
+        // Everything outside the injection block is copied through as byte
+        // ranges straight from the mapping; the writer only opens once a
+        // block is found, so clean files are never rewritten
+        AtomicFileWriter hksWrite(hksPath);
+        LineCursor cursor(content);
+        LineSpan line;
+        size_t keepFrom = 0;
+        size_t lineNumber = 0;
         bool insideInjectionBlock = false;
         bool injectionFound = false;
-        int startLine = -1, endLine = -1;
-        int i = 0;
-        for (; i < lines.size(); ++i) {
-            const std::string& line = lines[i];
-            // Start block
-            if (!insideInjectionBlock &&
-                line.find("-- ========================================") != std::string::npos &&
-                i + 1 < lines.size() &&
-                lines[i + 1].find("-- Lua Loader") != std::string::npos) {
-                insideInjectionBlock = true;
-                injectionFound = true;
-                startLine = i + 1;
-                log("Found injection start at line " + std::to_string(startLine), LOG_DEBUG, "Cleanup");
-                continue; // skip start marker line
-            }
-            if (insideInjectionBlock) {
-                // Look for the dofile line (end of block)
-                if (line.find("dofile(") != std::string::npos &&
-                    line.find("module_loader_setup.lua") != std::string::npos) {
-                    endLine = i + 1;
-                    insideInjectionBlock = false;
-                    log("Found injection end at line " + std::to_string(endLine), LOG_DEBUG, "Cleanup");
-                    // Skip dofile line too
-                    // Now, ALSO skip any consecutive blank lines after this block
-                    int skipBlanks = i + 1;
-                    while (skipBlanks < lines.size() && lines[skipBlanks].find_first_not_of(" \t\r\n") == std::string::npos) {
-                        ++skipBlanks;
+        bool written = true;
+        size_t startLine = 0, endLine = 0;
+
+        while (cursor.next(line)) {
+            ++lineNumber;
+            if (!insideInjectionBlock) {
+                if (isInjectionStart(line.text, cursor)) {
+                    if (!injectionFound) {
+                        written = hksWrite.open();
                     }
-                    i = skipBlanks - 1; // will increment to next real line at loop top
-                    continue;
+                    written = written && hksWrite.write(content.substr(keepFrom, line.begin - keepFrom));
+                    insideInjectionBlock = true;
+                    injectionFound = true;
+                    startLine = lineNumber;
+                    LOG_AT(LOG_DEBUG, "Cleanup", "Found injection start at line ", startLine);
                 }
-                // Skip everything inside injection block
                 continue;
             }
-            // Not inside block, keep line
-            cleanedLines.push_back(line);
+
+            if (isInjectionEnd(line.text)) {
+                endLine = lineNumber;
+                insideInjectionBlock = false;
+                LOG_AT(LOG_DEBUG, "Cleanup", "Found injection end at line ", endLine);
+
+                // The block's trailing blank lines go with it
+                keepFrom = line.end;
+                LineSpan blank;
+                while (cursor.peek(blank) && isBlankLine(blank.text)) {
+                    cursor.next(blank);
+                    ++lineNumber;
+                    keepFrom = blank.end;
+                }
+            }
         }
 
         if (!injectionFound) {
-            log("No LuaLoader injection found in HKS file", LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "No LuaLoader injection found in HKS file");
             return true;
         }
 
+        // The mapping has to go before the original can be replaced
         if (insideInjectionBlock) {
+            // Cutting from the block start to the end of the file would drop
+            // the script itself; the uncommitted temp file is discarded instead
             log("Warning: Injection block was not properly closed (missing dofile line)", LOG_WARNING, "Cleanup");
+            hksMap.close();
+            return restoreFromInjectionBackup(hksPath, backupDir);
+        }
+        if (written) {
+            written = hksWrite.write(content.substr(keepFrom));
         }
+        hksMap.close();
 
-        if (writeFileLines(hksPath, cleanedLines)) {
+        if (written && hksWrite.commit()) {
             log("Removed LuaLoader injection (and trailing blank lines)", LOG_INFO, "Cleanup");
-            if (startLine > 0)
-                log("Injection was between lines " + std::to_string(startLine) +
-                    " and " + std::to_string(endLine > 0 ? endLine : startLine), LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "Injection was between lines ", startLine,
+                " and ", (endLine > 0 ? endLine : startLine));
             return true;
         }
         else {
-            log("Failed to write cleaned HKS file", LOG_ERROR, "Cleanup");
+            log("Failed to write cleaned HKS file: " + hksWrite.lastError(), LOG_ERROR, "Cleanup");
             return false;
         }
     }
 
     void debugHksFile(const std::string& hksPath) {
-        if (!fs::exists(hksPath)) {
-            log("HKS file not found: " + hksPath, LOG_DEBUG, "Cleanup");
+        if (!pfs::exists(hksPath)) {
+            LOG_AT(LOG_DEBUG, "Cleanup", "HKS file not found: ", hksPath);
+            return;
+        }
+        if (!isLogEnabled(LOG_DEBUG)) {
             return;
         }
 
-        auto lines = readFileLines(hksPath);
-        if (lines.empty()) {
+        MappedFile hksMap;
+        if (!hksMap.open(hksPath) || hksMap.view().empty()) {
             log("Unable to read HKS file content", LOG_ERROR, "Cleanup");
             return;
         }
 
-        log("==========================================", LOG_DEBUG, "Cleanup");
-        log("HKS FILE DEBUG ANALYSIS", LOG_DEBUG, "Cleanup");
-        log("File: " + hksPath, LOG_DEBUG, "Cleanup");
-        log("Total lines: " + std::to_string(lines.size()), LOG_DEBUG, "Cleanup");
-        log("==========================================", LOG_DEBUG, "Cleanup");
-
-        // Look for any lines containing "LuaLoader" or "Lua Loader"
+        // One pass: report matching lines, remember the first and last five
+        constexpr size_t CONTEXT_LINES = 5;
+        LineSpan firstLines[CONTEXT_LINES], lastLines[CONTEXT_LINES];
+        LineCursor cursor(hksMap.view());
+        LineSpan line;
+        size_t lineCount = 0;
         bool foundAnyInjection = false;
-        for (int i = 0; i < lines.size(); ++i) {
-            const std::string& line = lines[i];
-            if (line.find("LuaLoader") != std::string::npos ||
-                line.find("Lua Loader") != std::string::npos ||
-                line.find("module_loader") != std::string::npos) {
 
-                log("Line " + std::to_string(i + 1) + ": " + line, LOG_DEBUG, "Cleanup");
+        LOG_AT(LOG_DEBUG, "Cleanup", "==========================================");
+        LOG_AT(LOG_DEBUG, "Cleanup", "HKS FILE DEBUG ANALYSIS");
+        LOG_AT(LOG_DEBUG, "Cleanup", "File: ", hksPath);
+
+        while (cursor.next(line)) {
+            if (lineCount < CONTEXT_LINES) {
+                firstLines[lineCount] = line;
+            }
+            lastLines[lineCount % CONTEXT_LINES] = line;
+            ++lineCount;
+
+            // Look for any lines containing "LuaLoader" or "Lua Loader"
+            if (contains(line.text, "LuaLoader") ||
+                contains(line.text, "Lua Loader") ||
+                contains(line.text, "module_loader")) {
+
+                LOG_AT(LOG_DEBUG, "Cleanup", "Line ", lineCount, ": ", line.text);
                 foundAnyInjection = true;
             }
         }
 
+        LOG_AT(LOG_DEBUG, "Cleanup", "Total lines: ", lineCount);
+        LOG_AT(LOG_DEBUG, "Cleanup", "==========================================");
+
         if (!foundAnyInjection) {
-            log("No LuaLoader-related content found in HKS file", LOG_DEBUG, "Cleanup");
+            LOG_AT(LOG_DEBUG, "Cleanup", "No LuaLoader-related content found in HKS file");
 
             // Show first and last 5 lines for context
-            log("First 5 lines:", LOG_TRACE, "Cleanup");
-            for (int i = 0; i < std::min(5, static_cast<int>(lines.size())); ++i) {
-                log("Line " + std::to_string(i + 1) + ": " + lines[i], LOG_TRACE, "Cleanup");
+            LOG_AT(LOG_TRACE, "Cleanup", "First 5 lines:");
+            for (size_t i = 0; i < std::min(CONTEXT_LINES, lineCount); ++i) {
+                LOG_AT(LOG_TRACE, "Cleanup", "Line ", i + 1, ": ", firstLines[i].text);
             }
 
-            if (lines.size() > 10) {
-                log("Last 5 lines:", LOG_TRACE, "Cleanup");
-                for (int i = std::max(0, static_cast<int>(lines.size()) - 5); i < lines.size(); ++i) {
-                    log("Line " + std::to_string(i + 1) + ": " + lines[i], LOG_TRACE, "Cleanup");
+            if (lineCount > 2 * CONTEXT_LINES) {
+                LOG_AT(LOG_TRACE, "Cleanup", "Last 5 lines:");
+                for (size_t i = lineCount - CONTEXT_LINES; i < lineCount; ++i) {
+                    LOG_AT(LOG_TRACE, "Cleanup", "Line ", i + 1, ": ", lastLines[i % CONTEXT_LINES].text);
                 }
             }
         }
 
-        log("==========================================", LOG_DEBUG, "Cleanup");
+        LOG_AT(LOG_DEBUG, "Cleanup", "==========================================");
     }
 
 } // namespace Cleanup
\ No newline at end of file
@@ -21,8 +21,10 @@ namespace Cleanup {
     bool cleanupFlagFiles(const std::string& modulePath);
 
     // Removes LuaLoader injection block from HKS file (creates backup first)
-    // Returns true on success or if no injection found
-    bool cleanupHksInjection(const std::string& hksPath);
+    // Returns true on success or if no injection found. A block missing its
+    // dofile line is not cut out; the file is restored from its newest
+    // "injection" backup in backupDir instead, or left unchanged without one.
+    bool cleanupHksInjection(const std::string& hksPath, const std::string& backupDir = std::string());
 
     // Debug function to analyze HKS file content
     void debugHksFile(const std::string& hksPath);
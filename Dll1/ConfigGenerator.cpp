@@ -5,19 +5,13 @@
 // =============================================
 #include "ConfigGenerator.h"
 #include "Logger.h"
-#include <fstream>
+#include "FileIO.h"
 
 void generateDefaultConfigToml(const std::string& configPath) {
-    log("Generating default TOML config file", LOG_DEBUG, "ConfigGenerator");
-    log("Target config path: " + configPath, LOG_DEBUG, "ConfigGenerator");
+    LOG_AT(LOG_DEBUG, "ConfigGenerator", "Generating default TOML config file");
+    LOG_AT(LOG_DEBUG, "ConfigGenerator", "Target config path: ", configPath);
 
-    std::ofstream out(configPath);
-    if (!out.is_open()) {
-        log("Failed to create default config file: " + configPath, LOG_ERROR, "ConfigGenerator");
-        return;
-    }
-
-    out << R"(# ======================================
+    static const char* DEFAULT_CONFIG = R"(# ======================================
 # LuaLoader Configuration (v1)
 # Generated automatically by LuaLoader
 # Author: Malice
@@ -36,6 +30,11 @@ configVersion = 1
 # REQUIRED: Path to your main HKS scripts
 gameScriptPath = "mod/action/script"   # Relative to your .me3 file or absolute path
 
+# OPTIONAL: Behaviour scripts to inject into, inside gameScriptPath.
+# A list or a comma separated string; * and ? match file names, e.g.
+#   hksTargets = ["c0000.hks", "c4*.hks"]
+hksTargets = ["c0000.hks"]
+
 # OPTIONAL: Path to Lua modules (defaults to gameScriptPath)
 modulePath = "mod/action/script/lua"
 
@@ -54,6 +53,27 @@ logLevel = "info"
 #   false = Only backup when actually injecting code (not when already injected)
 backupHKSonLaunch = false        # true/false. If true, backup c0000.hks each launch. If false, only backup when injecting code.
 backupHKSFolder = "HKS-Backups"  # Folder path for HKS backups (relative or absolute). Leave blank for same directory.
+# Identical backups share one copy in <backup folder>/objects; backup_catalog.txt
+# lists every backup. Retention limits prune the oldest backups of each HKS file
+# (0 = unlimited); the newest pre-injection backup of each file is always kept.
+backupKeepCount = 0              # Keep at most this many backups per HKS file.
+backupMaxSizeMB = 0              # Keep at most this many MB of distinct backup content per HKS file.
+# backupDeltas = true stores each new HKS revision as a small delta against the
+# last full backup (a new full backup is taken when the file changed a lot).
+backupDeltas = false             # true/false. Store changed revisions as deltas instead of full copies.
+
+# === FILE WRITES ===
+# Every file LuaLoader rewrites (HKS, this config, the .me3, backups) is written
+# to a temp file and renamed over the original, so a crash never leaves half a
+# file. durableWrites = true also flushes each file to disk before the rename,
+# which protects against power loss at the cost of a short stall per write.
+durableWrites = true             # true/false. Flush files to disk before replacing them.
+
+# === MODULE LOADING ===
+# precompileModules = true compiles every module into _module_loader/bytecode
+# at launch (only sources that changed are recompiled). The setup script uses
+# the cached chunks when the game's Lua runtime can load them.
+precompileModules = false        # true/false. Cache precompiled module bytecode between launches.
 
 # === CLEANUP OPTIONS ===
 # Set to true to remove all LuaLoader artifacts on next launch:
@@ -63,15 +83,31 @@ backupHKSFolder = "HKS-Backups"  # Folder path for HKS backups (relative or abso
 # This flag automatically resets to false after cleanup completes.
 cleanupOnNextLaunch = false      # true/false. Set to true to cleanup and reset project state.
 
+# === PER-MODULE SETTINGS (optional) ===
+# One table per module file (name without .lua). Tables must stay below every
+# setting above: each key after a [modules.<name>] line belongs to that module.
+#   [modules.my_module]
+#   enabled = true                 # false = never loaded
+#   priority = 10                  # Higher loads first (default 0); ties load by name
+#   lazy = false                   # true = skipped at startup, loaded by require("my_module")
+#   env = { difficulty = "hard" }  # Read in the module with moduleEnv("my_module")
+
 # ======================================
 # --- INSTRUCTIONS ---
 # Edit paths as needed, save this file, and relaunch the game.
+# While the game runs, saving this file reloads it: logLevel, the backup
+# options and durableWrites apply at once; other changes wait for a relaunch.
 # If you move this config, update the .me3 to point to it with 'luaLoaderConfigPath'.
 # To cleanup the project: set cleanupOnNextLaunch = true and relaunch.
 # ======================================
 )";
 
-    out.close();
+    // A half-written config would be parsed on the next launch; publish it whole
+    std::string error;
+    if (!writeTextFileAtomic(configPath, DEFAULT_CONFIG, error)) {
+        log("Failed to create default config file: " + configPath + " (" + error + ")", LOG_ERROR, "ConfigGenerator");
+        return;
+    }
     log("Default configuration file created successfully", LOG_INFO, "ConfigGenerator");
-    log("Config file location: " + configPath, LOG_DEBUG, "ConfigGenerator");
+    LOG_AT(LOG_DEBUG, "ConfigGenerator", "Config file location: ", configPath);
 }
\ No newline at end of file
@@ -6,25 +6,252 @@
 #include "ConfigParser.h"
 #include "Logger.h"
 #include "PathUtils.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
 #include <fstream>
 #include <filesystem>
 #include <sstream>
 #include <algorithm>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
 
 namespace fs = std::filesystem;
 
+namespace {
+    bool isTrimChar(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    char toLowerAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // Case-insensitive comparison against a lowercase literal, without copying
+    bool equalsLower(std::string_view value, std::string_view lowerLiteral) {
+        if (value.size() != lowerLiteral.size()) return false;
+        for (size_t i = 0; i < value.size(); ++i) {
+            if (toLowerAscii(value[i]) != lowerLiteral[i]) return false;
+        }
+        return true;
+    }
+
+    // Matches std::stoi: leading whitespace, optional sign, then at least one digit
+    bool parseIntValue(std::string_view value, int& out) {
+        size_t pos = 0;
+        while (pos < value.size() && (isTrimChar(value[pos]) || value[pos] == '\v' || value[pos] == '\f')) ++pos;
+        if (pos < value.size() && value[pos] == '+') {
+            ++pos;
+            if (pos < value.size() && value[pos] == '-') return false;
+        }
+
+        const char* first = value.data() + pos;
+        const char* last = value.data() + value.size();
+        auto result = std::from_chars(first, last, out);
+        return result.ec == std::errc();
+    }
+
+    //  Compile-time perfect hash over the known keys 
+    enum class ConfigKey : unsigned char {
+        Unknown,
+        ConfigVersion,
+        LogLevel,
+        GameScriptPath,
+        ModulePath,
+        BackupHKSonLaunch,
+        CleanupOnNextLaunch,
+        PrecompileModules,
+        BackupHKSFolder,
+        BackupKeepCount,
+        BackupMaxSizeMB,
+        BackupDeltas,
+        DurableWrites,
+        HksTargets,
+    };
+
+    struct KeyEntry {
+        std::string_view name;
+        ConfigKey id;
+    };
+
+    constexpr KeyEntry KNOWN_KEYS[] = {
+        { "configVersion", ConfigKey::ConfigVersion },
+        { "logLevel", ConfigKey::LogLevel },
+        { "scriptPath", ConfigKey::GameScriptPath },
+        { "gameScriptPath", ConfigKey::GameScriptPath },
+        { "modulePath", ConfigKey::ModulePath },
+        { "backupHKSonLaunch", ConfigKey::BackupHKSonLaunch },
+        { "cleanupOnNextLaunch", ConfigKey::CleanupOnNextLaunch },
+        { "precompileModules", ConfigKey::PrecompileModules },
+        { "backupHKSFolder", ConfigKey::BackupHKSFolder },
+        { "backupKeepCount", ConfigKey::BackupKeepCount },
+        { "backupMaxSizeMB", ConfigKey::BackupMaxSizeMB },
+        { "backupDeltas", ConfigKey::BackupDeltas },
+        { "durableWrites", ConfigKey::DurableWrites },
+        { "hksTargets", ConfigKey::HksTargets },
+    };
+
+    constexpr size_t KEY_TABLE_SIZE = 64;
+
+    // FNV-1a seeded with a value chosen at compile time so no two keys share a slot
+    constexpr uint32_t hashKey(std::string_view key, uint32_t seed) {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char c : key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    constexpr bool isCollisionFree(uint32_t seed) {
+        bool used[KEY_TABLE_SIZE] = {};
+        for (const auto& entry : KNOWN_KEYS) {
+            size_t slot = hashKey(entry.name, seed) % KEY_TABLE_SIZE;
+            if (used[slot]) return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    constexpr uint32_t findKeySeed() {
+        for (uint32_t seed = 0; seed < 100000; ++seed) {
+            if (isCollisionFree(seed)) return seed;
+        }
+        return 0;
+    }
+
+    constexpr uint32_t KEY_SEED = findKeySeed();
+    static_assert(isCollisionFree(KEY_SEED), "No collision-free seed for config keys; grow KEY_TABLE_SIZE");
+
+    struct KeyTable {
+        KeyEntry slots[KEY_TABLE_SIZE];
+    };
+
+    constexpr KeyTable buildKeyTable() {
+        KeyTable table{};
+        for (auto& slot : table.slots) {
+            slot = { std::string_view(), ConfigKey::Unknown };
+        }
+        for (const auto& entry : KNOWN_KEYS) {
+            table.slots[hashKey(entry.name, KEY_SEED) % KEY_TABLE_SIZE] = entry;
+        }
+        return table;
+    }
+
+    constexpr KeyTable KEY_TABLE = buildKeyTable();
+
+    ConfigKey lookupConfigKey(std::string_view key) {
+        const KeyEntry& entry = KEY_TABLE.slots[hashKey(key, KEY_SEED) % KEY_TABLE_SIZE];
+        return entry.name == key ? entry.id : ConfigKey::Unknown;
+    }
+
+    //  Single-pass line tokenizer over the file buffer 
+    struct TomlLine {
+        int number = 0;
+        size_t offset = 0;       // Start of the raw line in the buffer
+        std::string_view text;   // Comment stripped and trimmed
+        size_t eq = std::string_view::npos;  // First '=' outside quotes, relative to text
+    };
+
+    class TomlTokenizer {
+    public:
+        explicit TomlTokenizer(std::string_view buffer) : buffer_(buffer) {}
+
+        // The line next() would yield, without consuming it
+        bool peek(TomlLine& out) const {
+            TomlTokenizer copy = *this;
+            return copy.next(out);
+        }
+
+        // Yields lines exactly as std::getline would, including the empty ones
+        bool next(TomlLine& out) {
+            if (pos_ >= buffer_.size()) return false;
+
+            size_t end = buffer_.find('\n', pos_);
+            if (end == std::string_view::npos) end = buffer_.size();
+            std::string_view raw = buffer_.substr(pos_, end - pos_);
+            out.offset = pos_;
+            pos_ = end + 1;
+
+            // Text-mode reads turn CRLF into LF
+            if (!raw.empty() && raw.back() == '\r') raw.remove_suffix(1);
+
+            out.number = ++lineNumber_;
+            scan(raw, out);
+            return true;
+        }
+
+    private:
+        // Finds the comment start and the first '=' in one quote-aware pass
+        static void scan(std::string_view raw, TomlLine& out) {
+            size_t commentPos = std::string_view::npos;
+            size_t eq = std::string_view::npos;
+            bool inQuotes = false;
+            char quoteChar = '\0';
+
+            for (size_t i = 0; i < raw.size(); ++i) {
+                char c = raw[i];
+                if (!inQuotes && (c == '"' || c == '\'')) {
+                    inQuotes = true;
+                    quoteChar = c;
+                }
+                else if (inQuotes && c == quoteChar) {
+                    inQuotes = false;
+                    quoteChar = '\0';
+                }
+                else if (!inQuotes && c == '#') {
+                    commentPos = i;
+                    break;
+                }
+                else if (!inQuotes && c == '=' && eq == std::string_view::npos) {
+                    eq = i;
+                }
+            }
+
+            std::string_view text = raw.substr(0, commentPos);
+            size_t start = 0;
+            while (start < text.size() && isTrimChar(text[start])) ++start;
+            size_t end = text.size();
+            while (end > start && isTrimChar(text[end - 1])) --end;
+
+            out.text = text.substr(start, end - start);
+            out.eq = (eq == std::string_view::npos || eq >= end) ? std::string_view::npos : eq - start;
+        }
+
+        std::string_view buffer_;
+        size_t pos_ = 0;
+        int lineNumber_ = 0;
+    };
+
+    bool readWholeFile(const std::string& path, std::string& out) {
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) return false;
+
+        std::streamoff size = in.tellg();
+        if (size < 0) return false;
+        out.resize(static_cast<size_t>(size));
+        in.seekg(0);
+        if (size > 0 && !in.read(&out[0], size)) return false;
+
+        StartupProfiler::count(StartupProfiler::FS_READ_BYTES, out.size());
+        return true;
+    }
+}
+
 // Helper function to trim whitespace from string
-std::string trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos) return "";
-    size_t end = str.find_last_not_of(" \t\r\n");
-    return str.substr(start, end - start + 1);
+std::string_view trim(std::string_view str) {
+    size_t start = 0;
+    while (start < str.size() && isTrimChar(str[start])) ++start;
+    size_t end = str.size();
+    while (end > start && isTrimChar(str[end - 1])) --end;
+    return str.substr(start, end - start);
 }
 
 // Helper function to parse quoted strings more robustly
-std::string parseQuotedValue(const std::string& value) {
-    std::string trimmed = trim(value);
-    if (trimmed.empty()) return "";
+std::string_view parseQuotedValue(std::string_view value) {
+    std::string_view trimmed = trim(value);
+    if (trimmed.empty()) return trimmed;
 
     // Handle quoted strings
     if (trimmed.size() >= 2) {
@@ -42,90 +269,348 @@ std::string parseQuotedValue(const std::string& value) {
     return trimmed;
 }
 
+// Helper: split a TOML array or a comma separated string into its items.
+// Commas and brackets inside quotes belong to the item.
+static std::vector<std::string> parseStringList(std::string_view value) {
+    std::string_view list = trim(value);
+    if (!list.empty() && list.front() == '[') {
+        list.remove_prefix(1);
+        if (!list.empty() && list.back() == ']') list.remove_suffix(1);
+    }
+
+    std::vector<std::string> items;
+    char quoteChar = '\0';
+    size_t itemStart = 0;
+    for (size_t i = 0; i <= list.size(); ++i) {
+        if (i < list.size()) {
+            char c = list[i];
+            if (quoteChar != '\0') {
+                if (c == quoteChar) quoteChar = '\0';
+                continue;
+            }
+            if (c == '"' || c == '\'') {
+                quoteChar = c;
+                continue;
+            }
+            if (c != ',') continue;
+        }
+        std::string_view item = parseQuotedValue(list.substr(itemStart, i - itemStart));
+        if (!item.empty()) {
+            items.emplace_back(item);
+        }
+        itemStart = i + 1;
+    }
+    return items;
+}
+
 // Helper function to parse boolean values
-bool parseBoolValue(const std::string& value) {
-    std::string lower = value;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    return (lower == "true" || lower == "1" || lower == "yes" || lower == "on");
+bool parseBoolValue(std::string_view value) {
+    return equalsLower(value, "true") || equalsLower(value, "1") ||
+        equalsLower(value, "yes") || equalsLower(value, "on");
 }
 
 // Helper function to parse log level from string
-LogLevel parseLogLevel(const std::string& value) {
-    std::string lower = value;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-
-    if (lower == "trace") return LOG_TRACE;
-    if (lower == "debug") return LOG_DEBUG;
-    if (lower == "info") return LOG_INFO;
-    if (lower == "warning" || lower == "warn") return LOG_WARNING;
-    if (lower == "error") return LOG_ERROR;
+LogLevel parseLogLevel(std::string_view value) {
+    if (equalsLower(value, "trace")) return LOG_TRACE;
+    if (equalsLower(value, "debug")) return LOG_DEBUG;
+    if (equalsLower(value, "info")) return LOG_INFO;
+    if (equalsLower(value, "warning") || equalsLower(value, "warn")) return LOG_WARNING;
+    if (equalsLower(value, "error")) return LOG_ERROR;
 
     // Default to info if unrecognized
     return LOG_INFO;
 }
 
-// Helper function to get log level name as string
-std::string getLogLevelName(LogLevel level) {
-    switch (level) {
-    case LOG_TRACE: return "trace";
-    case LOG_DEBUG: return "debug";
-    case LOG_INFO: return "info";
-    case LOG_WARNING: return "warning";
-    case LOG_ERROR: return "error";
-    case LOG_BRAND: return "brand";
-    default: return "info";
+// Helper function to parse a non-negative retention limit (0 = unlimited)
+static unsigned parseRetentionLimit(std::string_view key, std::string_view value, int lineNumber) {
+    int limit = 0;
+    if (!parseIntValue(value, limit) || limit < 0) {
+        log("Invalid " + std::string(key) + " value '" + std::string(value) + "' on line " + std::to_string(lineNumber) + ". Using 0 (unlimited).", LOG_WARNING, "ConfigParser");
+        return 0;
     }
+    return static_cast<unsigned>(limit);
 }
 
-// Helper function to parse key-value pair from line
-bool parseKeyValue(const std::string& line, std::string& key, std::string& value) {
-    // Find the first '=' that's not inside quotes
-    size_t eq = std::string::npos;
-    bool inQuotes = false;
+// Helper: true once every '[' and '{' outside quotes is closed again
+static bool isBracketBalanced(std::string_view value) {
+    int depth = 0;
     char quoteChar = '\0';
+    for (char c : value) {
+        if (quoteChar != '\0') {
+            if (c == quoteChar) quoteChar = '\0';
+        }
+        else if (c == '"' || c == '\'') quoteChar = c;
+        else if (c == '[' || c == '{') ++depth;
+        else if (c == ']' || c == '}') --depth;
+    }
+    return depth <= 0;
+}
 
-    for (size_t i = 0; i < line.length(); ++i) {
-        char c = line[i];
-        if (!inQuotes && (c == '"' || c == '\'')) {
-            inQuotes = true;
-            quoteChar = c;
+// Helper: split "a.b.\"c.d\"" into its keys; quoted keys may contain dots
+static bool splitDottedKey(std::string_view dotted, std::vector<std::string>& outParts) {
+    outParts.clear();
+    while (true) {
+        dotted = trim(dotted);
+        if (dotted.empty()) return false;
+
+        size_t end;
+        if (dotted.front() == '"' || dotted.front() == '\'') {
+            end = dotted.find(dotted.front(), 1);
+            if (end == std::string_view::npos) return false;
+            outParts.emplace_back(dotted.substr(1, end - 1));
+            ++end;
         }
-        else if (inQuotes && c == quoteChar) {
-            inQuotes = false;
-            quoteChar = '\0';
+        else {
+            end = dotted.find('.');
+            if (end == std::string_view::npos) end = dotted.size();
+            std::string_view part = trim(dotted.substr(0, end));
+            if (part.empty()) return false;
+            outParts.emplace_back(part);
         }
-        else if (!inQuotes && c == '=') {
-            eq = i;
-            break;
+
+        std::string_view rest = trim(dotted.substr(end));
+        if (rest.empty()) return true;
+        if (rest.front() != '.') return false;
+        dotted = rest.substr(1);
+    }
+}
+
+// Helper: split "{ a = 1, b = { c = 2 } }" into its top-level key/value pairs
+static bool parseInlineTable(std::string_view value, std::vector<std::pair<std::string_view, std::string_view>>& outEntries) {
+    std::string_view table = trim(value);
+    if (table.size() < 2 || table.front() != '{' || table.back() != '}') return false;
+    table = table.substr(1, table.size() - 2);
+
+    outEntries.clear();
+    int depth = 0;
+    char quoteChar = '\0';
+    size_t start = 0;
+    for (size_t i = 0; i <= table.size(); ++i) {
+        char c = i < table.size() ? table[i] : ',';
+        if (quoteChar != '\0') {
+            if (c == quoteChar) quoteChar = '\0';
+            continue;
+        }
+        if (c == '"' || c == '\'') quoteChar = c;
+        else if (c == '[' || c == '{') ++depth;
+        else if (c == ']' || c == '}') --depth;
+        else if (c == ',' && depth == 0) {
+            std::string_view entry = trim(table.substr(start, i - start));
+            start = i + 1;
+            if (entry.empty()) continue;
+
+            // The first '=' outside quotes separates key and value
+            size_t eq = std::string_view::npos;
+            char entryQuote = '\0';
+            for (size_t j = 0; j < entry.size() && eq == std::string_view::npos; ++j) {
+                if (entryQuote != '\0') { if (entry[j] == entryQuote) entryQuote = '\0'; }
+                else if (entry[j] == '"' || entry[j] == '\'') entryQuote = entry[j];
+                else if (entry[j] == '=') eq = j;
+            }
+            if (eq == std::string_view::npos) return false;
+            std::string_view key = parseQuotedValue(entry.substr(0, eq));
+            if (key.empty()) return false;
+            outEntries.emplace_back(key, trim(entry.substr(eq + 1)));
         }
     }
+    return quoteChar == '\0' && depth == 0;
+}
 
-    if (eq == std::string::npos) return false;
+// Helper: set one env value of a module, replacing an earlier one with the same key
+static void setModuleEnv(ModuleSettings& module, std::string_view key, std::string_view value) {
+    for (auto& entry : module.env) {
+        if (entry.first == key) {
+            entry.second = std::string(value);
+            return;
+        }
+    }
+    module.env.emplace_back(std::string(key), std::string(value));
+}
+
+// Helper: apply one key of a [modules.<name>] table
+static void applyModuleKey(ModuleSettings& module, std::string_view moduleName, std::string_view key, std::string_view value, int lineNumber) {
+    std::string where = " for module '" + std::string(moduleName) + "' on line " + std::to_string(lineNumber);
+
+    if (key == "enabled") {
+        module.enabled = parseBoolValue(value);
+    }
+    else if (key == "lazy") {
+        module.lazy = parseBoolValue(value);
+    }
+    else if (key == "priority") {
+        int priority = 0;
+        if (parseIntValue(value, priority)) {
+            module.priority = priority;
+        }
+        else {
+            log("Invalid priority '" + std::string(value) + "'" + where + ". Using 0.", LOG_WARNING, "ConfigParser");
+            module.priority = 0;
+        }
+    }
+    else if (key == "env") {
+        std::vector<std::pair<std::string_view, std::string_view>> entries;
+        if (!parseInlineTable(value, entries)) {
+            log("Warning: env must be an inline table like { name = \"value\" }" + where, LOG_WARNING, "ConfigParser");
+            return;
+        }
+        for (const auto& [envKey, envValue] : entries) {
+            setModuleEnv(module, envKey, parseQuotedValue(envValue));
+        }
+    }
+    else {
+        log("Warning: Unknown module setting '" + std::string(key) + "'" + where, LOG_WARNING, "ConfigParser");
+    }
+}
 
-    key = trim(line.substr(0, eq));
-    value = parseQuotedValue(line.substr(eq + 1));
+// Helper: a line that can only start something new, never continue an array
+static bool startsKeyOrTable(const TomlLine& line) {
+    if (line.text.empty()) return false;
+    if (line.text.front() == '[') {
+        // "[table]" or "[[array.of.tables]]"; an array item line ends with ',' or has one
+        return line.text.back() == ']' && line.text.find(',') == std::string_view::npos;
+    }
+    return line.eq != std::string_view::npos && line.text.front() != '{';
+}
 
-    return !key.empty();
+// Helper: raw text of a key's value, followed over later lines while an array
+// is open. An array never closed ends before the next key or table, so it
+// cannot swallow the rest of the file. outOffset/outLength give its bytes in
+// the buffer, comments included.
+static std::string_view readRawValue(std::string_view buffer, TomlTokenizer& tokenizer, const TomlLine& line,
+    std::string& continuedValue, size_t& outOffset, size_t& outLength, bool reportErrors) {
+    std::string_view value = trim(line.text.substr(line.eq + 1));
+    outOffset = static_cast<size_t>(value.data() - buffer.data());
+    size_t end = outOffset + value.size();
+
+    if (!value.empty() && value.front() == '[' && !isBracketBalanced(value)) {
+        continuedValue.assign(value);
+        TomlLine next;
+        while (!isBracketBalanced(continuedValue) && tokenizer.peek(next)) {
+            if (startsKeyOrTable(next)) {
+                if (reportErrors) {
+                    log("Error: '[' opened on line " + std::to_string(line.number) + " is not closed before line " +
+                        std::to_string(next.number) + "; the value ends there", LOG_ERROR, "ConfigParser");
+                }
+                break;
+            }
+            tokenizer.next(next);
+            continuedValue += ' ';
+            continuedValue += next.text;
+            if (!next.text.empty()) {
+                end = static_cast<size_t>(next.text.data() - buffer.data()) + next.text.size();
+            }
+        }
+        value = continuedValue;
+    }
+    outLength = end - outOffset;
+    return value;
+}
+
+// Helper: true for a header whose keys describe a module instead of top-level settings
+static bool isModuleTableHeader(std::string_view header, std::vector<std::string>& parts) {
+    return header.size() >= 2 && header.back() == ']' && header[1] != '[' &&
+        splitDottedKey(header.substr(1, header.size() - 2), parts) && parts[0] == "modules";
+}
+
+// Helper: remember where a top-level value is; a later occurrence wins, as in parsing
+static void recordValueSpan(ConfigLayout& layout, std::string_view buffer, std::string_view key, size_t offset, size_t length) {
+    std::string_view text = buffer.substr(offset, length);
+    for (auto& span : layout.values) {
+        if (span.key == key) {
+            span.offset = offset;
+            span.text.assign(text);
+            return;
+        }
+    }
+    layout.values.push_back(ConfigValueSpan{ std::string(key), offset, std::string(text) });
+}
+
+// Helper: the file's line ending; CRLF (what the generator writes) when it has none yet
+static std::string detectNewline(std::string_view buffer) {
+    size_t newline = buffer.find('\n');
+    return (newline == std::string_view::npos || (newline > 0 && buffer[newline - 1] == '\r')) ? "\r\n" : "\n";
+}
+
+// Helper: layout of a TOML without applying any setting
+static void scanConfigLayout(std::string_view buffer, ConfigLayout& outLayout) {
+    outLayout = ConfigLayout();
+    outLayout.newline = detectNewline(buffer);
+
+    TomlTokenizer tokenizer(buffer);
+    TomlLine line;
+    std::vector<std::string> headerParts;
+    std::string continuedValue;
+    bool topLevel = true;
+    while (tokenizer.next(line)) {
+        if (line.text.empty()) continue;
+        if (line.text[0] == '[') {
+            if (outLayout.firstTableOffset == std::string::npos) outLayout.firstTableOffset = line.offset;
+            topLevel = !isModuleTableHeader(line.text, headerParts);
+            continue;
+        }
+        if (line.eq == std::string_view::npos) continue;
+
+        std::string_view key = trim(line.text.substr(0, line.eq));
+        size_t offset = 0, length = 0;
+        readRawValue(buffer, tokenizer, line, continuedValue, offset, length, false);
+        if (topLevel && !key.empty()) {
+            recordValueSpan(outLayout, buffer, key, offset, length);
+        }
+    }
+}
+
+// Helper: the recorded span still describes content: same bytes, and "key =" right before them
+static bool spanMatches(std::string_view content, const ConfigValueSpan& span) {
+    if (span.offset > content.size() || content.size() - span.offset < span.text.size() ||
+        content.compare(span.offset, span.text.size(), span.text) != 0) {
+        return false;
+    }
+    size_t pos = span.offset;
+    while (pos > 0 && (content[pos - 1] == ' ' || content[pos - 1] == '\t')) --pos;
+    if (pos == 0 || content[pos - 1] != '=') return false;
+    --pos;
+    while (pos > 0 && (content[pos - 1] == ' ' || content[pos - 1] == '\t')) --pos;
+    return pos >= span.key.size() && content.compare(pos - span.key.size(), span.key.size(), span.key) == 0;
+}
+
+static ConfigValueSpan* findValueSpan(ConfigLayout& layout, std::string_view key) {
+    for (auto& span : layout.values) {
+        if (span.key == key) return &span;
+    }
+    return nullptr;
+}
+
+// Helper function to get log level name as string
+std::string getLogLevelName(LogLevel level) {
+    switch (level) {
+    case LOG_TRACE: return "trace";
+    case LOG_DEBUG: return "debug";
+    case LOG_INFO: return "info";
+    case LOG_WARNING: return "warning";
+    case LOG_ERROR: return "error";
+    case LOG_BRAND: return "brand";
+    default: return "info";
+    }
 }
 
 // Helper function to validate HKS file for backup
 bool validateHKSForBackup(const std::string& hksPath) {
     try {
         // Check if file exists
-        if (!fs::exists(hksPath)) {
+        if (!pfs::exists(hksPath)) {
             log("HKS file does not exist, skipping backup: " + hksPath, LOG_WARNING, "ConfigParser");
             return false;
         }
 
         // Check if it's a regular file
-        if (!fs::is_regular_file(hksPath)) {
+        if (!pfs::is_regular_file(hksPath)) {
             log("HKS path is not a regular file, skipping backup: " + hksPath, LOG_WARNING, "ConfigParser");
             return false;
         }
 
         // Check if file has content (not empty)
         std::error_code ec;
-        auto fileSize = fs::file_size(hksPath, ec);
+        auto fileSize = pfs::file_size(hksPath, ec);
         if (ec) {
             log("Cannot determine HKS file size, skipping backup: " + hksPath + " - " + ec.message(), LOG_WARNING, "ConfigParser");
             return false;
@@ -136,15 +621,9 @@ bool validateHKSForBackup(const std::string& hksPath) {
             return false;
         }
 
-        // Check if file is readable
-        std::ifstream testFile(hksPath, std::ios::binary);
-        if (!testFile.is_open()) {
-            log("Cannot read HKS file, skipping backup: " + hksPath, LOG_WARNING, "ConfigParser");
-            return false;
-        }
-        testFile.close();
+        // Readability is proven when the backup store hashes the file
 
-        log("HKS file validated for backup: " + hksPath + " (size: " + std::to_string(fileSize) + " bytes)", LOG_DEBUG, "ConfigParser");
+        LOG_AT(LOG_DEBUG, "ConfigParser", "HKS file validated for backup: ", hksPath, " (size: ", fileSize, " bytes)");
         return true;
     }
     catch (const std::exception& e) {
@@ -153,135 +632,97 @@ bool validateHKSForBackup(const std::string& hksPath) {
     }
 }
 
-// Parse config path from .me3 file - moved from LuaLoader.cpp
-std::string parseConfigPathFromMe3(const fs::path& me3Path) {
-    std::ifstream me3in(me3Path);
-    if (!me3in.is_open()) {
-        return "";
+// Patch one top-level value in place; everything else is copied byte for byte
+bool setConfigValue(const std::string& configPath, std::string_view key, std::string_view valueLiteral, ConfigLayout* layout) {
+    MappedFile file;
+    if (!file.open(configPath)) {
+        log("Failed to open config file to update " + std::string(key) + ": " + configPath, LOG_ERROR, "ConfigParser");
+        return false;
+    }
+    std::string_view content = file.view();
+
+    // The span from parsing is only trusted while the file still has it;
+    // after an outside edit the file is scanned again
+    ConfigLayout scanned;
+    ConfigLayout* current = layout;
+    ConfigValueSpan* span = current ? findValueSpan(*current, key) : nullptr;
+    if (!span || !spanMatches(content, *span)) {
+        LOG_AT(LOG_DEBUG, "ConfigParser", "No current value span for ", key, ", scanning config");
+        scanConfigLayout(content, scanned);
+        current = &scanned;
+        span = findValueSpan(scanned, key);
     }
 
-    std::string line;
-    while (std::getline(me3in, line)) {
-        // Remove comments
-        auto commentPos = line.find('#');
-        if (commentPos != std::string::npos) {
-            line = line.substr(0, commentPos);
+    // Replace the value bytes, or add "key = value" above the first table
+    size_t offset;
+    size_t removed;
+    size_t valueOffset;
+    std::string inserted;
+    if (span) {
+        offset = span->offset;
+        removed = span->text.size();
+        valueOffset = offset;
+        inserted.assign(valueLiteral);
+    }
+    else {
+        offset = current->firstTableOffset == std::string::npos ? content.size() : current->firstTableOffset;
+        removed = 0;
+        if (offset == content.size() && !content.empty() && content.back() != '\n') {
+            inserted += current->newline;
         }
-
-        // Look for luaLoaderConfigPath
-        auto pos = line.find("luaLoaderConfigPath");
-        if (pos != std::string::npos) {
-            auto eq = line.find('=', pos);
-            if (eq != std::string::npos) {
-                std::string value = line.substr(eq + 1);
-
-                // Strip whitespace and quotes more robustly
-                value.erase(0, value.find_first_not_of(" \t\r\n"));
-                value.erase(value.find_last_not_of(" \t\r\n") + 1);
-
-                // Remove quotes (both single and double)
-                if (!value.empty() && (value.front() == '"' || value.front() == '\'')) {
-                    value.erase(0, 1);
-                }
-                if (!value.empty() && (value.back() == '"' || value.back() == '\'')) {
-                    value.pop_back();
-                }
-
-                if (!value.empty()) {
-                    return value;
-                }
-            }
+        inserted += std::string(key) + " = ";
+        valueOffset = offset + inserted.size();
+        inserted += std::string(valueLiteral) + current->newline;
+        if (offset < content.size()) {
+            inserted += current->newline;       // Keep a blank line before the table
         }
-    }
-    return "";
-}
-
-// Update config file to reset cleanup flag
-bool updateCleanupFlag(const std::string& configPath, bool newValue) {
-    if (!fs::exists(configPath)) {
-        log("Config file not found for cleanup flag update: " + configPath, LOG_ERROR, "ConfigParser");
-        return false;
+        log("Adding " + std::string(key) + " to config file", LOG_INFO, "ConfigParser");
     }
 
-    // Read all lines
-    std::ifstream in(configPath);
-    if (!in.is_open()) {
-        log("Failed to open config file for cleanup flag update", LOG_ERROR, "ConfigParser");
+    AtomicFileWriter writer(configPath);
+    bool written = writer.open() && writer.write(content.substr(0, offset)) && writer.write(inserted) &&
+        writer.write(content.substr(offset + removed));
+    file.close();   // The target must not stay mapped while it is replaced
+    if (!written || !writer.commit()) {
+        log("Failed to write updated config file: " + writer.lastError(), LOG_ERROR, "ConfigParser");
         return false;
     }
+    LOG_AT(LOG_DEBUG, "ConfigParser", "Set ", key, " = ", valueLiteral, " at byte ", valueOffset);
 
-    std::vector<std::string> lines;
-    std::string line;
-    bool flagUpdated = false;
-    int lineNumber = 0;
-
-    while (std::getline(in, line)) {
-        lineNumber++;
-
-        // More flexible detection of the cleanup flag
-        std::string trimmedLine = line;
-        // Remove leading/trailing whitespace
-        trimmedLine.erase(0, trimmedLine.find_first_not_of(" \t"));
-        trimmedLine.erase(trimmedLine.find_last_not_of(" \t") + 1);
-
-        // Check if this line contains cleanupOnNextLaunch (not commented out)
-        if (trimmedLine.find("cleanupOnNextLaunch") != std::string::npos &&
-            trimmedLine.find('=') != std::string::npos &&
-            trimmedLine.find('#') != 0) {  // Not a comment line (doesn't start with #)
-
-            // Extract the part before the equals sign
-            size_t eq = trimmedLine.find('=');
-            std::string key = trimmedLine.substr(0, eq);
-            key.erase(0, key.find_first_not_of(" \t"));
-            key.erase(key.find_last_not_of(" \t") + 1);
-
-            // Verify it's actually the cleanup flag
-            if (key == "cleanupOnNextLaunch") {
-                // Replace the entire line with the new value
-                lines.push_back("cleanupOnNextLaunch = " + std::string(newValue ? "true" : "false"));
-                flagUpdated = true;
-                log("Updated cleanupOnNextLaunch flag on line " + std::to_string(lineNumber), LOG_DEBUG, "ConfigParser");
-            }
-            else {
-                lines.push_back(line);
-            }
+    // Shift the spans behind the edit instead of rescanning the new file
+    if (layout) {
+        if (current != layout) {
+            *layout = std::move(scanned);
         }
-        else {
-            lines.push_back(line);
+        long long delta = static_cast<long long>(inserted.size()) - static_cast<long long>(removed);
+        auto moves = [&](size_t at) { return at != std::string::npos && (at > offset || (removed == 0 && at >= offset)); };
+        for (auto& value : layout->values) {
+            if (moves(value.offset)) value.offset = static_cast<size_t>(value.offset + delta);
         }
-    }
-    in.close();
-
-    if (!flagUpdated) {
-        log("cleanupOnNextLaunch flag not found in config file", LOG_WARNING, "ConfigParser");
-        log("Searching for any line containing 'cleanupOnNextLaunch':", LOG_DEBUG, "ConfigParser");
-
-        // Debug: show lines that contain the text
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].find("cleanupOnNextLaunch") != std::string::npos) {
-                log("Line " + std::to_string(i + 1) + ": " + lines[i], LOG_DEBUG, "ConfigParser");
-            }
+        if (moves(layout->firstTableOffset)) {
+            layout->firstTableOffset = static_cast<size_t>(layout->firstTableOffset + delta);
         }
-
-        // Add the flag if it doesn't exist
-        log("Adding cleanupOnNextLaunch flag to config file", LOG_INFO, "ConfigParser");
-        lines.push_back("");
-        lines.push_back("# Added by cleanup system");
-        lines.push_back("cleanupOnNextLaunch = " + std::string(newValue ? "true" : "false"));
-        flagUpdated = true;
+        ConfigValueSpan* updated = findValueSpan(*layout, key);
+        if (!updated) {
+            layout->values.push_back(ConfigValueSpan{ std::string(key), 0, std::string() });
+            updated = &layout->values.back();
+        }
+        updated->offset = valueOffset;
+        updated->text.assign(valueLiteral);
     }
+    return true;
+}
 
-    // Write back to file
-    std::ofstream out(configPath);
-    if (!out.is_open()) {
-        log("Failed to write updated config file", LOG_ERROR, "ConfigParser");
+// Update config file to reset cleanup flag
+bool updateCleanupFlag(const std::string& configPath, bool newValue, ConfigLayout* layout) {
+    if (!pfs::exists(configPath)) {
+        log("Config file not found for cleanup flag update: " + configPath, LOG_ERROR, "ConfigParser");
         return false;
     }
 
-    for (const auto& outputLine : lines) {
-        out << outputLine << "\n";
+    if (!setConfigValue(configPath, "cleanupOnNextLaunch", newValue ? "true" : "false", layout)) {
+        return false;
     }
-    out.close();
 
     log("Updated cleanupOnNextLaunch flag to: " + std::string(newValue ? "true" : "false"), LOG_INFO, "ConfigParser");
     return true;
@@ -291,114 +732,174 @@ bool parseTomlConfig(const std::string& tomlPath, LoaderConfig& outConfig) {
     // Store config directory for relative path resolution
     outConfig.configDir = normalizePath(fs::path(tomlPath).parent_path().string());
     outConfig.configFile = tomlPath;
+    outConfig.logLevel = getLogLevel();
 
-    log("Config directory: " + outConfig.configDir, LOG_DEBUG, "ConfigParser");
-    log("Parsing config: " + fs::path(tomlPath).filename().string(), LOG_DEBUG, "ConfigParser");
+    LOG_AT(LOG_DEBUG, "ConfigParser", "Config directory: ", outConfig.configDir);
+    LOG_AT(LOG_DEBUG, "ConfigParser", "Parsing config: ", fs::path(tomlPath).filename().string());
 
-    std::ifstream in(tomlPath);
-    if (!in.is_open()) {
+    std::string buffer;
+    if (!readWholeFile(tomlPath, buffer)) {
         log("Failed to open config: " + fs::path(tomlPath).filename().string(), LOG_ERROR, "ConfigParser");
         return false;
     }
 
     int configVersion = 1; // Default if not found
-    std::string line;
     bool foundGameScriptPath = false;
     bool foundModulePath = false;
     int lineNumber = 0;
 
-    while (std::getline(in, line)) {
-        lineNumber++;
-
-        // Remove inline comments (but not comments inside quoted strings)
-        size_t commentPos = std::string::npos;
-        bool inQuotes = false;
-        char quoteChar = '\0';
+    // [modules.<name>] and [modules.<name>.env] describe one module, and
+    // [modules] holds "name = { ... }" inline tables. Keys under any other
+    // table header are read as top-level keys, as they always were.
+    enum class Table { Root, Modules, Module, ModuleEnv };
+    Table table = Table::Root;
+    ModulePolicyBuilder modules;
+    ModuleSettings* currentModule = nullptr;
+    std::string currentModuleName;
+    std::vector<std::string> headerParts;
+    std::string continuedValue;
+
+    // Value spans let setConfigValue patch a setting without rewriting the file
+    outConfig.layout = ConfigLayout();
+    outConfig.layout.newline = detectNewline(buffer);
+
+    TomlTokenizer tokenizer(buffer);
+    TomlLine line;
+    while (tokenizer.next(line)) {
+        lineNumber = line.number;
+
+        // Skip empty lines
+        if (line.text.empty()) continue;
+
+        if (line.text[0] == '[') {
+            if (outConfig.layout.firstTableOffset == std::string::npos) {
+                outConfig.layout.firstTableOffset = line.offset;
+            }
+            table = Table::Root;
+            currentModule = nullptr;
+            std::string_view header = line.text;
+            bool valid = header.size() >= 2 && header.back() == ']' && header[1] != '[' &&
+                splitDottedKey(header.substr(1, header.size() - 2), headerParts);
+            if (!valid) {
+                log("Warning: Unsupported table header on line " + std::to_string(lineNumber) + ": " + std::string(line.text), LOG_WARNING, "ConfigParser");
+                continue;
+            }
+            if (headerParts[0] != "modules") continue;
 
-        for (size_t i = 0; i < line.length(); ++i) {
-            char c = line[i];
-            if (!inQuotes && (c == '"' || c == '\'')) {
-                inQuotes = true;
-                quoteChar = c;
+            if (headerParts.size() == 1) {
+                table = Table::Modules;
             }
-            else if (inQuotes && c == quoteChar) {
-                inQuotes = false;
-                quoteChar = '\0';
+            else if (headerParts.size() == 2 || (headerParts.size() == 3 && headerParts[2] == "env")) {
+                table = headerParts.size() == 2 ? Table::Module : Table::ModuleEnv;
+                currentModuleName = headerParts[1];
+                currentModule = &modules.module(currentModuleName);
             }
-            else if (!inQuotes && c == '#') {
-                commentPos = i;
-                break;
+            else {
+                log("Warning: Expected [modules.<name>] or [modules.<name>.env] on line " + std::to_string(lineNumber), LOG_WARNING, "ConfigParser");
             }
+            continue;
         }
 
-        if (commentPos != std::string::npos) {
-            line = line.substr(0, commentPos);
+        std::string_view key;
+        std::string_view value;
+        size_t valueOffset = 0;
+        size_t valueLength = 0;
+        if (line.eq != std::string_view::npos) {
+            key = trim(line.text.substr(0, line.eq));
+            // An array may continue over the following lines until its ']'
+            value = parseQuotedValue(readRawValue(buffer, tokenizer, line, continuedValue, valueOffset, valueLength, true));
+        }
+        if (key.empty()) {
+            log("Warning: Invalid syntax on line " + std::to_string(lineNumber) + ": " + std::string(line.text), LOG_WARNING, "ConfigParser");
+            continue;
+        }
+        if (table == Table::Root) {
+            recordValueSpan(outConfig.layout, buffer, key, valueOffset, valueLength);
         }
 
-        line = trim(line);
-
-        // Skip empty lines and section headers
-        if (line.empty() || line[0] == '[') continue;
-
-        std::string key, value;
-        if (!parseKeyValue(line, key, value)) {
-            log("Warning: Invalid syntax on line " + std::to_string(lineNumber) + ": " + line, LOG_WARNING, "ConfigParser");
+        //  Per-module tables 
+        if (table == Table::Module) {
+            applyModuleKey(*currentModule, currentModuleName, key, value, lineNumber);
+            continue;
+        }
+        if (table == Table::ModuleEnv) {
+            setModuleEnv(*currentModule, parseQuotedValue(key), value);
+            continue;
+        }
+        if (table == Table::Modules) {
+            std::string_view moduleName = parseQuotedValue(key);
+            std::vector<std::pair<std::string_view, std::string_view>> entries;
+            if (!parseInlineTable(value, entries)) {
+                log("Warning: Module '" + std::string(moduleName) + "' on line " + std::to_string(lineNumber) + " must be an inline table like { enabled = false }", LOG_WARNING, "ConfigParser");
+                continue;
+            }
+            ModuleSettings& module = modules.module(moduleName);
+            for (const auto& [moduleKey, moduleValue] : entries) {
+                applyModuleKey(module, moduleName, moduleKey, parseQuotedValue(moduleValue), lineNumber);
+            }
             continue;
         }
 
+        switch (lookupConfigKey(key)) {
         //  Config version logic 
-        if (key == "configVersion") {
-            try {
-                configVersion = std::stoi(value);
+        case ConfigKey::ConfigVersion:
+            if (parseIntValue(value, configVersion)) {
                 if (configVersion < 1) {
                     log("Warning: configVersion must be >= 1, defaulting to 1", LOG_WARNING, "ConfigParser");
                     configVersion = 1;
                 }
             }
-            catch (const std::exception&) {
-                log("Invalid configVersion value '" + value + "' on line " + std::to_string(lineNumber) + ". Defaulting to 1.", LOG_ERROR, "ConfigParser");
+            else {
+                log("Invalid configVersion value '" + std::string(value) + "' on line " + std::to_string(lineNumber) + ". Defaulting to 1.", LOG_ERROR, "ConfigParser");
                 configVersion = 1;
             }
-            continue;
-        }
+            break;
 
         //  Log level configuration
-        else if (key == "logLevel") {
+        case ConfigKey::LogLevel: {
             LogLevel newLevel = parseLogLevel(value);
+            outConfig.logLevel = newLevel;
             setLogLevel(newLevel);
             log("Log level set to: " + getLogLevelName(newLevel), LOG_INFO, "ConfigParser");
+            break;
         }
 
         //  Path configurations 
-        else if (key == "scriptPath" || key == "gameScriptPath") {
+        case ConfigKey::GameScriptPath: {
             if (value.empty()) {
-                log("Error: " + key + " cannot be empty on line " + std::to_string(lineNumber), LOG_ERROR, "ConfigParser");
-                continue;
+                log("Error: " + std::string(key) + " cannot be empty on line " + std::to_string(lineNumber), LOG_ERROR, "ConfigParser");
+                break;
             }
 
-            std::string absolutePath = resolvePathWithFallbacks(value, outConfig.configDir);
-            outConfig.gameScriptPath = PathInfo(value, absolutePath, outConfig.configDir);
+            std::string relativePath(value);
+            PathBase resolvedBase = PathBase::Fallback;
+            std::string absolutePath = resolvePathWithFallbacks(relativePath, outConfig.configDir, &resolvedBase);
+            outConfig.gameScriptPath = PathInfo(relativePath, absolutePath, outConfig.configDir, resolvedBase);
             foundGameScriptPath = true;
 
-            log("Game Script Path (relative): " + value, LOG_DEBUG, "ConfigParser");
-            log("Game Script Path (absolute): " + absolutePath, LOG_DEBUG, "ConfigParser");
+            LOG_AT(LOG_DEBUG, "ConfigParser", "Game Script Path (relative): ", relativePath);
+            LOG_AT(LOG_DEBUG, "ConfigParser", "Game Script Path (absolute): ", absolutePath);
+            break;
         }
-        else if (key == "modulePath") {
+        case ConfigKey::ModulePath: {
             if (value.empty()) {
                 log("Warning: modulePath is empty on line " + std::to_string(lineNumber) + ", will use gameScriptPath", LOG_WARNING, "ConfigParser");
-                continue;
+                break;
             }
 
-            std::string absolutePath = resolvePathWithFallbacks(value, outConfig.configDir);
-            outConfig.modulePath = PathInfo(value, absolutePath, outConfig.configDir);
+            std::string relativePath(value);
+            PathBase resolvedBase = PathBase::Fallback;
+            std::string absolutePath = resolvePathWithFallbacks(relativePath, outConfig.configDir, &resolvedBase);
+            outConfig.modulePath = PathInfo(relativePath, absolutePath, outConfig.configDir, resolvedBase);
             foundModulePath = true;
 
-            log("Module Path (relative): " + value, LOG_DEBUG, "ConfigParser");
-            log("Module Path (absolute): " + absolutePath, LOG_DEBUG, "ConfigParser");
+            LOG_AT(LOG_DEBUG, "ConfigParser", "Module Path (relative): ", relativePath);
+            LOG_AT(LOG_DEBUG, "ConfigParser", "Module Path (absolute): ", absolutePath);
+            break;
         }
 
         //  Boolean configurations 
-        else if (key == "backupHKSonLaunch") {
+        case ConfigKey::BackupHKSonLaunch: {
             bool requestedBackup = parseBoolValue(value);
             outConfig.backupHKSonLaunch = requestedBackup;
 
@@ -409,21 +910,68 @@ bool parseTomlConfig(const std::string& tomlPath, LoaderConfig& outConfig) {
             else {
                 log("Backup HKS on launch: disabled", LOG_INFO, "ConfigParser");
             }
+            break;
         }
-        else if (key == "cleanupOnNextLaunch") {
+        case ConfigKey::CleanupOnNextLaunch:
             outConfig.cleanupOnNextLaunch = parseBoolValue(value);
             log("Cleanup on next launch: " + std::string(outConfig.cleanupOnNextLaunch ? "enabled" : "disabled"), LOG_INFO, "ConfigParser");
-        }
+            break;
+
+        case ConfigKey::PrecompileModules:
+            outConfig.precompileModules = parseBoolValue(value);
+            log("Precompile modules: " + std::string(outConfig.precompileModules ? "enabled" : "disabled"), LOG_INFO, "ConfigParser");
+            break;
 
         //  String configurations 
-        else if (key == "backupHKSFolder") {
-            outConfig.backupHKSFolder = value;
-            log("Backup folder: " + (value.empty() ? "(same directory)" : value), LOG_INFO, "ConfigParser");
+        case ConfigKey::BackupHKSFolder:
+            outConfig.backupHKSFolder = std::string(value);
+            log("Backup folder: " + (value.empty() ? std::string("(same directory)") : outConfig.backupHKSFolder), LOG_INFO, "ConfigParser");
+            break;
+
+        //  Backup retention 
+        case ConfigKey::BackupKeepCount:
+            outConfig.backupKeepCount = parseRetentionLimit(key, value, lineNumber);
+            log("Backup retention: keep " + (outConfig.backupKeepCount ? std::to_string(outConfig.backupKeepCount) + " newest" : std::string("all")), LOG_INFO, "ConfigParser");
+            break;
+
+        case ConfigKey::BackupMaxSizeMB:
+            outConfig.backupMaxSizeMB = parseRetentionLimit(key, value, lineNumber);
+            log("Backup retention: " + (outConfig.backupMaxSizeMB ? std::to_string(outConfig.backupMaxSizeMB) + " MB max" : std::string("no size limit")), LOG_INFO, "ConfigParser");
+            break;
+
+        case ConfigKey::BackupDeltas:
+            outConfig.backupDeltas = parseBoolValue(value);
+            log("Backup deltas: " + std::string(outConfig.backupDeltas ? "enabled" : "disabled"), LOG_INFO, "ConfigParser");
+            break;
+
+        //  Injection targets 
+        case ConfigKey::HksTargets: {
+            std::vector<std::string> targets = parseStringList(value);
+            if (targets.empty()) {
+                log("Warning: hksTargets on line " + std::to_string(lineNumber) + " is empty, keeping c0000.hks", LOG_WARNING, "ConfigParser");
+                break;
+            }
+            outConfig.hksTargets = std::move(targets);
+            std::string joined;
+            for (const auto& target : outConfig.hksTargets) {
+                joined += (joined.empty() ? "" : ", ") + target;
+            }
+            log("HKS targets: " + joined, LOG_INFO, "ConfigParser");
+            break;
         }
 
+        //  File writes 
+        case ConfigKey::DurableWrites:
+            outConfig.durableWrites = parseBoolValue(value);
+            setDefaultFsyncPolicy(outConfig.durableWrites ? FsyncPolicy::Always : FsyncPolicy::Never);
+            log("Durable writes: " + std::string(outConfig.durableWrites ? "enabled" : "disabled (no flush before replace)"), LOG_INFO, "ConfigParser");
+            break;
+
         //  Unknown configuration
-        else {
-            log("Warning: Unknown configuration key '" + key + "' on line " + std::to_string(lineNumber), LOG_WARNING, "ConfigParser");
+        case ConfigKey::Unknown:
+        default:
+            log("Warning: Unknown configuration key '" + std::string(key) + "' on line " + std::to_string(lineNumber), LOG_WARNING, "ConfigParser");
+            break;
         }
     }
 
@@ -448,15 +996,15 @@ bool parseTomlConfig(const std::string& tomlPath, LoaderConfig& outConfig) {
     // Set default modulePath if not specified
     if (!foundModulePath) {
         outConfig.modulePath = outConfig.gameScriptPath;
-        log("No modulePath specified, using gameScriptPath: " + outConfig.modulePath.absolutePath, LOG_DEBUG, "ConfigParser");
+        LOG_AT(LOG_DEBUG, "ConfigParser", "No modulePath specified, using gameScriptPath: ", outConfig.modulePath.absolutePath);
     }
 
     // Validate paths exist or can be created
     try {
-        if (!fs::exists(outConfig.gameScriptPath.absolutePath)) {
+        if (!pfs::exists(outConfig.gameScriptPath.absolutePath)) {
             log("Warning: gameScriptPath does not exist: " + outConfig.gameScriptPath.absolutePath, LOG_WARNING, "ConfigParser");
         }
-        if (!fs::exists(outConfig.modulePath.absolutePath)) {
+        if (!pfs::exists(outConfig.modulePath.absolutePath)) {
             log("Warning: modulePath does not exist: " + outConfig.modulePath.absolutePath, LOG_WARNING, "ConfigParser");
         }
     }
@@ -464,9 +1012,29 @@ bool parseTomlConfig(const std::string& tomlPath, LoaderConfig& outConfig) {
         log("Warning: Cannot validate paths: " + std::string(e.what()), LOG_WARNING, "ConfigParser");
     }
 
+    // Resolve the backup folder once, so backups never probe for it again
+    if (!outConfig.backupHKSFolder.empty()) {
+        outConfig.backupDir = normalizePath(resolvePathWithFallbacks(outConfig.backupHKSFolder, outConfig.configDir, &outConfig.backupDirBase));
+        LOG_AT(LOG_DEBUG, "ConfigParser", "Backup folder (absolute): ", outConfig.backupDir);
+    }
+
     // Additional validation for HKS backup if enabled
     if (outConfig.backupHKSonLaunch) {
-        log("HKS backup is enabled - validation will occur during backup process", LOG_DEBUG, "ConfigParser");
+        LOG_AT(LOG_DEBUG, "ConfigParser", "HKS backup is enabled - validation will occur during backup process");
+    }
+
+    // Flatten the module tables once; the loader and setup script only query them
+    outConfig.modulePolicy = modules.compile();
+    if (!outConfig.modulePolicy->empty()) {
+        const ModulePolicyTable& policy = *outConfig.modulePolicy;
+        size_t disabled = 0;
+        size_t lazy = 0;
+        for (ModulePolicyTable::ModuleId id = 0; id < policy.size(); ++id) {
+            if (!policy.enabled(id)) disabled++;
+            else if (policy.lazy(id)) lazy++;
+        }
+        log("Module settings: " + std::to_string(policy.size()) + " module(s), " + std::to_string(disabled) + " disabled, " +
+            std::to_string(lazy) + " lazy", LOG_INFO, "ConfigParser");
     }
 
     log("Config parsed successfully with " + std::to_string(lineNumber) + " lines processed", LOG_INFO, "ConfigParser");
@@ -4,20 +4,41 @@
 // Purpose: Declares LoaderConfig struct and config parsing function for .me3/TOML files.
 // =============================================
 #pragma once
+#include "ModulePolicy.h"
+#include "PathUtils.h"
+#include "Logger.h"
 #include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
 #include <filesystem>
 
 struct PathInfo {
     std::string relativePath;
     std::string absolutePath;
     std::string basePath;
+    PathBase resolvedBase = PathBase::Fallback;     // Where resolvePathWithFallbacks found relativePath
 
     PathInfo() = default;
-    PathInfo(const std::string& rel, const std::string& abs, const std::string& base)
-        : relativePath(rel), absolutePath(abs), basePath(base) {
+    PathInfo(const std::string& rel, const std::string& abs, const std::string& base, PathBase resolved = PathBase::Fallback)
+        : relativePath(rel), absolutePath(abs), basePath(base), resolvedBase(resolved) {
     }
 };
 
+// Where a top-level key's value sits in the TOML, recorded while parsing
+struct ConfigValueSpan {
+    std::string key;
+    size_t offset = 0;          // First byte of the value as written (quotes included)
+    std::string text;           // Those bytes at parse time; a patch only trusts a span that still matches
+};
+
+// Byte layout of the parsed TOML, so persisted settings can be patched in place
+struct ConfigLayout {
+    std::vector<ConfigValueSpan> values;        // Last occurrence of each top-level key
+    size_t firstTableOffset = std::string::npos; // Start of the first [table] line; new keys go above it
+    std::string newline = "\r\n";               // The file's own line ending
+};
+
 struct LoaderConfig {
     PathInfo gameScriptPath;
     PathInfo modulePath;
@@ -26,24 +47,53 @@ struct LoaderConfig {
 
     // Debug log settings
     bool silentMode = false;
+    LogLevel logLevel = LOG_INFO;   // The level in effect when parsing ended (logLevel key or unchanged)
+
+    // HKS scripts to inject into, relative to gameScriptPath; '*' and '?' match file names
+    std::vector<std::string> hksTargets = { "c0000.hks" };
 
     // Backing up HKS file
     bool backupHKSonLaunch = true;
     std::string backupHKSFolder;
+    std::string backupDir;          // backupHKSFolder resolved once at load; empty = next to each HKS
+    PathBase backupDirBase = PathBase::Fallback;
+
+    // Backup retention per HKS file (0 = unlimited)
+    unsigned backupKeepCount = 0;
+    unsigned backupMaxSizeMB = 0;
+
+    // Store later HKS revisions as deltas against a full backup
+    bool backupDeltas = false;
+
+    // Flush rewritten files to disk before replacing them (fsync policy)
+    bool durableWrites = true;
 
     // Cleanup settings
     bool cleanupOnNextLaunch = false;
+
+    // Precompile modules into the bytecode cache at launch
+    bool precompileModules = false;
+
+    // [modules.<name>] tables, compiled once after parsing; shared between copies
+    std::shared_ptr<const ModulePolicyTable> modulePolicy = ModulePolicyTable::none();
+
+    // Value spans for setConfigValue
+    ConfigLayout layout;
 };
 
 // Main config parsing function
 bool parseTomlConfig(const std::string& tomlPath, LoaderConfig& outConfig);
 
-// Parse config path from .me3 file
-std::string parseConfigPathFromMe3(const std::filesystem::path& me3Path);
+// Sets a top-level key in the TOML to valueLiteral, written as is (e.g. false
+// or "\"text\""). Only the old value's bytes are replaced; a missing key is
+// added above the first table. Uses the span recorded in layout when it still
+// matches the file, otherwise rescans it, and commits through temp file +
+// rename. layout, if given, is updated to describe the new file.
+bool setConfigValue(const std::string& configPath, std::string_view key, std::string_view valueLiteral, ConfigLayout* layout = nullptr);
 
 // Updates the cleanupOnNextLaunch flag in the config file
 // Used to reset the flag to false after cleanup completes
-bool updateCleanupFlag(const std::string& configPath, bool newValue);
+bool updateCleanupFlag(const std::string& configPath, bool newValue, ConfigLayout* layout = nullptr);
 
 
 // Validates HKS file before backup
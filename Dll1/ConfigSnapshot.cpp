@@ -0,0 +1,381 @@
+// =============================================
+// File: ConfigSnapshot.cpp
+// Category: Startup Fast Path
+// Purpose: Implements hash-keyed binary config snapshots that skip parsing and path probing.
+// =============================================
+#include "ConfigSnapshot.h"
+#include "ContentHash.h"
+#include "FileIO.h"
+#include "Logger.h"
+#include "PathUtils.h"
+#include "StartupProfiler.h"
+#include <windows.h>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Layout: magic, u32 version, u32 payload size, 16-byte payload hash, payload.
+    // Integers are little-endian; strings are a u32 length and the bytes.
+    constexpr char SNAPSHOT_MAGIC[8] = { 'L', 'L', 'C', 'F', 'G', 'S', 'N', 'P' };
+    constexpr std::uint32_t SNAPSHOT_VERSION = 4;
+    constexpr size_t HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + 4 + 4 + 16;
+
+    enum ModuleFlag : std::uint32_t {
+        MODULE_ENABLED = 1u << 0,
+        MODULE_LAZY = 1u << 1,
+    };
+
+    enum SnapshotFlag : std::uint32_t {
+        FLAG_SILENT = 1u << 0,
+        FLAG_BACKUP_ON_LAUNCH = 1u << 1,
+        FLAG_BACKUP_DELTAS = 1u << 2,
+        FLAG_DURABLE_WRITES = 1u << 3,
+        FLAG_CLEANUP = 1u << 4,
+        FLAG_PRECOMPILE = 1u << 5,
+    };
+
+    class SnapshotWriter {
+    public:
+        void u32(std::uint32_t value) {
+            for (int i = 0; i < 4; ++i) data_.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+        void u64(std::uint64_t value) {
+            u32(static_cast<std::uint32_t>(value));
+            u32(static_cast<std::uint32_t>(value >> 32));
+        }
+        void str(const std::string& value) {
+            u32(static_cast<std::uint32_t>(value.size()));
+            data_.append(value);
+        }
+        void path(const PathInfo& info) {
+            str(info.relativePath);
+            str(info.absolutePath);
+            str(info.basePath);
+            u32(static_cast<std::uint32_t>(info.resolvedBase));
+        }
+        const std::string& data() const { return data_; }
+
+    private:
+        std::string data_;
+    };
+
+    // Every read is bounds-checked; the first short read poisons the rest
+    class SnapshotReader {
+    public:
+        explicit SnapshotReader(std::string_view data) : data_(data) {}
+
+        std::uint32_t u32() {
+            if (!take(4)) return 0;
+            std::uint32_t value = 0;
+            for (int i = 0; i < 4; ++i) value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data_[pos_ - 4 + i])) << (8 * i);
+            return value;
+        }
+        std::uint64_t u64() {
+            std::uint64_t low = u32();
+            return low | (static_cast<std::uint64_t>(u32()) << 32);
+        }
+        std::string str() {
+            std::uint32_t size = u32();
+            if (!take(size)) return std::string();
+            return std::string(data_.substr(pos_ - size, size));
+        }
+        PathInfo path() {
+            PathInfo info;
+            info.relativePath = str();
+            info.absolutePath = str();
+            info.basePath = str();
+            info.resolvedBase = base();
+            return info;
+        }
+        PathBase base() {
+            std::uint32_t value = u32();
+            if (value > static_cast<std::uint32_t>(PathBase::Fallback)) {
+                ok_ = false;
+                return PathBase::Fallback;
+            }
+            return static_cast<PathBase>(value);
+        }
+        bool ok() const { return ok_; }
+        bool atEnd() const { return ok_ && pos_ == data_.size(); }
+
+    private:
+        bool take(size_t size) {
+            if (!ok_ || size > data_.size() - pos_) {
+                ok_ = false;
+                return false;
+            }
+            pos_ += size;
+            return true;
+        }
+
+        std::string_view data_;
+        size_t pos_ = 0;
+        bool ok_ = true;
+    };
+
+    std::string getExecutablePath() {
+        char buf[MAX_PATH] = {};
+        return GetModuleFileNameA(nullptr, buf, MAX_PATH) ? std::string(buf) : std::string();
+    }
+
+    std::string getWorkingDirectory() {
+        std::error_code ec;
+        fs::path cwd = fs::current_path(ec);
+        return ec ? std::string() : cwd.string();
+    }
+
+    // Everything path resolution depends on besides the file system itself
+    struct SnapshotKey {
+        ContentHash tomlHash;
+        std::string tomlPath;
+        std::string me3Path;
+        std::string workingDir;
+        std::string exePath;
+    };
+
+    bool makeKey(const std::string& tomlPath, const std::string& me3Path, SnapshotKey& outKey) {
+        if (!hashFile(tomlPath, outKey.tomlHash)) {
+            return false;
+        }
+        outKey.tomlPath = tomlPath;
+        outKey.me3Path = me3Path;
+        outKey.workingDir = getWorkingDirectory();
+        outKey.exePath = getExecutablePath();
+        return true;
+    }
+}
+
+std::string getConfigSnapshotPath(const std::string& tomlPath) {
+    return fs::path(tomlPath).replace_extension(".snapshot").string();
+}
+
+bool loadConfigSnapshot(const std::string& tomlPath, const std::string& me3Path, LoaderConfig& outConfig) {
+    std::string snapshotPath = getConfigSnapshotPath(tomlPath);
+    MappedFile file;
+    if (!file.open(snapshotPath)) {
+        return false;
+    }
+    std::string_view data = file.view();
+    StartupProfiler::count(StartupProfiler::FS_READ_BYTES, data.size());
+
+    // A torn or foreign file fails here; it is simply rebuilt after the parse
+    std::uint32_t version = 0, payloadSize = 0;
+    ContentHash payloadHash;
+    bool headerOk = data.size() >= HEADER_SIZE && std::memcmp(data.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+    if (headerOk) {
+        SnapshotReader fields(data.substr(sizeof(SNAPSHOT_MAGIC)));
+        version = fields.u32();
+        payloadSize = fields.u32();
+        payloadHash.low = fields.u64();
+        payloadHash.high = fields.u64();
+        headerOk = fields.ok() && version == SNAPSHOT_VERSION && payloadSize == data.size() - HEADER_SIZE;
+    }
+    std::string_view payload = headerOk ? data.substr(HEADER_SIZE) : std::string_view();
+    if (!headerOk || hashBuffer(payload.data(), payload.size()) != payloadHash) {
+        log("Config snapshot is damaged, parsing the TOML instead: " + snapshotPath, LOG_WARNING, "ConfigSnapshot");
+        return false;
+    }
+
+    SnapshotKey current;
+    if (!makeKey(tomlPath, me3Path, current)) {
+        return false;
+    }
+
+    SnapshotReader in(payload);
+    ContentHash tomlHash;
+    tomlHash.low = in.u64();
+    tomlHash.high = in.u64();
+    std::string recordedToml = in.str();
+    std::string recordedMe3 = in.str();
+    std::string recordedCwd = in.str();
+    std::string recordedExe = in.str();
+    if (!in.ok()) {
+        return false;
+    }
+    if (tomlHash != current.tomlHash || recordedToml != current.tomlPath) {
+        LOG_AT(LOG_DEBUG, "ConfigSnapshot", "TOML changed since the snapshot was taken");
+        return false;
+    }
+    if (recordedMe3 != current.me3Path || recordedCwd != current.workingDir || recordedExe != current.exePath) {
+        LOG_AT(LOG_DEBUG, "ConfigSnapshot", "Launch location changed since the snapshot was taken");
+        return false;
+    }
+
+    LoaderConfig config;
+    config.gameScriptPath = in.path();
+    config.modulePath = in.path();
+    config.configFile = in.str();
+    config.configDir = in.str();
+    config.backupHKSFolder = in.str();
+    config.backupDir = in.str();
+    config.backupDirBase = in.base();
+    std::uint32_t targetCount = in.u32();
+    config.hksTargets.clear();
+    for (std::uint32_t i = 0; i < targetCount && in.ok(); ++i) {
+        config.hksTargets.push_back(in.str());
+    }
+    std::uint32_t flags = in.u32();
+    config.backupKeepCount = in.u32();
+    config.backupMaxSizeMB = in.u32();
+    std::uint32_t logLevel = in.u32();
+
+    // Module tables go back through the builder, so the index is rebuilt as a parse would
+    ModulePolicyBuilder modules;
+    std::uint32_t moduleCount = in.u32();
+    for (std::uint32_t i = 0; i < moduleCount && in.ok(); ++i) {
+        ModuleSettings& module = modules.module(in.str());
+        std::uint32_t moduleFlags = in.u32();
+        module.enabled = (moduleFlags & MODULE_ENABLED) != 0;
+        module.lazy = (moduleFlags & MODULE_LAZY) != 0;
+        module.priority = static_cast<std::int32_t>(in.u32());
+        std::uint32_t envCount = in.u32();
+        for (std::uint32_t j = 0; j < envCount && in.ok(); ++j) {
+            std::string envKey = in.str();
+            module.env.emplace_back(std::move(envKey), in.str());
+        }
+    }
+    config.modulePolicy = modules.compile();
+
+    // Value spans describe the TOML bytes the snapshot is keyed on
+    std::uint32_t spanCount = in.u32();
+    for (std::uint32_t i = 0; i < spanCount && in.ok(); ++i) {
+        ConfigValueSpan span;
+        span.key = in.str();
+        span.offset = static_cast<size_t>(in.u64());
+        span.text = in.str();
+        config.layout.values.push_back(std::move(span));
+    }
+    config.layout.firstTableOffset = static_cast<size_t>(in.u64());
+    config.layout.newline = in.str();
+
+    if (!in.atEnd() || logLevel > LOG_BRAND) {
+        log("Config snapshot is damaged, parsing the TOML instead: " + snapshotPath, LOG_WARNING, "ConfigSnapshot");
+        return false;
+    }
+
+    // The key pins the working directory and executable but not which folders
+    // exist; a path that would now resolve against another base needs a parse
+    bool basesCurrent = isPathBaseCurrent(config.gameScriptPath.relativePath, config.configDir, config.gameScriptPath.resolvedBase) &&
+        isPathBaseCurrent(config.modulePath.relativePath, config.configDir, config.modulePath.resolvedBase) &&
+        (config.backupHKSFolder.empty() || isPathBaseCurrent(config.backupHKSFolder, config.configDir, config.backupDirBase));
+    if (!basesCurrent) {
+        LOG_AT(LOG_DEBUG, "ConfigSnapshot", "A configured path resolves differently since the snapshot was taken");
+        return false;
+    }
+
+    config.logLevel = static_cast<LogLevel>(logLevel);
+    config.silentMode = (flags & FLAG_SILENT) != 0;
+    config.backupHKSonLaunch = (flags & FLAG_BACKUP_ON_LAUNCH) != 0;
+    config.backupDeltas = (flags & FLAG_BACKUP_DELTAS) != 0;
+    config.durableWrites = (flags & FLAG_DURABLE_WRITES) != 0;
+    config.cleanupOnNextLaunch = (flags & FLAG_CLEANUP) != 0;
+    config.precompileModules = (flags & FLAG_PRECOMPILE) != 0;
+
+    // The same global settings parseTomlConfig applies while reading the keys
+    setLogLevel(config.logLevel);
+    setDefaultFsyncPolicy(config.durableWrites ? FsyncPolicy::Always : FsyncPolicy::Never);
+
+    outConfig = config;
+    LOG_AT(LOG_DEBUG, "ConfigSnapshot", "Config loaded from snapshot: ", snapshotPath);
+    return true;
+}
+
+bool saveConfigSnapshot(const std::string& tomlPath, const std::string& me3Path, const LoaderConfig& config) {
+    SnapshotKey key;
+    if (!makeKey(tomlPath, me3Path, key)) {
+        return false;
+    }
+
+    SnapshotWriter payload;
+    payload.u64(key.tomlHash.low);
+    payload.u64(key.tomlHash.high);
+    payload.str(key.tomlPath);
+    payload.str(key.me3Path);
+    payload.str(key.workingDir);
+    payload.str(key.exePath);
+
+    payload.path(config.gameScriptPath);
+    payload.path(config.modulePath);
+    payload.str(config.configFile);
+    payload.str(config.configDir);
+    payload.str(config.backupHKSFolder);
+    payload.str(config.backupDir);
+    payload.u32(static_cast<std::uint32_t>(config.backupDirBase));
+    payload.u32(static_cast<std::uint32_t>(config.hksTargets.size()));
+    for (const auto& target : config.hksTargets) {
+        payload.str(target);
+    }
+    std::uint32_t flags = 0;
+    if (config.silentMode) flags |= FLAG_SILENT;
+    if (config.backupHKSonLaunch) flags |= FLAG_BACKUP_ON_LAUNCH;
+    if (config.backupDeltas) flags |= FLAG_BACKUP_DELTAS;
+    if (config.durableWrites) flags |= FLAG_DURABLE_WRITES;
+    if (config.cleanupOnNextLaunch) flags |= FLAG_CLEANUP;
+    if (config.precompileModules) flags |= FLAG_PRECOMPILE;
+    payload.u32(flags);
+    payload.u32(config.backupKeepCount);
+    payload.u32(config.backupMaxSizeMB);
+    payload.u32(static_cast<std::uint32_t>(config.logLevel));
+
+    const ModulePolicyTable& policy = *config.modulePolicy;
+    payload.u32(static_cast<std::uint32_t>(policy.size()));
+    for (ModulePolicyTable::ModuleId id = 0; id < policy.size(); ++id) {
+        payload.str(std::string(policy.name(id)));
+        std::uint32_t moduleFlags = 0;
+        if (policy.enabled(id)) moduleFlags |= MODULE_ENABLED;
+        if (policy.lazy(id)) moduleFlags |= MODULE_LAZY;
+        payload.u32(moduleFlags);
+        payload.u32(static_cast<std::uint32_t>(policy.priority(id)));
+        payload.u32(static_cast<std::uint32_t>(policy.envCount(id)));
+        for (size_t i = 0; i < policy.envCount(id); ++i) {
+            payload.str(std::string(policy.envKey(id, i)));
+            payload.str(std::string(policy.envValue(id, i)));
+        }
+    }
+
+    payload.u32(static_cast<std::uint32_t>(config.layout.values.size()));
+    for (const auto& span : config.layout.values) {
+        payload.str(span.key);
+        payload.u64(span.offset);
+        payload.str(span.text);
+    }
+    payload.u64(config.layout.firstTableOffset);
+    payload.str(config.layout.newline);
+
+    ContentHash payloadHash = hashBuffer(payload.data().data(), payload.data().size());
+    SnapshotWriter header;
+    header.u32(SNAPSHOT_VERSION);
+    header.u32(static_cast<std::uint32_t>(payload.data().size()));
+    header.u64(payloadHash.low);
+    header.u64(payloadHash.high);
+    std::string data(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    data += header.data();
+    data += payload.data();
+
+    // Rewritten in place like the discovery cache: a temp file + rename would
+    // change the directory the .me3 scan stamps. The payload hash catches a torn write.
+    std::string snapshotPath = getConfigSnapshotPath(tomlPath);
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    std::ofstream out(snapshotPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_AT(LOG_DEBUG, "ConfigSnapshot", "Cannot write config snapshot: ", snapshotPath);
+        return false;
+    }
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    StartupProfiler::count(StartupProfiler::FS_WRITE_BYTES, data.size());
+    out.close();
+
+    LOG_AT(LOG_DEBUG, "ConfigSnapshot", "Config snapshot recorded: ", snapshotPath);
+    return !out.fail();
+}
+
+void invalidateConfigSnapshot(const std::string& tomlPath) {
+    if (tomlPath.empty()) {
+        return;
+    }
+    std::error_code ec;
+    fs::remove(getConfigSnapshotPath(tomlPath), ec);
+}
\ No newline at end of file
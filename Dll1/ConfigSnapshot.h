@@ -0,0 +1,24 @@
+// =============================================
+// File: ConfigSnapshot.h
+// Category: Startup Fast Path
+// Purpose: Declares the binary snapshot of a parsed and resolved LoaderConfig.
+// =============================================
+#pragma once
+#include "ConfigParser.h"
+#include <string>
+
+// Path of the snapshot (<toml directory>/<toml name>.snapshot)
+std::string getConfigSnapshotPath(const std::string& tomlPath);
+
+// Fills outConfig from the snapshot when it was taken from the same TOML
+// contents, .me3 path, working directory and executable, and every configured
+// path still resolves against the base it did then. Applies the log level and
+// fsync policy as a parse would. Leaves outConfig untouched and returns false
+// when the snapshot is missing, stale or damaged.
+bool loadConfigSnapshot(const std::string& tomlPath, const std::string& me3Path, LoaderConfig& outConfig);
+
+// Records a successfully parsed config for the next launch
+bool saveConfigSnapshot(const std::string& tomlPath, const std::string& me3Path, const LoaderConfig& config);
+
+// Removes the snapshot so the next launch parses the TOML
+void invalidateConfigSnapshot(const std::string& tomlPath);
\ No newline at end of file
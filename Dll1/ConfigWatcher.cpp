@@ -0,0 +1,238 @@
+// =============================================
+// File: ConfigWatcher.cpp
+// Category: Config Parsing
+// Purpose: Implements atomic config publication and live reload of the TOML.
+// =============================================
+#include "ConfigWatcher.h"
+#include "ContentHash.h"
+#include "Logger.h"
+#include "FileIO.h"
+#include "ModuleThread.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Editors save in several steps (truncate and write, or write a temp file
+    // and rename it); wait this long after the first event before reading
+    constexpr DWORD SETTLE_MS = 250;
+
+    // Swapped with std::atomic_store; a reader's shared_ptr keeps the config
+    // it loaded alive after a reload replaces it
+    std::shared_ptr<const LoaderConfig> g_activeConfig;
+
+    std::mutex g_watcherMutex;
+    HANDLE g_stopEvent = nullptr;
+    bool g_watcherStarted = false;
+
+    struct ReloadSummary {
+        std::vector<std::string> applied;
+        std::vector<std::string> pending;     // Take effect after a restart
+    };
+
+    template <typename T>
+    bool sameValue(const T& a, const T& b) {
+        return a == b;
+    }
+
+    bool sameValue(const PathInfo& a, const PathInfo& b) {
+        return a.relativePath == b.relativePath && a.absolutePath == b.absolutePath;
+    }
+
+    bool sameValue(const std::shared_ptr<const ModulePolicyTable>& a, const std::shared_ptr<const ModulePolicyTable>& b) {
+        return *a == *b;
+    }
+
+    // Copies a changed hot key into next, or reports a changed restart-only key
+    template <typename T>
+    void mergeKey(const char* key, T LoaderConfig::* field, bool hot,
+        const LoaderConfig& fresh, LoaderConfig& next, ReloadSummary& summary) {
+        if (sameValue(next.*field, fresh.*field)) {
+            return;
+        }
+        if (hot) {
+            next.*field = fresh.*field;
+            summary.applied.push_back(key);
+        }
+        else {
+            summary.pending.push_back(key);
+        }
+    }
+
+    std::string joinKeys(const std::vector<std::string>& keys) {
+        std::string joined;
+        for (const auto& key : keys) {
+            if (!joined.empty()) joined += ", ";
+            joined += key;
+        }
+        return joined;
+    }
+
+    bool isBackupKey(const std::string& key) {
+        return key.compare(0, 6, "backup") == 0;
+    }
+
+    void reloadConfig(const std::string& tomlPath) {
+        log("Config file changed, reloading " + fs::path(tomlPath).filename().string(), LOG_INFO, "ConfigWatcher");
+
+        // The parser applies logLevel and durableWrites as it reads them; a
+        // failed parse must not leave half a file's worth of them behind
+        LogLevel previousLevel = getLogLevel();
+        FsyncPolicy previousPolicy = getDefaultFsyncPolicy();
+        LoaderConfig fresh;
+        if (!parseTomlConfig(tomlPath, fresh)) {
+            setLogLevel(previousLevel);
+            setDefaultFsyncPolicy(previousPolicy);
+            log("Config reload failed - keeping the current settings", LOG_WARNING, "ConfigWatcher");
+            return;
+        }
+
+        std::shared_ptr<const LoaderConfig> current = getActiveConfig();
+        if (!current) {
+            return;
+        }
+
+        LoaderConfig next = *current;
+        ReloadSummary summary;
+        mergeKey("logLevel", &LoaderConfig::logLevel, true, fresh, next, summary);
+        mergeKey("backupHKSonLaunch", &LoaderConfig::backupHKSonLaunch, true, fresh, next, summary);
+        mergeKey("backupHKSFolder", &LoaderConfig::backupHKSFolder, true, fresh, next, summary);
+        next.backupDir = fresh.backupDir;
+        next.backupDirBase = fresh.backupDirBase;
+        mergeKey("backupKeepCount", &LoaderConfig::backupKeepCount, true, fresh, next, summary);
+        mergeKey("backupMaxSizeMB", &LoaderConfig::backupMaxSizeMB, true, fresh, next, summary);
+        mergeKey("backupDeltas", &LoaderConfig::backupDeltas, true, fresh, next, summary);
+        mergeKey("durableWrites", &LoaderConfig::durableWrites, true, fresh, next, summary);
+
+        // Already baked into the setup script, the HKS injection or this launch
+        mergeKey("gameScriptPath", &LoaderConfig::gameScriptPath, false, fresh, next, summary);
+        mergeKey("modulePath", &LoaderConfig::modulePath, false, fresh, next, summary);
+        mergeKey("hksTargets", &LoaderConfig::hksTargets, false, fresh, next, summary);
+        mergeKey("precompileModules", &LoaderConfig::precompileModules, false, fresh, next, summary);
+        mergeKey("cleanupOnNextLaunch", &LoaderConfig::cleanupOnNextLaunch, false, fresh, next, summary);
+        mergeKey("modules", &LoaderConfig::modulePolicy, false, fresh, next, summary);
+
+        // Spans always follow the file, whatever was applied
+        next.layout = fresh.layout;
+
+        // The globals follow the merged config, not whatever order the parse set them in
+        setLogLevel(next.logLevel);
+        setDefaultFsyncPolicy(next.durableWrites ? FsyncPolicy::Always : FsyncPolicy::Never);
+        publishActiveConfig(next);
+
+        if (summary.applied.empty() && summary.pending.empty()) {
+            log("Config reloaded - no setting changed", LOG_INFO, "ConfigWatcher");
+        }
+        if (!summary.applied.empty()) {
+            // Jobs already on the background lane may hold the old settings
+            // (a prune captures its retention when queued)
+            bool backupKeys = std::any_of(summary.applied.begin(), summary.applied.end(), isBackupKey);
+            log("Config reloaded - applied: " + joinKeys(summary.applied) +
+                (backupKeys ? " (backup settings apply to backup jobs queued from now on)" : ""), LOG_INFO, "ConfigWatcher");
+        }
+        if (!summary.pending.empty()) {
+            log("Changed settings pending until restart: " + joinKeys(summary.pending), LOG_WARNING, "ConfigWatcher");
+        }
+    }
+
+    void watcherMain(std::string tomlPath, HANDLE change, HANDLE stopEvent, ContentHash loadedHash) {
+        // Sleeps in the wait; the reload itself should not compete with the game
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
+        HANDLE handles[2] = { stopEvent, change };
+        for (;;) {
+            DWORD signaled = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+            if (signaled != WAIT_OBJECT_0 + 1) {
+                break;
+            }
+            if (WaitForSingleObject(stopEvent, SETTLE_MS) == WAIT_OBJECT_0) {
+                break;
+            }
+            // Re-arm before reading, so a save during the reload triggers another pass
+            if (!FindNextChangeNotification(change)) {
+                LOG_AT(LOG_DEBUG, "ConfigWatcher", "Cannot re-arm config change notification");
+                break;
+            }
+
+            // The directory also holds the snapshot, the .me3 and editor temp
+            // files; only a change to the TOML's contents triggers a reload
+            ContentHash hash;
+            if (!hashFile(tomlPath, hash) || hash == loadedHash) {
+                continue;
+            }
+            loadedHash = hash;
+            reloadConfig(tomlPath);
+        }
+
+        FindCloseChangeNotification(change);
+        LOG_AT(LOG_DEBUG, "ConfigWatcher", "Config watcher stopped");
+    }
+}
+
+void publishActiveConfig(const LoaderConfig& config) {
+    std::atomic_store(&g_activeConfig, std::shared_ptr<const LoaderConfig>(std::make_shared<LoaderConfig>(config)));
+}
+
+std::shared_ptr<const LoaderConfig> getActiveConfig() {
+    return std::atomic_load(&g_activeConfig);
+}
+
+bool startConfigWatcher(const std::string& tomlPath) {
+    std::lock_guard<std::mutex> lock(g_watcherMutex);
+    if (g_watcherStarted) {
+        return true;
+    }
+
+    // Hashed before the watch is armed, so an edit in between still counts
+    ContentHash loadedHash;
+    if (!hashFile(tomlPath, loadedHash)) {
+        LOG_AT(LOG_DEBUG, "ConfigWatcher", "Cannot read config for watching: ", tomlPath);
+        return false;
+    }
+
+    // Watching the file itself is not possible; watch its directory for
+    // writes and renames (editors often replace the file on save)
+    std::wstring dir = fs::path(tomlPath).parent_path().wstring();
+    HANDLE change = FindFirstChangeNotificationW(dir.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+    if (change == INVALID_HANDLE_VALUE) {
+        LOG_AT(LOG_DEBUG, "ConfigWatcher", "Cannot watch config directory (error ", GetLastError(), ")");
+        return false;
+    }
+
+    // Owned by the module from here on; never closed, so stopConfigWatcher
+    // cannot race the thread's exit
+    if (!g_stopEvent) {
+        g_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    }
+    if (!g_stopEvent) {
+        FindCloseChangeNotification(change);
+        return false;
+    }
+
+    // Like the background I/O lane, the watcher holds a reference on the
+    // module, so DLL_PROCESS_DETACH never has to wait for it to leave
+    HANDLE stopEvent = g_stopEvent;
+    if (!startModuleThread([tomlPath, change, stopEvent, loadedHash]() { watcherMain(tomlPath, change, stopEvent, loadedHash); })) {
+        LOG_AT(LOG_DEBUG, "ConfigWatcher", "Cannot start config watcher thread");
+        FindCloseChangeNotification(change);
+        return false;
+    }
+
+    g_watcherStarted = true;
+    LOG_AT(LOG_DEBUG, "ConfigWatcher", "Watching config for changes: ", tomlPath);
+    return true;
+}
+
+void stopConfigWatcher() {
+    std::lock_guard<std::mutex> lock(g_watcherMutex);
+    if (g_stopEvent) {
+        SetEvent(g_stopEvent);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+// =============================================
+// File: ConfigWatcher.h
+// Category: Config Parsing
+// Purpose: Declares the published active config and the TOML change watcher.
+// =============================================
+#pragma once
+#include "ConfigParser.h"
+#include <memory>
+#include <string>
+
+// Makes a copy of config the active configuration
+void publishActiveConfig(const LoaderConfig& config);
+
+// The active configuration; nullptr before the first publish. The returned
+// pointer keeps that config alive after a reload replaces it.
+std::shared_ptr<const LoaderConfig> getActiveConfig();
+
+// Watches the TOML for changes on a background thread. Each change is parsed
+// into a fresh config: hot keys (logLevel, backup and write settings) apply
+// at once, keys that need a restart are reported as pending. A parse that
+// fails keeps the current config. Returns false if the watch cannot start.
+// The watcher thread holds a reference on the DLL until it exits, so a
+// FreeLibrary by the host leaves the DLL loaded while it runs.
+bool startConfigWatcher(const std::string& tomlPath);
+
+// Signals the watcher to exit without waiting; it lets go of the DLL on its way out
+void stopConfigWatcher();
\ No newline at end of file
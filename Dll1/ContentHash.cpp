@@ -0,0 +1,167 @@
+// =============================================
+// File: ContentHash.cpp
+// Category: Filesystem Utilities
+// Purpose: Implements MurmurHash3 x64 128-bit hashing for buffers and files.
+// =============================================
+#include "ContentHash.h"
+#include "FileIO.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    inline std::uint64_t rotl64(std::uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline std::uint64_t fmix64(std::uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    }
+}
+
+namespace {
+    const std::uint64_t C1 = 0x87c37b91114253d5ULL;
+    const std::uint64_t C2 = 0x4cf5ad432745937fULL;
+
+    // Body: one 16-byte block
+    inline void mixBlock(std::uint64_t& h1, std::uint64_t& h2, const std::uint8_t* block) {
+        std::uint64_t k1, k2;
+        std::memcpy(&k1, block, 8);
+        std::memcpy(&k2, block + 8, 8);
+
+        k1 *= C1; k1 = rotl64(k1, 31); k1 *= C2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= C2; k2 = rotl64(k2, 33); k2 *= C1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    // Tail (the remaining 0-15 bytes) and finalization
+    ContentHash finishHash(std::uint64_t h1, std::uint64_t h2, const std::uint8_t* tail, std::uint64_t length) {
+        std::uint64_t k1 = 0;
+        std::uint64_t k2 = 0;
+        switch (length & 15) {
+        case 15: k2 ^= static_cast<std::uint64_t>(tail[14]) << 48; [[fallthrough]];
+        case 14: k2 ^= static_cast<std::uint64_t>(tail[13]) << 40; [[fallthrough]];
+        case 13: k2 ^= static_cast<std::uint64_t>(tail[12]) << 32; [[fallthrough]];
+        case 12: k2 ^= static_cast<std::uint64_t>(tail[11]) << 24; [[fallthrough]];
+        case 11: k2 ^= static_cast<std::uint64_t>(tail[10]) << 16; [[fallthrough]];
+        case 10: k2 ^= static_cast<std::uint64_t>(tail[9]) << 8; [[fallthrough]];
+        case 9:  k2 ^= static_cast<std::uint64_t>(tail[8]);
+            k2 *= C2; k2 = rotl64(k2, 33); k2 *= C1; h2 ^= k2;
+            [[fallthrough]];
+        case 8:  k1 ^= static_cast<std::uint64_t>(tail[7]) << 56; [[fallthrough]];
+        case 7:  k1 ^= static_cast<std::uint64_t>(tail[6]) << 48; [[fallthrough]];
+        case 6:  k1 ^= static_cast<std::uint64_t>(tail[5]) << 40; [[fallthrough]];
+        case 5:  k1 ^= static_cast<std::uint64_t>(tail[4]) << 32; [[fallthrough]];
+        case 4:  k1 ^= static_cast<std::uint64_t>(tail[3]) << 24; [[fallthrough]];
+        case 3:  k1 ^= static_cast<std::uint64_t>(tail[2]) << 16; [[fallthrough]];
+        case 2:  k1 ^= static_cast<std::uint64_t>(tail[1]) << 8; [[fallthrough]];
+        case 1:  k1 ^= static_cast<std::uint64_t>(tail[0]);
+            k1 *= C1; k1 = rotl64(k1, 31); k1 *= C2; h1 ^= k1;
+            break;
+        default:
+            break;
+        }
+
+        h1 ^= length;
+        h2 ^= length;
+        h1 += h2;
+        h2 += h1;
+        h1 = fmix64(h1);
+        h2 = fmix64(h2);
+        h1 += h2;
+        h2 += h1;
+
+        return { h1, h2 };
+    }
+}
+
+ContentHash hashBuffer(const void* data, std::size_t length) {
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    const std::size_t blockCount = length / 16;
+
+    std::uint64_t h1 = 0;
+    std::uint64_t h2 = 0;
+    for (std::size_t i = 0; i < blockCount; ++i) {
+        mixBlock(h1, h2, bytes + i * 16);
+    }
+    return finishHash(h1, h2, bytes + blockCount * 16, static_cast<std::uint64_t>(length));
+}
+
+void ContentHasher::update(const void* data, std::size_t length) {
+    const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+    total_ += length;
+
+    // Top up a block left partial by the previous piece
+    if (pendingLength_ > 0) {
+        std::size_t take = std::min(length, sizeof(pending_) - pendingLength_);
+        std::memcpy(pending_ + pendingLength_, bytes, take);
+        pendingLength_ += take;
+        bytes += take;
+        length -= take;
+        if (pendingLength_ < sizeof(pending_)) {
+            return;
+        }
+        mixBlock(h1_, h2_, pending_);
+        pendingLength_ = 0;
+    }
+
+    for (; length >= 16; bytes += 16, length -= 16) {
+        mixBlock(h1_, h2_, bytes);
+    }
+    std::memcpy(pending_, bytes, length);
+    pendingLength_ = length;
+}
+
+ContentHash ContentHasher::finish() const {
+    return finishHash(h1_, h2_, pending_, total_);
+}
+
+bool hashFile(const std::string& filePath, ContentHash& outHash) {
+    // Hashed straight from a read-only view; large HKS files never get a heap copy
+    MappedFile file;
+    if (!file.open(filePath)) {
+        return false;
+    }
+
+    std::string_view content = file.view();
+    outHash = hashBuffer(content.data(), content.size());
+    return true;
+}
+
+std::string toHexString(const ContentHash& hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        hex[15 - i] = digits[(hash.low >> (i * 4)) & 0xF];
+        hex[31 - i] = digits[(hash.high >> (i * 4)) & 0xF];
+    }
+    return hex;
+}
+
+bool parseHexString(const std::string& hex, ContentHash& outHash) {
+    if (hex.size() != 32) {
+        return false;
+    }
+
+    ContentHash parsed;
+    for (int i = 0; i < 32; ++i) {
+        char c = hex[i];
+        std::uint64_t nibble;
+        if (c >= '0' && c <= '9') nibble = c - '0';
+        else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+        else return false;
+
+        std::uint64_t& half = (i < 16) ? parsed.low : parsed.high;
+        half = (half << 4) | nibble;
+    }
+
+    outHash = parsed;
+    return true;
+}
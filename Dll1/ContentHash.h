@@ -0,0 +1,45 @@
+// =============================================
+// File: ContentHash.h
+// Category: Filesystem Utilities
+// Purpose: Declares the 128-bit content hash used to key caches and fingerprints.
+// =============================================
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+struct ContentHash {
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    bool operator==(const ContentHash& other) const { return low == other.low && high == other.high; }
+    bool operator!=(const ContentHash& other) const { return !(*this == other); }
+};
+
+// Hashes a memory buffer (MurmurHash3 x64 128-bit)
+ContentHash hashBuffer(const void* data, std::size_t length);
+
+// hashBuffer over data that arrives in pieces: finish() after update() calls
+// with consecutive pieces equals hashBuffer over their concatenation
+class ContentHasher {
+public:
+    void update(const void* data, std::size_t length);
+    void update(std::string_view data) { update(data.data(), data.size()); }
+    ContentHash finish() const;
+    std::uint64_t length() const { return total_; }
+
+private:
+    std::uint64_t h1_ = 0;
+    std::uint64_t h2_ = 0;
+    std::uint64_t total_ = 0;
+    std::uint8_t pending_[16] = {};
+    std::size_t pendingLength_ = 0;
+};
+
+// Hashes a whole file; returns false if the file cannot be read
+bool hashFile(const std::string& filePath, ContentHash& outHash);
+
+// 32-character lowercase hex form, used in file names and manifests
+std::string toHexString(const ContentHash& hash);
+bool parseHexString(const std::string& hex, ContentHash& outHash);
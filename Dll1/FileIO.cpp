@@ -0,0 +1,271 @@
+// =============================================
+// File: FileIO.cpp
+// Category: Filesystem Utilities
+// Purpose: Implements MappedFile and AtomicFileWriter on top of Win32 file APIs.
+// =============================================
+#include "FileIO.h"
+#include "StartupProfiler.h"
+#include <filesystem>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // WriteFile takes a DWORD length
+    constexpr size_t MAX_WRITE_CHUNK = 64u * 1024 * 1024;
+
+    // Temp names tried before open() gives up
+    constexpr int MAX_TEMP_NAME_ATTEMPTS = 16;
+
+    std::wstring widePath(const std::string& path) {
+        return fs::path(path).wstring();
+    }
+
+    // Background writers read it while a config reload may change it
+    std::atomic<FsyncPolicy> g_defaultFsyncPolicy{ FsyncPolicy::Always };
+}
+
+void setDefaultFsyncPolicy(FsyncPolicy policy) {
+    g_defaultFsyncPolicy.store(policy, std::memory_order_relaxed);
+}
+
+FsyncPolicy getDefaultFsyncPolicy() {
+    return g_defaultFsyncPolicy.load(std::memory_order_relaxed);
+}
+
+// =============================================
+// MappedFile
+// =============================================
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    file_ = CreateFileW(widePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file_, &fileSize)) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    // A zero-length file cannot be mapped
+    if (size_ == 0) {
+        return true;
+    }
+
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) {
+        close();
+        return false;
+    }
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        close();
+        return false;
+    }
+
+    StartupProfiler::count(StartupProfiler::FS_READ_BYTES, size_);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+    size_ = 0;
+}
+
+// =============================================
+// AtomicFileWriter
+// =============================================
+
+AtomicFileWriter::AtomicFileWriter(const std::string& targetPath)
+    : AtomicFileWriter(targetPath, getDefaultFsyncPolicy()) {
+}
+
+AtomicFileWriter::AtomicFileWriter(const std::string& targetPath, FsyncPolicy policy)
+    : targetPath_(targetPath), policy_(policy) {
+}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    if (!committed_) {
+        discard();
+    }
+}
+
+bool AtomicFileWriter::open() {
+    // Each writer gets its own temp name, so two writers for one target (two
+    // threads, or two game instances sharing a mod folder) never share a file.
+    // CREATE_NEW never truncates someone else's temp file; a name that is
+    // taken, e.g. by a leftover from a crash, just moves on to the next one.
+    static std::atomic<unsigned> counter{ 0 };
+    const std::string prefix = targetPath_ + "." + std::to_string(GetCurrentProcessId()) + ".";
+
+    for (int attempt = 0; attempt < MAX_TEMP_NAME_ATTEMPTS; ++attempt) {
+        tempPath_ = prefix + std::to_string(counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        file_ = CreateFileW(widePath(tempPath_).c_str(), GENERIC_WRITE, 0,
+            nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ != INVALID_HANDLE_VALUE) {
+            opened_ = true;
+            return true;
+        }
+        DWORD error = GetLastError();
+        if (error != ERROR_FILE_EXISTS && error != ERROR_ALREADY_EXISTS) {
+            break;
+        }
+    }
+    return fail("Unable to create temporary file " + tempPath_);
+}
+
+bool AtomicFileWriter::write(std::string_view data) {
+    if (file_ == INVALID_HANDLE_VALUE) {
+        return fail("Temporary file is not open");
+    }
+
+    while (!data.empty()) {
+        DWORD chunk = static_cast<DWORD>(std::min(data.size(), MAX_WRITE_CHUNK));
+        DWORD done = 0;
+        if (!WriteFile(file_, data.data(), chunk, &done, nullptr) || done != chunk) {
+            return fail("Write operation failed");
+        }
+        data.remove_prefix(done);
+        written_ += done;
+        StartupProfiler::count(StartupProfiler::FS_WRITE_BYTES, done);
+    }
+    return true;
+}
+
+bool AtomicFileWriter::commit() {
+    return finish() && publish(policy_ == FsyncPolicy::Always);
+}
+
+bool AtomicFileWriter::finish() {
+    if (file_ == INVALID_HANDLE_VALUE) {
+        return fail("Temporary file is not open");
+    }
+
+    // Contents must be on disk before the rename makes them visible
+    bool flushed = policy_ == FsyncPolicy::Never || FlushFileBuffers(file_) != 0;
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+    if (!flushed) {
+        return fail("Flush operation failed");
+    }
+    return true;
+}
+
+bool AtomicFileWriter::publish(bool writeThrough) {
+    DWORD flags = MOVEFILE_REPLACE_EXISTING | (writeThrough ? MOVEFILE_WRITE_THROUGH : 0);
+    if (!MoveFileExW(widePath(tempPath_).c_str(), widePath(targetPath_).c_str(), flags)) {
+        return fail("Unable to replace " + targetPath_ + " (error " + std::to_string(GetLastError()) + ")");
+    }
+
+    committed_ = true;
+    return true;
+}
+
+bool AtomicFileWriter::fail(const std::string& what) {
+    error_ = what;
+    discard();
+    return false;
+}
+
+void AtomicFileWriter::discard() {
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+    // Only remove a temp file this writer created
+    if (opened_) {
+        DeleteFileW(widePath(tempPath_).c_str());
+        opened_ = false;
+    }
+}
+
+// =============================================
+// One-shot writes and batches
+// =============================================
+
+bool writeFileAtomic(const std::string& path, std::string_view data, std::string& outError) {
+    return writeFileAtomic(path, data, getDefaultFsyncPolicy(), outError);
+}
+
+bool writeFileAtomic(const std::string& path, std::string_view data, FsyncPolicy policy, std::string& outError) {
+    AtomicFileWriter writer(path, policy);
+    if (writer.open() && writer.write(data) && writer.commit()) {
+        return true;
+    }
+    outError = writer.lastError();
+    return false;
+}
+
+bool writeTextFileAtomic(const std::string& path, std::string_view text, std::string& outError) {
+    std::string data;
+    data.reserve(text.size() + text.size() / 32);
+    for (char c : text) {
+        if (c == '\n') {
+            data += '\r';
+        }
+        data += c;
+    }
+    return writeFileAtomic(path, data, outError);
+}
+
+void AtomicWriteBatch::add(const std::string& path, std::string data) {
+    pending_.push_back({ path, std::move(data) });
+}
+
+bool AtomicWriteBatch::commit() {
+    std::vector<std::unique_ptr<AtomicFileWriter>> writers;
+    writers.reserve(pending_.size());
+
+    // Write and flush everything first; until the renames start, a failure
+    // only leaves temp files behind, and the writers remove those
+    for (const auto& item : pending_) {
+        writers.push_back(std::make_unique<AtomicFileWriter>(item.path, policy_));
+        AtomicFileWriter& writer = *writers.back();
+        if (!writer.open() || !writer.write(item.data)) {
+            error_ = writer.lastError();
+            return false;
+        }
+    }
+    for (auto& writer : writers) {
+        if (!writer->finish()) {
+            error_ = writer->lastError();
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < writers.size(); ++i) {
+        bool last = i + 1 == writers.size();
+        if (!writers[i]->publish(last && policy_ == FsyncPolicy::Always)) {
+            error_ = writers[i]->lastError();
+            return false;
+        }
+    }
+    pending_.clear();
+    return true;
+}
@@ -0,0 +1,122 @@
+// =============================================
+// File: FileIO.h
+// Category: Filesystem Utilities
+// Purpose: Declares read-only file mapping and the durable atomic write layer.
+// =============================================
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <windows.h>
+
+// Read-only view of a whole file. Empty files map to an empty view.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return file_ != INVALID_HANDLE_VALUE; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// How far a commit pushes data towards the disk before the rename
+enum class FsyncPolicy {
+    Always,     // Flush file data and write the rename through; survives power loss
+    Never,      // Rename only; survives a crash or kill, not a power cut
+};
+
+// Policy used by writers that do not ask for one (durableWrites in the TOML)
+void setDefaultFsyncPolicy(FsyncPolicy policy);
+FsyncPolicy getDefaultFsyncPolicy();
+
+// Writes a replacement for a file into "<target>.<pid>.<n>.tmp", a name no
+// other writer uses, and renames it over the target on commit, so readers see
+// either the old or the new file, never a partial one. With several writers
+// the last commit wins. Pieces are written in order straight from the caller's
+// buffers. If the writer is destroyed without a commit, the temp file is removed.
+class AtomicFileWriter {
+public:
+    explicit AtomicFileWriter(const std::string& targetPath);
+    AtomicFileWriter(const std::string& targetPath, FsyncPolicy policy);
+    ~AtomicFileWriter();
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    bool open();
+    bool write(std::string_view data);
+
+    // Flushes, closes and renames over the target. Anything mapping or
+    // holding the target open must be closed first.
+    bool commit();
+
+    const std::string& targetPath() const { return targetPath_; }
+    const std::string& lastError() const { return error_; }
+    unsigned long long bytesWritten() const { return written_; }
+
+private:
+    friend class AtomicWriteBatch;
+
+    // commit() in two steps, so a batch can flush every file before renaming any
+    bool finish();
+    bool publish(bool writeThrough);
+
+    bool fail(const std::string& what);
+    void discard();
+
+    std::string targetPath_;
+    std::string tempPath_;
+    FsyncPolicy policy_;
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    unsigned long long written_ = 0;
+    bool opened_ = false;
+    bool committed_ = false;
+    std::string error_;
+};
+
+// Replaces path with data using one write call and the default policy
+bool writeFileAtomic(const std::string& path, std::string_view data, std::string& outError);
+bool writeFileAtomic(const std::string& path, std::string_view data, FsyncPolicy policy, std::string& outError);
+
+// Same, writing every '\n' as "\r\n" the way a text-mode ofstream did
+bool writeTextFileAtomic(const std::string& path, std::string_view text, std::string& outError);
+
+// Commits several files together. Every temp file is written and flushed
+// before the first rename, so a failure while writing leaves all targets
+// untouched and the renames are not interleaved with flush stalls. Only
+// the last rename is written through; NTFS commits its metadata log in
+// order, so that also makes the earlier renames durable.
+class AtomicWriteBatch {
+public:
+    explicit AtomicWriteBatch(FsyncPolicy policy = getDefaultFsyncPolicy()) : policy_(policy) {}
+
+    // Queues data for path; nothing touches the disk until commit()
+    void add(const std::string& path, std::string data);
+
+    // Returns false on the first failure. Targets renamed before a failed
+    // rename stay replaced; the rest keep their old contents.
+    bool commit();
+
+    size_t size() const { return pending_.size(); }
+    const std::string& lastError() const { return error_; }
+
+private:
+    struct Pending {
+        std::string path;
+        std::string data;
+    };
+
+    FsyncPolicy policy_;
+    std::vector<Pending> pending_;
+    std::string error_;
+};
\ No newline at end of file
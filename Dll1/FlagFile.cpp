@@ -1,11 +1,16 @@
 // =============================================
 // File: FlagFile.cpp
 // Category: Module Load Tracking
-// Purpose: Implements helpers for creating/clearing module loaded flag file.
+// Purpose: Implements flag file removal and the launch session file read by the setup script.
 // =============================================
 #include "FlagFile.h"
 #include "Logger.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
 #include <filesystem>
+#include <chrono>
+#include <mutex>
+#include <windows.h>
 
 namespace fs = std::filesystem;
 
@@ -16,66 +21,101 @@ std::string getFlagFilePath(const std::string& modulePath) {
     return modulePath + "/_module_loader/.modules_loaded";
 }
 
-void clearModuleLoadedFlag(const std::string& modulePath) {
+void cleanupFlagFile(const std::string& modulePath) {
     if (modulePath.empty()) {
-        log("Cannot clear flag: modulePath is empty", LOG_WARNING, "FlagFile");
+        LOG_AT(LOG_TRACE, "FlagFile", "Cannot cleanup flag: modulePath is empty");
         return;
     }
 
     std::string flagFile = getFlagFilePath(modulePath);
     if (flagFile.empty()) {
-        log("Cannot clear flag: invalid flag file path", LOG_WARNING, "FlagFile");
+        LOG_AT(LOG_TRACE, "FlagFile", "Cannot cleanup flag: invalid flag file path");
         return;
     }
 
     try {
-        if (fs::exists(flagFile)) {
+        if (pfs::exists(flagFile)) {
             fs::remove(flagFile);
-            log("Cleared module loaded flag for fresh reload", LOG_DEBUG, "FlagFile");
+            LOG_AT(LOG_DEBUG, "FlagFile", "Cleanup: Removed flag file on process exit");
         }
         else {
-            log("Flag file does not exist, nothing to clear", LOG_TRACE, "FlagFile");
+            LOG_AT(LOG_TRACE, "FlagFile", "Cleanup: Flag file does not exist");
         }
     }
     catch (const std::filesystem::filesystem_error& e) {
-        log("Filesystem error removing flag file: " + std::string(e.what()), LOG_WARNING, "FlagFile");
+        LOG_AT(LOG_TRACE, "FlagFile", "Cleanup filesystem error: ", e.what());
     }
     catch (const std::exception& e) {
-        log("Error removing flag file: " + std::string(e.what()), LOG_WARNING, "FlagFile");
+        LOG_AT(LOG_TRACE, "FlagFile", "Cleanup error: ", e.what());
     }
     catch (...) {
-        log("Unknown error removing flag file", LOG_WARNING, "FlagFile");
+        LOG_AT(LOG_TRACE, "FlagFile", "Cleanup unknown error");
     }
 }
 
-void cleanupFlagFile(const std::string& modulePath) {
-    if (modulePath.empty()) {
-        log("Cannot cleanup flag: modulePath is empty", LOG_TRACE, "FlagFile");
-        return;
+std::string getSessionFilePath(const std::string& dllPath) {
+    if (dllPath.empty()) {
+        return "";
     }
+    return fs::path(dllPath).replace_extension(".session").string();
+}
 
-    std::string flagFile = getFlagFilePath(modulePath);
-    if (flagFile.empty()) {
-        log("Cannot cleanup flag: invalid flag file path", LOG_TRACE, "FlagFile");
-        return;
-    }
+namespace {
+    std::mutex g_sessionMutex;
+    std::string g_sessionFile;
+    std::string g_sessionToken;
 
-    try {
-        if (fs::exists(flagFile)) {
-            fs::remove(flagFile);
-            log("Cleanup: Removed flag file on process exit", LOG_DEBUG, "FlagFile");
+    bool writeSession(const std::string& sessionFile, const std::string& token, const char* state) {
+        std::string content = "PID:" + std::to_string(GetCurrentProcessId()) + "\n" +
+            "SESSION:" + token + "\n" +
+            "STATE:" + std::string(state) + "\n";
+
+        try {
+            // The setup script polls this file; rename so it never reads half a state.
+            // It is rewritten every launch, so skip the flush.
+            std::string error;
+            if (!writeFileAtomic(sessionFile, content, FsyncPolicy::Never, error)) {
+                log("Failed to write session file " + sessionFile + ": " + error, LOG_WARNING, "FlagFile");
+                return false;
+            }
+            LOG_AT(LOG_DEBUG, "FlagFile", "Session file written (state: ", state, ")");
+            return true;
         }
-        else {
-            log("Cleanup: Flag file does not exist", LOG_TRACE, "FlagFile");
+        catch (const std::exception& e) {
+            log("Error writing session file: " + std::string(e.what()), LOG_WARNING, "FlagFile");
+            return false;
         }
     }
-    catch (const std::filesystem::filesystem_error& e) {
-        log("Cleanup filesystem error: " + std::string(e.what()), LOG_TRACE, "FlagFile");
-    }
-    catch (const std::exception& e) {
-        log("Cleanup error: " + std::string(e.what()), LOG_TRACE, "FlagFile");
+}
+
+bool beginSession(const std::string& dllPath) {
+    std::string sessionFile = getSessionFilePath(dllPath);
+    if (sessionFile.empty()) {
+        log("Cannot start session: DLL path is empty", LOG_WARNING, "FlagFile");
+        return false;
     }
-    catch (...) {
-        log("Cleanup unknown error", LOG_TRACE, "FlagFile");
+
+    // PID alone is not enough: Windows reuses process IDs
+    auto startMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string token = std::to_string(GetCurrentProcessId()) + "-" + std::to_string(startMs);
+
+    std::lock_guard<std::mutex> lock(g_sessionMutex);
+    g_sessionFile = sessionFile;
+    g_sessionToken = token;
+    return writeSession(g_sessionFile, g_sessionToken, SESSION_STATE_INITIALIZING);
+}
+
+bool updateSessionState(const char* state) {
+    std::lock_guard<std::mutex> lock(g_sessionMutex);
+    if (g_sessionFile.empty()) {
+        log("Cannot update session: no session was started", LOG_WARNING, "FlagFile");
+        return false;
     }
-}
\ No newline at end of file
+    return writeSession(g_sessionFile, g_sessionToken, state);
+}
+
+std::string getSessionToken() {
+    std::lock_guard<std::mutex> lock(g_sessionMutex);
+    return g_sessionToken;
+}
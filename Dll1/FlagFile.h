@@ -1,11 +1,32 @@
 // =============================================
 // File: FlagFile.h
 // Category: Module Load Tracking
-// Purpose: Declares helpers for flag file creation/removal (.modules_loaded).
+// Purpose: Declares helpers for flag file removal (.modules_loaded) and the launch session file.
 // =============================================
 #pragma once
 #include <string>
 
 std::string getFlagFilePath(const std::string& modulePath);
-void clearModuleLoadedFlag(const std::string& modulePath);
-void cleanupFlagFile(const std::string& modulePath);
\ No newline at end of file
+void cleanupFlagFile(const std::string& modulePath);
+
+// Session states seen by the generated Lua script
+constexpr const char* SESSION_STATE_INITIALIZING = "initializing";
+constexpr const char* SESSION_STATE_READY = "ready";
+constexpr const char* SESSION_STATE_FAILED = "failed";
+
+// "<dll>.session" next to the loader DLL, like the .discovery cache: known at
+// attach, before the config (and with it the module path) has been read
+std::string getSessionFilePath(const std::string& dllPath);
+
+// Starts this launch's session from DLL_PROCESS_ATTACH. Writes the process ID,
+// a token unique to this launch ("<pid>-<start ms>") and STATE:initializing,
+// replacing the previous launch's file before any setup script can read it.
+// The script waits while the state is initializing and tags the flag file
+// with the token, so a flag left by an earlier launch never matches.
+bool beginSession(const std::string& dllPath);
+
+// Rewrites the session begun at attach with a new state
+bool updateSessionState(const char* state);
+
+// This launch's token ("" before beginSession)
+std::string getSessionToken();
@@ -1,20 +1,48 @@
 ﻿// =============================================
 // File: HksInjector.cpp
 // Category: HKS Script Integration
-// Purpose: Implements injection of Lua loader into the target .hks file.
+// Purpose: Implements injection of Lua loader into the target .hks files.
 // =============================================
 #include "HksInjector.h"
 #include "PathUtils.h"
 #include "Logger.h"
 #include "ConfigParser.h"  // For validateHKSForBackup function
 #include "ErrorMessages.h"  // For clean error formatting
+#include "StartupProfiler.h"
+#include "MultiPatternMatcher.h"
+#include "FileIO.h"
+#include "BackupStore.h"
+#include "WorkerPool.h"
+#include "InjectionState.h"
+#include "BackgroundIO.h"
+#include "ContentHash.h"
+#include "ConfigWatcher.h"
 #include <filesystem>
-#include <fstream>
-#include <ctime>
-#include <sstream>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <cctype>
 
 namespace fs = std::filesystem;
 
+// Shared with Cleanup, which restores from and verifies the same store
+std::string resolveHksBackupDir(const std::string& hksPath, const LoaderConfig& config) {
+    std::string backupDir;
+    if (config.backupHKSFolder.empty()) {
+        // Use same directory as the original file
+        backupDir = fs::path(hksPath).parent_path().string();
+    }
+    else if (!config.backupDir.empty()) {
+        // Configured backup folder, resolved when the config was loaded
+        backupDir = config.backupDir;
+    }
+    else {
+        // Use configured backup folder (resolve relative to config directory)
+        backupDir = resolvePathWithFallbacks(config.backupHKSFolder, config.configDir);
+    }
+    return normalizePath(backupDir);
+}
+
 // Universal HKS backup function with context support and validation
 bool createHksBackup(const std::string& hksPath, const LoaderConfig& config, const std::string& context) {
     // Validate HKS file before attempting backup
@@ -23,152 +51,240 @@ bool createHksBackup(const std::string& hksPath, const LoaderConfig& config, con
         return false;
     }
 
-    // Generate backup filename with consistent date format
-    auto now = std::time(nullptr);
-    std::tm tm;
-    localtime_s(&tm, &now);
-
-    char dateStr[32];
-    std::strftime(dateStr, sizeof(dateStr), "%Y-%m-%d_%H-%M-%S", &tm);
-
-    std::ostringstream backupName;
-    backupName << fs::path(hksPath).filename().string() << ".backup_" << dateStr;
+    // Content-addressed: an unchanged HKS only adds a catalog entry
+    std::string backupDir = resolveHksBackupDir(hksPath, config);
+    BackupResult result;
+    if (!storeBackup(hksPath, backupDir, context, config.backupDeltas, BackupRetention(), result)) {
+        return false;
+    }
 
-    // Add context for why backup was created
-    if (!context.empty()) {
-        backupName << "_" << context;
+    // Retention only frees space, so it runs on the background lane (once per folder)
+    BackupRetention retention;
+    retention.keepCount = config.backupKeepCount;
+    retention.maxBytes = static_cast<unsigned long long>(config.backupMaxSizeMB) * 1024 * 1024;
+    if (retention.keepCount > 0 || retention.maxBytes > 0) {
+        submitBackgroundJob("prune " + backupDir, [backupDir, retention]() {
+            size_t pruned = pruneBackups(backupDir, retention);
+            if (pruned > 0) {
+                log("Backup retention removed " + std::to_string(pruned) + " old backup(s)", LOG_INFO, "HksInjector");
+            }
+            return true;
+        });
     }
 
-    // Determine backup directory using same logic as existing system
-    std::string backupDir;
-    if (config.backupHKSFolder.empty()) {
-        // Use same directory as the original file
-        backupDir = fs::path(hksPath).parent_path().string();
+    if (result.deduplicated) {
+        log("Backup unchanged since last copy, recorded in catalog: " + result.blobPath, LOG_INFO, "HksInjector");
+    }
+    else if (result.delta) {
+        log("Backup created as " + std::to_string(result.storedBytes) + "-byte delta: " + result.blobPath, LOG_INFO, "HksInjector");
     }
     else {
-        // Use configured backup folder (resolve relative to config directory)
-        backupDir = resolvePathWithFallbacks(config.backupHKSFolder, config.configDir);
+        log("Backup created: " + (result.linkPath.empty() ? result.blobPath : result.linkPath), LOG_INFO, "HksInjector");
     }
+    return true;
+}
 
-    // Ensure backup directory exists
-    try {
-        fs::create_directories(backupDir);
-    }
-    catch (const std::exception& e) {
-        log("Failed to create backup directory: " + std::string(e.what()), LOG_ERROR, "HksInjector");
-        return false;
-    }
+namespace {
+    // Signatures in reporting priority order. The exact current injection
+    // line depends on the config, so it is verified at each "dofile('" hit
+    // (every injection line starts with it) rather than compiled in.
+    enum Signature : size_t {
+        SIG_MODULE_LOADER_SETUP,
+        SIG_LEGACY_HEADER,
+        SIG_DOFILE_SINGLE,
+        SIG_DOFILE_DOUBLE,
+        SIG_MODULE_LOADER_DIR,
+        SIG_COUNT
+    };
 
-    std::string backupPath = normalizePath(backupDir + "/" + backupName.str());
+    const char* SIGNATURE_DESCRIPTIONS[SIG_COUNT] = {
+        "module loader reference",
+        "legacy header signature",
+        "legacy dofile single quotes",
+        "legacy dofile double quotes",
+        "legacy module loader reference"
+    };
 
-    try {
-        fs::copy_file(hksPath, backupPath, fs::copy_options::overwrite_existing);
-        log("Backup created: " + backupPath, LOG_INFO, "HksInjector");
-        return true;
+    // The injected header and dofile line sit at the top of the file
+    constexpr size_t HEADER_SCAN_BYTES = 8 * 1024;
+
+    const MultiPatternMatcher& getSignatureMatcher() {
+        static const MultiPatternMatcher matcher({
+            "module_loader_setup.lua",
+            "-- Lua Loader by Malice",
+            "dofile('",
+            "dofile(\"",
+            "_module_loader"
+        });
+        return matcher;
     }
-    catch (const std::exception& e) {
-        log("Backup creation failed: " + std::string(e.what()), LOG_ERROR, "HksInjector");
-        return false;
+
+    // Index of the first match that is the exact injection line, or npos
+    size_t findExactInjection(std::string_view fileContent, const std::string& injectionLine, const std::vector<PatternMatch>& matches) {
+        for (size_t i = 0; i < matches.size(); ++i) {
+            if (matches[i].pattern == SIG_DOFILE_SINGLE &&
+                fileContent.compare(matches[i].offset, injectionLine.size(), injectionLine) == 0) {
+                return i;
+            }
+        }
+        return std::string::npos;
     }
 }
 
-// Enhanced injection detection - returns detailed info about what was found
-struct InjectionStatus {
-    bool isInjected;
-    std::string matchedPattern;
-    std::string matchType;
-};
+InjectionStatus checkInjectionStatus(std::string_view fileContent, const std::string& injectionLine) {
+    const MultiPatternMatcher& matcher = getSignatureMatcher();
+    InjectionStatus status{ false, "", "", {}, std::string::npos };
+
+    // Single pass over the header region; a current injection there settles it
+    std::string_view content = fileContent;
+    MultiPatternMatcher::Cursor cursor;
+    size_t headerBytes = std::min(content.size(), HEADER_SCAN_BYTES);
+    matcher.scan(content.substr(0, headerBytes), cursor, status.matches);
+
+    size_t exact = findExactInjection(fileContent, injectionLine, status.matches);
+    if (exact == std::string::npos && headerBytes < content.size()) {
+        // Continue the same pass over the remainder to collect every signature
+        matcher.scan(content.substr(headerBytes), cursor, status.matches);
+        exact = findExactInjection(fileContent, injectionLine, status.matches);
+    }
 
-InjectionStatus checkInjectionStatus(const std::string& fileContent, const std::string& injectionLine) {
     // Check for exact injection line (current version)
-    if (fileContent.find(injectionLine) != std::string::npos) {
-        return { true, injectionLine, "exact current injection" };
+    if (exact != std::string::npos) {
+        status.isInjected = true;
+        status.injectionOffset = status.matches[exact].offset;
+        status.matchedPattern = injectionLine;
+        status.matchType = "exact current injection";
+        return status;
     }
 
-    // Check for any reference to module_loader_setup.lua (any version/format)
-    if (fileContent.find("module_loader_setup.lua") != std::string::npos) {
-        return { true, "module_loader_setup.lua", "module loader reference" };
+    // Otherwise report the highest-priority signature found (module loader
+    // reference first, then the patterns left by previous versions)
+    size_t best = SIG_COUNT;
+    for (const PatternMatch& match : status.matches) {
+        best = std::min(best, match.pattern);
     }
+    if (best != SIG_COUNT) {
+        status.isInjected = true;
+        status.matchedPattern = matcher.pattern(best);
+        status.matchType = SIGNATURE_DESCRIPTIONS[best];
+    }
+    return status;
+}
 
-    // Check for other common injection patterns from previous versions
-    std::vector<std::pair<std::string, std::string>> legacyPatterns = {
-        {"-- Lua Loader by Malice", "legacy header signature"},
-        {"dofile('", "legacy dofile single quotes"},
-        {"dofile(\"", "legacy dofile double quotes"},
-        {"_module_loader", "legacy module loader reference"}
-    };
+// Queues the backupHKSonLaunch copy of a target that is not about to change
+static void queueLaunchBackup(const LoaderConfig& config, const std::string& hksPath) {
+    // Only backup if backupHKSonLaunch is true (always backup mode). The file
+    // is not about to change, so the copy is taken on the background lane
+    // once startup is done. Uses validation to prevent empty backups
+    if (!config.backupHKSonLaunch) {
+        return;
+    }
 
-    for (const auto& [pattern, description] : legacyPatterns) {
-        if (fileContent.find(pattern) != std::string::npos) {
-            return { true, pattern, description };
+    bool queued = submitBackgroundJob("backup " + hksPath, [config, hksPath]() {
+        // The TOML may have been reloaded while the job waited
+        std::shared_ptr<const LoaderConfig> active = getActiveConfig();
+        const LoaderConfig& current = active ? *active : config;
+        if (!current.backupHKSonLaunch) {
+            LOG_AT(LOG_DEBUG, "HksInjector", "Launch backup dropped - backupHKSonLaunch turned off");
+            return true;
         }
+        return createHksBackup(hksPath, current, "launch");
+    });
+    if (queued) {
+        LOG_AT(LOG_DEBUG, "HksInjector", "Launch backup queued");
+    }
+    else {
+        LOG_AT(LOG_DEBUG, "HksInjector", "Launch backup skipped - background queue unavailable");
     }
+}
 
-    return { false, "", "" };
+// Launch backup and log lines for a target that needs no changes
+static void finishAlreadyIntegrated(const LoaderConfig& config, const std::string& hksPath) {
+    queueLaunchBackup(config, hksPath);
+    log("Injection operation completed - no changes needed for " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
 }
 
-void injectIntoHksFile(const LoaderConfig& config) {
-    // FIXED: Handle empty gameScriptPath with proper error message instead of silent return
-    if (config.gameScriptPath.absolutePath.empty()) {
-        log(ErrorMessages::formatEmptyGameScriptPathError(config.configFile), LOG_BRAND);
+void queueLaunchBackups(const LoaderConfig& config) {
+    if (!config.backupHKSonLaunch) {
         return;
     }
-
-    std::string hksPath = config.gameScriptPath.absolutePath + "/c0000.hks";
-
-    // Check if HKS file exists and is accessible
-    try {
-        if (!fs::exists(hksPath) || !fs::is_regular_file(hksPath)) {
-            log(ErrorMessages::formatHksNotFoundError(hksPath, config), LOG_BRAND);
-            return;
+    for (const auto& hksPath : resolveHksTargets(config)) {
+        // A missing target already failed validation; nothing to copy
+        std::error_code ec;
+        StartupProfiler::count(StartupProfiler::FS_STAT);
+        if (fs::is_regular_file(hksPath, ec)) {
+            queueLaunchBackup(config, hksPath);
         }
     }
-    catch (const std::exception& e) {
-        log(ErrorMessages::formatHksAccessError(hksPath, e.what()), LOG_BRAND);
-        return;
+}
+
+// Fills outState from the file as it is now; content may be passed when already mapped
+static bool captureInjectionState(const std::string& hksPath, std::string_view content, bool haveContent,
+    std::uintmax_t injectStart, std::uintmax_t injectEnd, const std::string& lineHash, InjectionState& outState) {
+    InjectionState state;
+    if (!statInjectionTarget(hksPath, state.size, state.mtime)) {
+        return false;
     }
-    catch (...) {
-        log(ErrorMessages::formatHksSystemError(hksPath), LOG_BRAND);
-        return;
+    ContentHash hash;
+    if (haveContent) {
+        hash = hashBuffer(content.data(), content.size());
     }
+    else if (!hashFile(hksPath, hash)) {
+        return false;
+    }
+    state.hash = toHexString(hash);
+    state.injectStart = injectStart;
+    state.injectEnd = injectEnd;
+    state.lineHash = lineHash;
+    outState = state;
+    return true;
+}
 
-    // FIXED: Enhanced file reading with proper error handling
-    std::string fileContent;
+// One target: detection, backup and atomic write, independent of every other target.
+// known is the sidecar entry from the last launch (or null); outState receives the
+// entry to keep, and outHasState says whether there is one.
+static bool injectIntoHksTarget(const LoaderConfig& config, const std::string& hksPath, const InjectionState* known,
+    HksTargetResult& result, InjectionState& outState, bool& outHasState) {
+    // Check if HKS file exists and is accessible
     try {
-        std::ifstream hksRead(hksPath, std::ios::binary);
-        if (!hksRead.is_open()) {
-            log(ErrorMessages::formatHksReadError(hksPath), LOG_BRAND);
-            return;
-        }
-
-        // Read file content with proper error checking
-        hksRead.seekg(0, std::ios::end);
-        size_t fileSize = hksRead.tellg();
-        hksRead.seekg(0, std::ios::beg);
-
-        fileContent.reserve(fileSize);
-        fileContent.assign((std::istreambuf_iterator<char>(hksRead)), std::istreambuf_iterator<char>());
-
-        if (hksRead.bad()) {
-            log(ErrorMessages::formatHksReadError(hksPath), LOG_BRAND);
-            return;
+        if (!pfs::exists(hksPath) || !pfs::is_regular_file(hksPath)) {
+            log(ErrorMessages::formatHksNotFoundError(hksPath, config), LOG_BRAND);
+            return false;
         }
-
-        hksRead.close();
-        log("Successfully read HKS file (" + std::to_string(fileSize) + " bytes)", LOG_DEBUG, "HksInjector");
     }
     catch (const std::exception& e) {
-        log(ErrorMessages::formatHksAccessError(hksPath, "Read error: " + std::string(e.what())), LOG_BRAND);
-        return;
+        log(ErrorMessages::formatHksAccessError(hksPath, e.what()), LOG_BRAND);
+        return false;
     }
     catch (...) {
         log(ErrorMessages::formatHksSystemError(hksPath), LOG_BRAND);
-        return;
+        return false;
     }
 
     // Create injection line using absolute path (required for dofile)
     std::string setupScriptPath = config.modulePath.absolutePath + "/_module_loader/module_loader_setup.lua";
     std::string injectionLine = "dofile('" + setupScriptPath + "')";
+    std::string lineHash = hashInjectionLine(injectionLine);
+
+    // Unchanged since the last launch saw the current injection in it: no need to read it
+    if (known && injectionStateMatches(*known, hksPath, lineHash)) {
+        outState = *known;
+        outHasState = true;
+        result.alreadyPresent = true;
+        log("Already integrated with game script: " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
+        LOG_AT(LOG_DEBUG, "HksInjector", "Size and mtime match the injection state; file not read");
+        finishAlreadyIntegrated(config, hksPath);
+        return true;
+    }
+
+    // Map the file read-only; detection and injection work on the view without copying it
+    MappedFile hksMap;
+    if (!hksMap.open(hksPath)) {
+        log(ErrorMessages::formatHksReadError(hksPath), LOG_BRAND);
+        return false;
+    }
+    std::string_view fileContent = hksMap.view();
+    LOG_AT(LOG_DEBUG, "HksInjector", "Successfully read HKS file (", fileContent.size(), " bytes)");
 
     // IMPROVED: Enhanced injection detection with detailed diagnostics
     // WHY USE OR LOGIC: This checks for multiple injection patterns to prevent duplicates:
@@ -178,28 +294,28 @@ void injectIntoHksFile(const LoaderConfig& config) {
     // This is GOOD PRACTICE because it's defensive programming - better to skip than duplicate
     InjectionStatus injectionStatus = checkInjectionStatus(fileContent, injectionLine);
     if (injectionStatus.isInjected) {
-        log("Already integrated with game script", LOG_INFO, "HksInjector");
-        log("Found: " + injectionStatus.matchedPattern + " (" + injectionStatus.matchType + ")", LOG_DEBUG, "HksInjector");
-
-        // Only backup if backupHKSonLaunch is true (always backup mode)
-        // Uses validation to prevent empty backups
-        if (config.backupHKSonLaunch) {
-            if (createHksBackup(hksPath, config, "launch")) {
-                log("Launch backup completed successfully", LOG_DEBUG, "HksInjector");
-            }
-            else {
-                log("Launch backup skipped or failed", LOG_DEBUG, "HksInjector");
-            }
+        result.alreadyPresent = true;
+        log("Already integrated with game script: " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
+        LOG_AT(LOG_DEBUG, "HksInjector", "Found: ", injectionStatus.matchedPattern, " (", injectionStatus.matchType, ")");
+        for (const PatternMatch& match : injectionStatus.matches) {
+            LOG_AT(LOG_TRACE, "HksInjector", "Signature at byte ", match.offset, ": ", getSignatureMatcher().pattern(match.pattern));
         }
 
-        log("Injection operation completed - no changes needed for " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
-        return;
+        // Only the current injection is remembered; legacy signatures are rechecked each launch
+        if (injectionStatus.injectionOffset != std::string::npos) {
+            outHasState = captureInjectionState(hksPath, fileContent, true, injectionStatus.injectionOffset,
+                injectionStatus.injectionOffset + injectionLine.size(), lineHash, outState);
+        }
+        hksMap.close();
+
+        finishAlreadyIntegrated(config, hksPath);
+        return true;
     }
 
     // We're going to inject - backup regardless of setting since we're modifying the file
     // But still validate to ensure we don't backup empty files
     if (createHksBackup(hksPath, config, "injection")) {
-        log("Pre-injection backup completed successfully", LOG_DEBUG, "HksInjector");
+        LOG_AT(LOG_DEBUG, "HksInjector", "Pre-injection backup completed successfully");
     }
     else {
         log("Pre-injection backup skipped or failed - proceeding with injection", LOG_WARNING, "HksInjector");
@@ -214,52 +330,173 @@ void injectIntoHksFile(const LoaderConfig& config) {
     header += "-- Module Path: " + config.modulePath.relativePath + "\n";
     header += "-- ========================================\n\n";
 
-    std::string newContent = header + injectionLine + "\n\n" + fileContent;
+    // Header, injection line and original body go to a temp file in order,
+    // which then replaces the original in one rename
+    AtomicFileWriter hksWrite(hksPath);
+    bool written = hksWrite.open() &&
+        hksWrite.write(header) &&
+        hksWrite.write(injectionLine) &&
+        hksWrite.write("\n\n") &&
+        hksWrite.write(fileContent);
 
-    // FIXED: Enhanced file writing with comprehensive exception handling
-    try {
-        std::ofstream hksWrite(hksPath, std::ios::binary);
-        if (!hksWrite.is_open()) {
-            log(ErrorMessages::formatHksWriteError(hksPath, "Unable to open file for writing"), LOG_BRAND);
-            return;
+    // The mapping has to go before the original can be replaced
+    hksMap.close();
+
+    if (!written || !hksWrite.commit()) {
+        log(ErrorMessages::formatHksWriteError(hksPath, hksWrite.lastError()), LOG_BRAND);
+        return false;
+    }
+
+    result.injected = true;
+    outHasState = captureInjectionState(hksPath, std::string_view(), false, header.size(),
+        header.size() + injectionLine.size(), lineHash, outState);
+    log("Successfully integrated with game script: " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
+    LOG_AT(LOG_DEBUG, "HksInjector", "Injection uses absolute path: ", setupScriptPath);
+    LOG_AT(LOG_DEBUG, "HksInjector", "Config uses relative paths for portability");
+    log("Injection operation completed successfully for " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
+    return true;
+}
+
+namespace {
+    bool hasWildcard(const std::string& pattern) {
+        return pattern.find_first_of("*?") != std::string::npos;
+    }
+
+    // Case-insensitive '*' / '?' match, as Windows file names compare
+    bool wildcardMatch(const char* pattern, const char* name) {
+        const char* starPattern = nullptr;
+        const char* starName = nullptr;
+        while (*name) {
+            if (*pattern == '*') {
+                starPattern = ++pattern;
+                starName = name;
+            }
+            else if (*pattern == '?' ||
+                std::tolower(static_cast<unsigned char>(*pattern)) == std::tolower(static_cast<unsigned char>(*name))) {
+                ++pattern;
+                ++name;
+            }
+            else if (starPattern) {
+                pattern = starPattern;
+                name = ++starName;
+            }
+            else {
+                return false;
+            }
         }
+        while (*pattern == '*') ++pattern;
+        return *pattern == '\0';
+    }
+}
 
-        // Write content with proper error checking
-        hksWrite << newContent;
+std::vector<std::string> resolveHksTargets(const LoaderConfig& config) {
+    std::vector<std::string> targets;
+    if (config.gameScriptPath.absolutePath.empty()) {
+        return targets;
+    }
 
-        // Explicitly check for write errors before flushing
-        if (hksWrite.bad()) {
-            hksWrite.close();
-            log(ErrorMessages::formatHksWriteError(hksPath, "Write operation failed"), LOG_BRAND);
-            return;
+    for (const auto& pattern : config.hksTargets) {
+        std::string path = normalizePath(config.gameScriptPath.absolutePath + "/" + pattern);
+        if (!hasWildcard(pattern)) {
+            // Plain names are kept even when missing, so the report can say so
+            targets.push_back(path);
+            continue;
         }
 
-        // Flush with error checking (this is sufficient for catching write errors)
-        hksWrite.flush();
-        if (hksWrite.bad()) {
-            hksWrite.close();
-            log(ErrorMessages::formatHksWriteError(hksPath, "Flush operation failed"), LOG_BRAND);
-            return;
+        // Wildcards only apply to the file name part
+        fs::path patternPath(path);
+        std::string namePattern = patternPath.filename().string();
+        std::error_code ec;
+        for (fs::directory_iterator it(patternPath.parent_path(), ec), end; !ec && it != end; it.increment(ec)) {
+            std::string name = it->path().filename().string();
+            if (wildcardMatch(namePattern.c_str(), name.c_str()) && it->is_regular_file(ec)) {
+                targets.push_back(normalizePath(it->path().string()));
+            }
         }
+        if (ec) {
+            log("Cannot list HKS targets for '" + pattern + "': " + ec.message(), LOG_WARNING, "HksInjector");
+        }
+    }
 
-        hksWrite.close();
-        // Note: .bad() check after .close() removed as .flush() is sufficient
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    return targets;
+}
+
+bool injectIntoHksFile(const LoaderConfig& config) {
+    std::vector<HksTargetResult> results;
+    return injectIntoHksFiles(config, results);
+}
 
-        log("Successfully integrated with game script", LOG_INFO, "HksInjector");
-        log("Injection uses absolute path: " + setupScriptPath, LOG_DEBUG, "HksInjector");
-        log("Config uses relative paths for portability", LOG_DEBUG, "HksInjector");
-        log("Injection operation completed successfully for " + fs::path(hksPath).filename().string(), LOG_INFO, "HksInjector");
+bool injectIntoHksFiles(const LoaderConfig& config, std::vector<HksTargetResult>& outResults) {
+    // FIXED: Handle empty gameScriptPath with proper error message instead of silent return
+    if (config.gameScriptPath.absolutePath.empty()) {
+        log(ErrorMessages::formatEmptyGameScriptPathError(config.configFile), LOG_BRAND);
+        return false;
     }
-    catch (const std::ios_base::failure& e) {
-        log(ErrorMessages::formatHksWriteError(hksPath, "I/O error: " + std::string(e.what())), LOG_BRAND);
-        return;
+
+    std::vector<std::string> targets = resolveHksTargets(config);
+    if (targets.empty()) {
+        log("No HKS files match hksTargets in " + config.gameScriptPath.absolutePath, LOG_ERROR, "HksInjector");
+        return false;
     }
-    catch (const std::exception& e) {
-        log(ErrorMessages::formatHksWriteError(hksPath, "Write error: " + std::string(e.what())), LOG_BRAND);
-        return;
+
+    // Targets the last launch saw injected are recognised by size and mtime
+    std::string statePath;
+    InjectionStateMap knownStates;
+    if (!config.modulePath.absolutePath.empty()) {
+        statePath = getInjectionStatePath(config.modulePath.absolutePath);
+        loadInjectionState(statePath, knownStates);
     }
-    catch (...) {
-        log(ErrorMessages::formatHksWriteSystemError(hksPath), LOG_BRAND);
-        return;
+
+    // Targets share nothing but the backup store, which serializes itself, so
+    // the whole step takes about as long as the slowest file
+    outResults.assign(targets.size(), HksTargetResult());
+    std::vector<InjectionState> newStates(targets.size());
+    std::vector<char> haveState(targets.size(), 0);
+    runParallel(targets.size(), getDefaultWorkerCount(), [&](size_t i) {
+        HksTargetResult& result = outResults[i];
+        result.path = targets[i];
+        auto known = knownStates.find(targets[i]);
+        bool hasState = false;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            result.integrated = injectIntoHksTarget(config, targets[i],
+                known != knownStates.end() ? &known->second : nullptr, result, newStates[i], hasState);
+            haveState[i] = hasState;
+        }
+        catch (const std::exception& e) {
+            log(ErrorMessages::formatHksAccessError(targets[i], e.what()), LOG_BRAND);
+        }
+        catch (...) {
+            log(ErrorMessages::formatHksSystemError(targets[i]), LOG_BRAND);
+        }
+        result.durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    // Rewrite the sidecar only when an entry changed or a target left the list
+    InjectionStateMap states;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (haveState[i]) states[targets[i]] = newStates[i];
+    }
+    if (!statePath.empty() && states != knownStates) {
+        saveInjectionState(statePath, states);
+    }
+
+    size_t injected = 0, present = 0, failed = 0;
+    for (const auto& result : outResults) {
+        if (!result.integrated) failed++;
+        else if (result.injected) injected++;
+        else present++;
+        LOG_AT(LOG_DEBUG, "HksInjector", fs::path(result.path).filename().string(), ": ",
+            result.integrated ? (result.injected ? "injected" : "already integrated") : "FAILED",
+            " (", static_cast<long long>(result.durationMs * 1000), " us)");
+    }
+
+    if (outResults.size() > 1 || failed > 0) {
+        log("HKS targets: " + std::to_string(outResults.size() - failed) + "/" + std::to_string(outResults.size()) +
+            " integrated (" + std::to_string(injected) + " injected, " + std::to_string(present) + " already present" +
+            (failed ? ", " + std::to_string(failed) + " failed)" : ")"), failed ? LOG_WARNING : LOG_INFO, "HksInjector");
     }
+    return failed == 0;
 }
\ No newline at end of file
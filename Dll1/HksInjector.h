@@ -1,14 +1,54 @@
 // =============================================
 // File: HksInjector.h
 // Category: HKS Script Integration
-// Purpose: Declares injection of Lua loader into the target .hks file.
+// Purpose: Declares injection of Lua loader into the target .hks files.
 // =============================================
 #pragma once
 #include "ConfigParser.h"
+#include "MultiPatternMatcher.h"
 #include <string>
+#include <string_view>
+#include <vector>
 
-// Main injection function
-void injectIntoHksFile(const LoaderConfig& config);
+// Outcome for one injection target
+struct HksTargetResult {
+    std::string path;
+    bool integrated = false;        // Injected now or already present
+    bool injected = false;          // This run modified the file
+    bool alreadyPresent = false;
+    double durationMs = 0.0;
+};
+
+// Enhanced injection detection - returns detailed info about what was found
+struct InjectionStatus {
+    bool isInjected;
+    std::string matchedPattern;
+    std::string matchType;
+    std::vector<PatternMatch> matches;   // Every signature hit, in file order
+    size_t injectionOffset;              // Start of the exact injection line, or npos
+};
+
+// Looks for injectionLine and the signatures older versions left in one pass,
+// scanning the header region first and the rest only if the line is not there
+InjectionStatus checkInjectionStatus(std::string_view fileContent, const std::string& injectionLine);
+
+// Expands config.hksTargets against gameScriptPath (sorted, no duplicates).
+// Plain names are returned even if the file does not exist.
+std::vector<std::string> resolveHksTargets(const LoaderConfig& config);
+
+// Main injection function: every target is processed concurrently.
+// Returns true when all targets are integrated (newly injected or already present)
+bool injectIntoHksFile(const LoaderConfig& config);
+bool injectIntoHksFiles(const LoaderConfig& config, std::vector<HksTargetResult>& outResults);
+
+// Queues the backupHKSonLaunch copy of every target on the background lane.
+// injectIntoHksFiles does this itself; the startup fast path, which skips
+// injection because nothing changed, calls it instead.
+void queueLaunchBackups(const LoaderConfig& config);
+
+// Backup store folder for an HKS target: backupHKSFolder as resolved at load,
+// or the target's own folder when none is configured
+std::string resolveHksBackupDir(const std::string& hksPath, const LoaderConfig& config);
 
 // Universal HKS backup function with context support
 bool createHksBackup(const std::string& hksPath, const LoaderConfig& config, const std::string& context);
\ No newline at end of file
@@ -0,0 +1,82 @@
+// =============================================
+// File: InitWorker.cpp
+// Category: Main Loader Orchestration
+// Purpose: Runs loader initialization off the loader lock with a portable wait barrier.
+// =============================================
+#include "InitWorker.h"
+#include "Logger.h"
+#include "ModuleThread.h"
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+namespace {
+    std::mutex g_stateMutex;
+    std::condition_variable g_stateChanged;
+    InitState g_state = InitState::NotStarted;
+    double g_durationMs = 0.0;
+
+    void finish(InitState finalState, double durationMs) {
+        {
+            std::lock_guard<std::mutex> lock(g_stateMutex);
+            g_state = finalState;
+            g_durationMs = durationMs;
+        }
+        g_stateChanged.notify_all();
+    }
+}
+
+bool startInitializationWorker(std::function<bool()> routine) {
+    {
+        std::lock_guard<std::mutex> lock(g_stateMutex);
+        if (g_state != InitState::NotStarted) {
+            return false;
+        }
+        g_state = InitState::Running;
+    }
+
+    // The thread only starts running once the OS loader lock is released. It
+    // holds a reference on the module until it exits, so an unload during
+    // startup waits for it instead of unmapping the code it runs, and
+    // DLL_PROCESS_DETACH never has to join it.
+    bool started = startModuleThread([routine]() {
+        auto start = std::chrono::steady_clock::now();
+        bool succeeded = false;
+        try {
+            succeeded = routine();
+        }
+        catch (const std::exception& e) {
+            log("Initialization worker failed: " + std::string(e.what()), LOG_ERROR, "InitWorker");
+        }
+        catch (...) {
+            log("Initialization worker failed: unknown error", LOG_ERROR, "InitWorker");
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        finish(succeeded ? InitState::Succeeded : InitState::Failed, elapsed.count());
+        LOG_AT(LOG_DEBUG, "InitWorker", "Initialization worker finished in ", static_cast<long long>(elapsed.count()), " ms");
+    });
+    if (!started) {
+        log("Cannot start initialization worker", LOG_ERROR, "InitWorker");
+        finish(InitState::Failed, 0.0);
+        return false;
+    }
+
+    return true;
+}
+
+InitState waitForInitialization(unsigned int timeoutMs) {
+    std::unique_lock<std::mutex> lock(g_stateMutex);
+    g_stateChanged.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+        []() { return g_state != InitState::Running; });
+    return g_state;
+}
+
+InitState getInitializationState() {
+    std::lock_guard<std::mutex> lock(g_stateMutex);
+    return g_state;
+}
+
+double getInitializationDurationMs() {
+    std::lock_guard<std::mutex> lock(g_stateMutex);
+    return g_durationMs;
+}
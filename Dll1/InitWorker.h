@@ -0,0 +1,29 @@
+// =============================================
+// File: InitWorker.h
+// Category: Main Loader Orchestration
+// Purpose: Declares the deferred initialization worker and its wait barrier.
+// =============================================
+#pragma once
+#include <functional>
+
+enum class InitState {
+    NotStarted,
+    Running,
+    Succeeded,
+    Failed
+};
+
+// Starts the initialization routine on a background thread and returns immediately.
+// Safe to call from DllMain: nothing here waits on the new thread. The thread
+// holds a reference on the DLL until it exits (startModuleThread), so it is
+// never unloaded mid-run.
+bool startInitializationWorker(std::function<bool()> routine);
+
+// Blocks until the worker finishes or the timeout elapses; returns the state at that point
+InitState waitForInitialization(unsigned int timeoutMs);
+
+// Current state without blocking
+InitState getInitializationState();
+
+// Wall-clock duration of the worker routine in milliseconds (0 until it finishes)
+double getInitializationDurationMs();
@@ -0,0 +1,104 @@
+// =============================================
+// File: InjectionState.cpp
+// Category: HKS Script Integration
+// Purpose: Implements the injection state sidecar kept in _module_loader.
+// =============================================
+#include "InjectionState.h"
+#include "ContentHash.h"
+#include "Logger.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
+#include <fstream>
+#include <sstream>
+
+namespace {
+    const char* STATE_HEADER = "LuaLoaderInjectionState 1";
+
+    // A 32-character hex hash, as written by toHexString
+    bool isHexHash(const std::string& text) {
+        ContentHash parsed;
+        return text.size() == 32 && parseHexString(text, parsed);
+    }
+}
+
+std::string getInjectionStatePath(const std::string& modulePath) {
+    return modulePath + "/_module_loader/injection_state.txt";
+}
+
+// Format: header line, then "path<TAB>size mtime hash start end lineHash" per target
+bool loadInjectionState(const std::string& statePath, InjectionStateMap& outStates) {
+    outStates.clear();
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    std::ifstream in(statePath);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != STATE_HEADER) {
+        log("Ignoring unreadable injection state: " + statePath, LOG_WARNING, "InjectionState");
+        return false;
+    }
+
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string path;
+        InjectionState state;
+        // One bad entry means the file was not written by us; trust none of it
+        if (!std::getline(fields, path, '\t') || path.empty() ||
+            !(fields >> state.size >> state.mtime >> state.hash >> state.injectStart >> state.injectEnd >> state.lineHash) ||
+            !isHexHash(state.hash) || !isHexHash(state.lineHash) ||
+            state.injectStart >= state.injectEnd || state.injectEnd > state.size) {
+            log("Ignoring corrupt injection state: " + statePath, LOG_WARNING, "InjectionState");
+            outStates.clear();
+            return false;
+        }
+        outStates[path] = state;
+    }
+    return true;
+}
+
+bool saveInjectionState(const std::string& statePath, const InjectionStateMap& states) {
+    std::ostringstream out;
+    out << STATE_HEADER << '\n';
+    for (const auto& [path, state] : states) {
+        out << path << '\t' << state.size << ' ' << state.mtime << ' ' << state.hash << ' '
+            << state.injectStart << ' ' << state.injectEnd << ' ' << state.lineHash << '\n';
+    }
+
+    // Only a hint; a lost update means one full read of each target next launch
+    std::string error;
+    if (!writeFileAtomic(statePath, out.str(), FsyncPolicy::Never, error)) {
+        log("Cannot write injection state: " + statePath + " (" + error + ")", LOG_WARNING, "InjectionState");
+        return false;
+    }
+    LOG_AT(LOG_DEBUG, "InjectionState", "Injection state recorded for ", states.size(), " target(s)");
+    return true;
+}
+
+std::string hashInjectionLine(const std::string& injectionLine) {
+    return toHexString(hashBuffer(injectionLine.data(), injectionLine.size()));
+}
+
+bool statInjectionTarget(const std::string& path, std::uintmax_t& outSize, long long& outMtime) {
+    std::error_code ec;
+    outSize = pfs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto writeTime = pfs::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    outMtime = static_cast<long long>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+bool injectionStateMatches(const InjectionState& state, const std::string& path, const std::string& lineHash) {
+    if (state.lineHash != lineHash) {
+        return false;
+    }
+    std::uintmax_t size = 0;
+    long long mtime = 0;
+    return statInjectionTarget(path, size, mtime) && size == state.size && mtime == state.mtime;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+// =============================================
+// File: InjectionState.h
+// Category: HKS Script Integration
+// Purpose: Declares the sidecar that lets already injected HKS files be recognised by stat alone.
+// =============================================
+#pragma once
+#include <string>
+#include <map>
+#include <cstdint>
+
+// What the injector saw the last time a target held the current injection
+struct InjectionState {
+    std::uintmax_t size = 0;
+    long long mtime = 0;
+    std::string hash;               // Content hash of the whole file
+    std::uintmax_t injectStart = 0; // Byte range of the injection line
+    std::uintmax_t injectEnd = 0;
+    std::string lineHash;           // Hash of the injection line it was checked against
+
+    bool operator==(const InjectionState& other) const {
+        return size == other.size && mtime == other.mtime && hash == other.hash &&
+            injectStart == other.injectStart && injectEnd == other.injectEnd && lineHash == other.lineHash;
+    }
+    bool operator!=(const InjectionState& other) const { return !(*this == other); }
+};
+
+// Keyed by normalized target path
+using InjectionStateMap = std::map<std::string, InjectionState>;
+
+// Path of the sidecar (<modulePath>/_module_loader/injection_state.txt)
+std::string getInjectionStatePath(const std::string& modulePath);
+
+// Returns false (and an empty map) when the sidecar is missing or malformed
+bool loadInjectionState(const std::string& statePath, InjectionStateMap& outStates);
+bool saveInjectionState(const std::string& statePath, const InjectionStateMap& states);
+
+// Hash of an injection line in the form stored in InjectionState::lineHash
+std::string hashInjectionLine(const std::string& injectionLine);
+
+// Stats the file; false if it cannot be stat'ed
+bool statInjectionTarget(const std::string& path, std::uintmax_t& outSize, long long& outMtime);
+
+// True when the file's size and mtime match the recorded state and the state
+// was taken against the same injection line, so the file needs no reading
+bool injectionStateMatches(const InjectionState& state, const std::string& path, const std::string& lineHash);
\ No newline at end of file
@@ -8,14 +8,18 @@
 #include <cstdio>
 #include <ctime>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include <windows.h>
 #include <string>
 #include <algorithm>
 
-// Global logging state
-static LogLevel g_minLogLevel = LOG_INFO;
-static bool g_silentMode = false;
-static std::mutex g_logMutex;
+// Global logging state; read on every log call from any thread, and changed
+// by a config reload while the game runs
+static std::atomic<LogLevel> g_minLogLevel{ LOG_INFO };
+static std::atomic<bool> g_silentMode{ false };
 
 // Log level name mapping
 static const char* levelNames[] = {
@@ -32,31 +36,241 @@ static const char* getSafeLevelName(LogLevel level) {
     return "UNKNOWN";
 }
 
-// Helper function to generate timestamp string
-static std::string getTimeString() {
-    char timeBuffer[16] = {};
+// Helper function to generate timestamp string, reformatted once per second per thread
+static const char* getTimeString() {
+    thread_local std::time_t cachedSecond = -1;
+    thread_local char timeBuffer[16] = {};
+
     std::time_t currentTime = std::time(nullptr);
-    std::tm timeStruct;
+    if (currentTime != cachedSecond) {
+        std::tm timeStruct;
+        timeBuffer[0] = '\0';
+        if (localtime_s(&timeStruct, &currentTime) == 0) {
+            std::strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", &timeStruct);
+        }
+        cachedSecond = currentTime;
+    }
+
+    return timeBuffer;
+}
+
+namespace {
+    constexpr size_t LOG_RING_SLOTS = 4096;         // Must be a power of two
+    constexpr size_t LOG_BATCH_BYTES = 64 * 1024;   // Largest single write to the console
+    constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(20);
+    constexpr auto SHUTDOWN_ACK_WAIT = std::chrono::milliseconds(500);
+
+    static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+    struct LogSlot {
+        std::atomic<size_t> sequence{ 0 };
+        std::string line;   // Keeps its capacity across reuse
+    };
+
+    // Bounded multi-producer ring (Vyukov). Each slot's sequence number says
+    // whether it is free for the producer at that position or ready for the
+    // consumer, so producers only contend on the enqueue cursor.
+    class LogRing {
+    public:
+        LogRing() {
+            for (size_t i = 0; i < LOG_RING_SLOTS; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // False when the ring is full
+        bool tryPush(const std::string& line) {
+            size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+            for (;;) {
+                LogSlot& slot = slots_[pos & (LOG_RING_SLOTS - 1)];
+                size_t seq = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+                if (diff == 0) {
+                    if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        slot.line.assign(line);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Appends the oldest published line to the batch; false when nothing is ready
+        bool popInto(std::string& batch) {
+            size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+            for (;;) {
+                LogSlot& slot = slots_[pos & (LOG_RING_SLOTS - 1)];
+                size_t seq = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+                if (diff == 0) {
+                    if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        batch.append(slot.line);
+                        slot.sequence.store(pos + LOG_RING_SLOTS, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = dequeuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+        LogSlot slots_[LOG_RING_SLOTS];
+        alignas(64) std::atomic<size_t> enqueuePos_{ 0 };
+        alignas(64) std::atomic<size_t> dequeuePos_{ 0 };
+    };
+
+    // One CONOUT$ handle kept open for the life of the process. Opening fails
+    // until the debug console exists; the next batch simply retries.
+    class ConsoleSink {
+    public:
+        void write(const std::string& data) {
+            if (data.empty()) {
+                return;
+            }
+            if (!file_ && (fopen_s(&file_, "CONOUT$", "a") != 0 || !file_)) {
+                file_ = nullptr;
+                return;
+            }
+            fwrite(data.data(), 1, data.size(), file_);
+            fflush(file_);
+        }
+
+    private:
+        FILE* file_ = nullptr;
+    };
+
+    LogRing g_ring;
+    ConsoleSink g_sink;
+    std::string g_batch;                    // Only touched by the sink owner
+    std::atomic<bool> g_sinkBusy{ false };
+
+    std::mutex g_wakeMutex;
+    std::condition_variable g_wakeCondition;
+    std::condition_variable g_exitCondition;    // Signalled when the flusher clears g_flusherAlive
+    std::atomic<bool> g_flusherIdle{ false };
+    std::atomic<bool> g_flusherAlive{ false };  // Set before the thread starts, cleared by its last act
+    std::atomic<bool> g_stopping{ false };
+    std::once_flag g_flusherStarted;
+
+    bool tryAcquireSink() {
+        return !g_sinkBusy.exchange(true, std::memory_order_acquire);
+    }
+
+    // Every owner holds the sink for one drain at most, so waiting always ends
+    void acquireSink() {
+        while (!tryAcquireSink()) {
+            std::this_thread::yield();
+        }
+    }
+
+    void releaseSink() {
+        g_sinkBusy.store(false, std::memory_order_release);
+    }
+
+    // Moves every queued line to the console in large writes; caller owns the sink
+    void drainToSink() {
+        while (g_ring.popInto(g_batch)) {
+            if (g_batch.size() >= LOG_BATCH_BYTES) {
+                g_sink.write(g_batch);
+                g_batch.clear();
+            }
+        }
+        g_sink.write(g_batch);
+        g_batch.clear();
+    }
+
+    void flusherMain() {
+        while (!g_stopping.load(std::memory_order_acquire)) {
+            {
+                std::unique_lock<std::mutex> lock(g_wakeMutex);
+                g_flusherIdle.store(true, std::memory_order_release);
+                g_wakeCondition.wait_for(lock, FLUSH_INTERVAL);
+                g_flusherIdle.store(false, std::memory_order_release);
+            }
+
+            if (tryAcquireSink()) {
+                drainToSink();
+                releaseSink();
+            }
+        }
+
+        // Last pass, then the ack shutdownLogger() waits for
+        acquireSink();
+        drainToSink();
+        releaseSink();
+        {
+            std::lock_guard<std::mutex> lock(g_wakeMutex);
+            g_flusherAlive.store(false, std::memory_order_release);
+        }
+        g_exitCondition.notify_all();
+    }
 
-    if (localtime_s(&timeStruct, &currentTime) == 0) {
-        std::strftime(timeBuffer, sizeof(timeBuffer), "%H:%M:%S", &timeStruct);
+    void startFlusher() {
+        g_flusherAlive.store(true, std::memory_order_release);
+        try {
+            std::thread(flusherMain).detach();
+        }
+        catch (const std::exception&) {
+            // Without a flusher, producers drain the ring themselves when it fills
+            g_flusherAlive.store(false, std::memory_order_release);
+        }
     }
 
-    return std::string(timeBuffer);
+    void enqueueLine(const std::string& line, bool urgent) {
+        if (g_stopping.load(std::memory_order_acquire)) {
+            // After shutdown there is no flusher; write straight through
+            acquireSink();
+            drainToSink();
+            g_batch.append(line);
+            g_sink.write(g_batch);
+            g_batch.clear();
+            releaseSink();
+            return;
+        }
+
+        std::call_once(g_flusherStarted, startFlusher);
+
+        while (!g_ring.tryPush(line)) {
+            // Full: drain inline rather than drop or wait on a flusher that
+            // may not be scheduled yet (e.g. while the loader lock is held)
+            if (tryAcquireSink()) {
+                drainToSink();
+                releaseSink();
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+
+        if (urgent || g_flusherIdle.load(std::memory_order_acquire)) {
+            g_wakeCondition.notify_one();
+        }
+    }
 }
 
 // Log level management functions
 void setLogLevel(LogLevel minLevel) {
-    g_minLogLevel = minLevel;
+    g_minLogLevel.store(minLevel, std::memory_order_relaxed);
 }
 
 LogLevel getLogLevel() {
-    return g_minLogLevel;
+    return g_minLogLevel.load(std::memory_order_relaxed);
 }
 
 // Silent mode management functions
 void setSilentMode(bool silent) {
-    g_silentMode = silent;
+    g_silentMode.store(silent, std::memory_order_relaxed);
 
     // In silent mode, only show errors and branding
     if (silent) {
@@ -65,46 +279,77 @@ void setSilentMode(bool silent) {
 }
 
 bool isSilentMode() {
-    return g_silentMode;
+    return g_silentMode.load(std::memory_order_relaxed);
 }
 
-// Core logging function
-void log(const std::string& message, LogLevel level, const char* source) {
+bool isLogEnabled(LogLevel level) {
     // Filter messages based on silent mode and log level
-    if (g_silentMode && level != LOG_ERROR && level != LOG_BRAND) {
-        return;
+    if (g_silentMode.load(std::memory_order_relaxed) && level != LOG_ERROR && level != LOG_BRAND) {
+        return false;
     }
 
-    if (level < g_minLogLevel && level != LOG_ERROR && level != LOG_BRAND) {
+    return level >= g_minLogLevel.load(std::memory_order_relaxed) || level == LOG_ERROR || level == LOG_BRAND;
+}
+
+// Core logging function
+void log(const std::string& message, LogLevel level, const char* source) {
+    logView(message, level, source);
+}
+
+void logView(std::string_view message, LogLevel level, const char* source) {
+    if (!isLogEnabled(level)) {
         return;
     }
 
-    // Thread-safe logging
-    std::lock_guard<std::mutex> lock(g_logMutex);
+    // Formatting happens on the calling thread into a reused buffer
+    thread_local std::string line;
+    line.clear();
 
-    FILE* consoleFile = nullptr;
-    if (fopen_s(&consoleFile, "CONOUT$", "a") == 0 && consoleFile) {
-        if (level == LOG_BRAND) {
-            // Branding messages are printed as-is without formatting
-            fprintf(consoleFile, "%s", message.c_str());
+    if (level == LOG_BRAND) {
+        // Branding messages are printed as-is without formatting
+        line.append(message);
+    }
+    else {
+        // Regular log messages with timestamp and level formatting
+        line.append("[").append(getTimeString()).append("] [").append(getSafeLevelName(level)).append("]");
+        if (source) {
+            line.append(" [").append(source).append("]");
         }
-        else {
-            // Regular log messages with timestamp and level formatting
-            std::string timestamp = getTimeString();
+        line.append(" ").append(message).append("\n");
+    }
 
-            fprintf(consoleFile, "[%s] [%s]%s%s%s %s\n",
-                timestamp.c_str(),
-                getSafeLevelName(level),
-                (source ? " [" : ""),
-                (source ? source : ""),
-                (source ? "]" : ""),
-                message.c_str()
-            );
-        }
+    enqueueLine(line, level >= LOG_ERROR);
+}
+
+void flushLog() {
+    acquireSink();
+    drainToSink();
+    releaseSink();
+}
 
-        fflush(consoleFile);
-        fclose(consoleFile);
+void shutdownLogger(bool processTerminating) {
+    g_stopping.store(true, std::memory_order_release);
+
+    if (processTerminating) {
+        // ExitProcess has already ended every other thread. The flusher may have
+        // died mid-batch holding the sink; nothing can race us for it now.
+        g_flusherAlive.store(false, std::memory_order_release);
+        g_batch.clear();
+        releaseSink();
+    }
+    else {
+        std::unique_lock<std::mutex> lock(g_wakeMutex);
+        g_wakeCondition.notify_one();
+        if (!g_exitCondition.wait_for(lock, SHUTDOWN_ACK_WAIT,
+                [] { return !g_flusherAlive.load(std::memory_order_acquire); })) {
+            // Still alive but not scheduled; its last pass writes what is queued
+            return;
+        }
     }
+
+    acquireSink();
+    drainToSink();
+    releaseSink();
 }
 
 // Branding functions using the BrandingMessages system
@@ -5,6 +5,9 @@
 // =============================================
 #pragma once
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <type_traits>
 
 // Log levels with explicit values for bounds checking
 enum LogLevel {
@@ -27,8 +30,94 @@ bool isSilentMode();
 // Main logging function
 void log(const std::string& msg, LogLevel level = LOG_INFO, const char* source = nullptr);
 
+// Same as log() for a message that is not held in a std::string
+void logView(std::string_view msg, LogLevel level, const char* source);
+
+// Runtime filter applied by log(); cheap enough to check before building a message
+bool isLogEnabled(LogLevel level);
+
+// Messages are queued and written by a background flusher; these write out
+// everything queued so far on the calling thread
+void flushLog();
+
+// Stops the flusher, waits for it to finish its last pass, and switches to direct
+// writes (call from DLL_PROCESS_DETACH). Pass processTerminating when the process is
+// exiting: the flusher is then already gone and its sink is taken over as is.
+void shutdownLogger(bool processTerminating = false);
+
 // Branding functions
 void logBranding();           // Main branding banner
 void logInitBranding();       // Initialization start banner
 void logSuccessBranding();    // Success completion banner
-void logErrorBranding();      // Error state banner
\ No newline at end of file
+void logErrorBranding();      // Error state banner
+
+// =============================================
+// Filtered logging front-end
+// =============================================
+// LOG_AT(level, source, parts...) only evaluates and formats its parts when
+// the level is enabled, and builds the message in a stack buffer:
+//     LOG_AT(LOG_TRACE, "PathUtils", "Trying CWD-relative path: ", candidate);
+// Parts may be strings, string views, characters or integers.
+//
+// Sites below LUALOADER_MIN_LOG_LEVEL are compiled out entirely. It defaults
+// to LOG_TRACE (nothing stripped); release builds can define it to 2 to drop
+// TRACE/DEBUG, at which point logLevel = "trace" in the TOML has no effect.
+#ifndef LUALOADER_MIN_LOG_LEVEL
+#define LUALOADER_MIN_LOG_LEVEL 0
+#endif
+
+constexpr bool isLogLevelCompiledIn(LogLevel level) {
+    return level >= LUALOADER_MIN_LOG_LEVEL || level >= LOG_ERROR;
+}
+
+#define LOG_AT(level, source, ...)                                  \
+    do {                                                            \
+        if constexpr (isLogLevelCompiledIn(level)) {                \
+            if (isLogEnabled(level)) {                              \
+                logParts((level), (source), __VA_ARGS__);           \
+            }                                                       \
+        }                                                           \
+    } while (0)
+
+// Fixed stack storage; only a message longer than the buffer touches the heap
+class LogBuffer {
+public:
+    void append(std::string_view text) {
+        if (!overflow_.empty() || size_ + text.size() > sizeof(data_)) {
+            if (overflow_.empty()) {
+                overflow_.assign(data_, size_);
+            }
+            overflow_.append(text);
+            return;
+        }
+        text.copy(data_ + size_, text.size());
+        size_ += text.size();
+    }
+
+    void append(char c) {
+        append(std::string_view(&c, 1));
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    void append(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    std::string_view view() const {
+        return overflow_.empty() ? std::string_view(data_, size_) : std::string_view(overflow_);
+    }
+
+private:
+    char data_[512];
+    size_t size_ = 0;
+    std::string overflow_;
+};
+
+template <typename... Parts>
+void logParts(LogLevel level, const char* source, const Parts&... parts) {
+    LogBuffer buffer;
+    (buffer.append(parts), ...);
+    logView(buffer.view(), level, source);
+}
\ No newline at end of file
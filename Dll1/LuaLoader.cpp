@@ -13,15 +13,25 @@
 #include "LuaSetup.h"
 #include "HksInjector.h"
 #include "Cleanup.h"  // Add cleanup header
+#include "StartupManifest.h"
+#include "Me3Discovery.h"
+#include "ConfigSnapshot.h"
+#include "InitWorker.h"
+#include "StartupProfiler.h"
+#include "BackgroundIO.h"
+#include "ConfigWatcher.h"
+#include "ModuleWatcher.h"
 #include <windows.h>
 #include <cstdlib> // for atexit
 #include <filesystem>
 #include <vector>
+#include <chrono>
 
 namespace fs = std::filesystem;
 
 static LoaderConfig g_config;
 static HMODULE g_hModule = nullptr;
+static std::string g_dllPath;
 
 // Clean up flag file on exit
 void cleanup() {
@@ -36,74 +46,65 @@ static bool initializePaths() {
         return false;
     }
     fs::path dllPath(buf);
+    g_dllPath = dllPath.string();
 
-    log("DLL location: " + normalizePath(dllPath.parent_path().string()), LOG_DEBUG, "LuaLoader");
-    log("Searching for .me3 config files...", LOG_DEBUG, "LuaLoader");
+    LOG_AT(LOG_DEBUG, "LuaLoader", "DLL location: ", normalizePath(dllPath.parent_path().string()));
+    LOG_AT(LOG_DEBUG, "LuaLoader", "Searching for .me3 config files...");
 
-    // 1. Search for the first .me3 file in standard locations
-    std::vector<fs::path> searchPaths = {
-        dllPath.parent_path(),
-        dllPath.parent_path().parent_path(),
-        dllPath.parent_path().parent_path().parent_path(),
-        fs::current_path(),
-        fs::path("C:/"),
-    };
+    // 1. Search for the first .me3 file in standard locations, unless the
+    //    discovery cache from a previous launch is still valid
+    std::vector<fs::path> searchPaths = getMe3SearchPaths(dllPath);
 
     fs::path me3Path;
-    for (const auto& dir : searchPaths) {
-        log("Searching: " + normalizePath(dir.string()), LOG_TRACE, "LuaLoader");
+    fs::path configPath;
+    Me3Document me3;                // Read at most once per launch
+    Me3Discovery discovery;
+    bool discoveryCached = loadMe3Discovery(g_dllPath, searchPaths, discovery);
+
+    if (discoveryCached) {
+        me3Path = discovery.me3Path;
+        configPath = discovery.configPath;
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Using cached .me3 location: ", me3Path.filename().string());
+    }
+    else {
+        std::vector<PathStamp> dirStamps = stampSearchDirectories(g_dllPath, searchPaths);
 
-        try {
-            if (!fs::exists(dir) || !fs::is_directory(dir)) {
-                continue;
-            }
+        me3Path = scanForMe3(searchPaths, dirStamps, discovery);
 
-            for (const auto& entry : fs::directory_iterator(dir)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".me3") {
-                    me3Path = entry.path();
-                    log("Found .me3 file: " + me3Path.filename().string(), LOG_DEBUG, "LuaLoader");
-                    break;
-                }
+        if (me3Path.empty()) {
+            log("No .me3 configuration file found!", LOG_ERROR, "LuaLoader");
+            log("Create a .me3 file with gameScriptPath and modulePath", LOG_ERROR, "LuaLoader");
+            log("Search paths checked:", LOG_ERROR, "LuaLoader");
+            for (const auto& path : searchPaths) {
+                log("  " + path.string(), LOG_ERROR, "LuaLoader");
             }
+            return false;
         }
-        catch (const std::exception& e) {
-            log("Cannot access directory " + dir.string() + ": " + e.what(), LOG_TRACE, "LuaLoader");
-            continue;
-        }
-        if (!me3Path.empty()) break;
-    }
 
-    if (me3Path.empty()) {
-        log("No .me3 configuration file found!", LOG_ERROR, "LuaLoader");
-        log("Create a .me3 file with gameScriptPath and modulePath", LOG_ERROR, "LuaLoader");
-        log("Search paths checked:", LOG_ERROR, "LuaLoader");
-        for (const auto& path : searchPaths) {
-            log("  " + path.string(), LOG_ERROR, "LuaLoader");
+        // Stamp the .me3 before reading it so an edit during the read invalidates the cache
+        discovery.me3Stamp = stampPath(me3Path.string());
+
+        // 2. Check for path override in .me3 file
+        std::string_view overridePath;
+        if (me3.load(me3Path.string()) && me3.find(ME3_CONFIG_PATH_KEY, overridePath) && !overridePath.empty()) {
+            configPath = overridePath;
+            // If relative path, resolve it relative to the .me3 file
+            if (configPath.is_relative()) {
+                configPath = me3Path.parent_path() / configPath;
+            }
+            LOG_AT(LOG_DEBUG, "LuaLoader", "Using custom config path from .me3: ", configPath.string());
+        }
+        else {
+            // 3. Use default path next to .me3 file
+            configPath = me3Path.parent_path() / "LuaLoader.toml";
+            LOG_AT(LOG_DEBUG, "LuaLoader", "Using default config path: ", configPath.string());
         }
-        return false;
     }
 
     fs::path configDir = me3Path.parent_path();
-    fs::path configPath;
-
-    // 2. Check for path override in .me3 file
-    std::string overridePath = parseConfigPathFromMe3(me3Path);
-    if (!overridePath.empty()) {
-        configPath = overridePath;
-        // If relative path, resolve it relative to the .me3 file
-        if (configPath.is_relative()) {
-            configPath = configDir / configPath;
-        }
-        log("Using custom config path from .me3: " + configPath.string(), LOG_DEBUG, "LuaLoader");
-    }
-    else {
-        // 3. Use default path next to .me3 file
-        configPath = configDir / "LuaLoader.toml";
-        log("Using default config path: " + configPath.string(), LOG_DEBUG, "LuaLoader");
-    }
 
     // 4. If config does not exist, generate it
-    if (!fs::exists(configPath)) {
+    if (!pfs::exists(configPath)) {
         log("Configuration file not found, generating default config", LOG_INFO, "LuaLoader");
         log("Config will be created at: " + configPath.string(), LOG_INFO, "LuaLoader");
 
@@ -117,21 +118,41 @@ static bool initializePaths() {
         }
 
         generateDefaultConfigToml(configPath.string());
-        injectTomlPathToMe3(me3Path.string(), configPath.string());
+        if (!me3.isLoaded()) {
+            me3.load(me3Path.string());
+        }
+        injectTomlPathToMe3(me3, configPath.string());
 
         log("Default config generated successfully!", LOG_INFO, "LuaLoader");
         log("Please edit the configuration file and restart to complete setup", LOG_INFO, "LuaLoader");
         return false; // Ask user to edit config
     }
 
-    // 5. Parse the config
-    if (!parseTomlConfig(configPath.string(), g_config)) {
+    if (!discoveryCached) {
+        discovery.me3Path = me3Path.string();
+        discovery.configPath = configPath.string();
+        saveMe3Discovery(g_dllPath, discovery);
+    }
+
+    // 5. Reuse the resolved config from the last launch if the TOML and launch
+    //    location are unchanged; otherwise parse it and snapshot the result
+    bool parsed;
+    bool fromSnapshot;
+    {
+        StartupProfiler::ScopedPhase phase("parseTomlConfig");
+        fromSnapshot = loadConfigSnapshot(configPath.string(), me3Path.string(), g_config);
+        parsed = fromSnapshot || parseTomlConfig(configPath.string(), g_config);
+    }
+    if (parsed && !fromSnapshot) {
+        saveConfigSnapshot(configPath.string(), me3Path.string(), g_config);
+    }
+    if (!parsed) {
         log("Config parsing failed. Please check " + configPath.string(), LOG_ERROR, "LuaLoader");
         return false;
     }
 
-    log("Configuration loaded: " + configPath.filename().string(), LOG_INFO, "LuaLoader");
-    log("Config directory: " + configDir.string(), LOG_DEBUG, "LuaLoader");
+    log("Configuration loaded: " + configPath.filename().string() + (fromSnapshot ? " (unchanged, from snapshot)" : ""), LOG_INFO, "LuaLoader");
+    LOG_AT(LOG_DEBUG, "LuaLoader", "Config directory: ", configDir.string());
     return true;
 }
 
@@ -147,23 +168,30 @@ static bool handleCleanupIfRequested() {
 
     // DEBUG: Analyze HKS file before cleanup (only in debug mode)
     if (getLogLevel() <= LOG_DEBUG) {
-        std::string hksPath = g_config.gameScriptPath.absolutePath + "/c0000.hks";
-        log("Analyzing HKS file before cleanup:", LOG_DEBUG, "LuaLoader");
-        Cleanup::debugHksFile(hksPath);
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Analyzing HKS files before cleanup:");
+        for (const auto& hksPath : resolveHksTargets(g_config)) {
+            Cleanup::debugHksFile(hksPath);
+        }
     }
 
     // Perform the cleanup
     bool cleanupSuccess = Cleanup::performFullCleanup(g_config);
 
+    // The discovery cache sits next to the DLL and the snapshot next to the
+    // TOML, both outside the module directory
+    invalidateMe3Discovery(g_dllPath);
+    invalidateConfigSnapshot(g_config.configFile);
+
     // DEBUG: Analyze HKS file after cleanup (only in debug mode)
     if (getLogLevel() <= LOG_DEBUG) {
-        std::string hksPath = g_config.gameScriptPath.absolutePath + "/c0000.hks";
-        log("Analyzing HKS file after cleanup:", LOG_DEBUG, "LuaLoader");
-        Cleanup::debugHksFile(hksPath);
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Analyzing HKS files after cleanup:");
+        for (const auto& hksPath : resolveHksTargets(g_config)) {
+            Cleanup::debugHksFile(hksPath);
+        }
     }
 
     // Reset the flag in the config file regardless of cleanup result
-    bool flagResetSuccess = updateCleanupFlag(g_config.configFile, false);
+    bool flagResetSuccess = updateCleanupFlag(g_config.configFile, false, &g_config.layout);
 
     if (!flagResetSuccess) {
         log("Warning: Failed to reset cleanupOnNextLaunch flag in config", LOG_WARNING, "LuaLoader");
@@ -192,71 +220,199 @@ static bool handleCleanupIfRequested() {
     }
 }
 
-// DLL Entry Point
-BOOL APIENTRY DllMain(HMODULE hMod, DWORD reason, LPVOID) {
-    switch (reason) {
-    case DLL_PROCESS_ATTACH:
-        log("DLL_PROCESS_ATTACH - Starting initialization", LOG_TRACE, "LuaLoader");
+// Full loader initialization; runs on the init worker thread, never under the loader lock
+static bool runInitialization() {
+    // Launch backups and pruning queued below start only once this returns
+    BackgroundIOHold backgroundHold;
 
-        InitConsole();
-        g_hModule = hMod;
+    InitConsole();
 
-        // Show main branding banner
-        logBranding();
-
-        // Show initialization start banner
-        logInitBranding();
-
-        if (!initializePaths()) {
-            // Show error branding banner
-            logErrorBranding();
-
-            log("Initialization failed - check your configuration", LOG_ERROR, "LuaLoader");
-            log("", LOG_ERROR, "LuaLoader");
-            log("Configuration process:", LOG_ERROR, "LuaLoader");
-            log("1. Create a .me3 file with basic config", LOG_ERROR, "LuaLoader");
-            log("2. LuaLoader.toml will be auto-generated", LOG_ERROR, "LuaLoader");
-            log("3. Edit LuaLoader.toml and relaunch", LOG_ERROR, "LuaLoader");
-            log("", LOG_ERROR, "LuaLoader");
-            log("For custom config location, add to .me3:", LOG_ERROR, "LuaLoader");
-            log("  luaLoaderConfigPath = \"path/to/config.toml\"", LOG_ERROR, "LuaLoader");
-            break;
-        }
+    // Show main branding banner
+    logBranding();
 
-        // Handle cleanup if requested (this may exit early)
-        if (!handleCleanupIfRequested()) {
-            log("Exiting after cleanup operation", LOG_INFO, "LuaLoader");
-            break;
-        }
+    // Show initialization start banner
+    logInitBranding();
+
+    bool pathsReady;
+    {
+        StartupProfiler::ScopedPhase phase("initializePaths");
+        pathsReady = initializePaths();
+    }
+
+    if (!pathsReady) {
+        // Show error branding banner
+        logErrorBranding();
+
+        log("Initialization failed - check your configuration", LOG_ERROR, "LuaLoader");
+        log("", LOG_ERROR, "LuaLoader");
+        log("Configuration process:", LOG_ERROR, "LuaLoader");
+        log("1. Create a .me3 file with basic config", LOG_ERROR, "LuaLoader");
+        log("2. LuaLoader.toml will be auto-generated", LOG_ERROR, "LuaLoader");
+        log("3. Edit LuaLoader.toml and relaunch", LOG_ERROR, "LuaLoader");
+        log("", LOG_ERROR, "LuaLoader");
+        log("For custom config location, add to .me3:", LOG_ERROR, "LuaLoader");
+        log("  luaLoaderConfigPath = \"path/to/config.toml\"", LOG_ERROR, "LuaLoader");
+        log(StartupProfiler::formatSummary(), LOG_INFO, "LuaLoader");
+        return false;
+    }
+
+    // Handle cleanup if requested (this may exit early)
+    bool continueStartup;
+    {
+        StartupProfiler::ScopedPhase phase("handleCleanupIfRequested");
+        continueStartup = handleCleanupIfRequested();
+    }
 
+    if (!continueStartup) {
+        log("Exiting after cleanup operation", LOG_INFO, "LuaLoader");
+        return false;
+    }
+
+    {
+        StartupProfiler::ScopedPhase phase("validatePaths");
         if (!validatePaths(g_config)) {
             log("Path validation had issues, but continuing...", LOG_WARNING, "LuaLoader");
         }
+    }
+
+    // The attach stub already replaced the session file, so a setup script that
+    // runs from here on waits for us and ignores the last launch's flag file
+    LOG_AT(LOG_DEBUG, "LuaLoader", "Launch session: ", getSessionToken());
+
+    // Fast path: nothing changed since the last launch, so the setup script
+    // and HKS injection on disk are already correct
+    bool unchanged;
+    {
+        StartupProfiler::ScopedPhase phase("isStartupUnchanged");
+        unchanged = isStartupUnchanged(g_config, g_dllPath);
+    }
+
+    if (unchanged) {
+        log("No changes since last launch - reusing setup script and HKS integration", LOG_INFO, "LuaLoader");
+        // backupHKSonLaunch means every launch, including the unchanged ones
+        queueLaunchBackups(g_config);
+    }
+    else {
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Creating setup script...");
+        bool scriptReady;
+        {
+            StartupProfiler::ScopedPhase phase("createWorkingSetupScript");
+            scriptReady = createWorkingSetupScript(g_config, getSessionFilePath(g_dllPath));
+        }
+
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Injecting into HKS file...");
+        bool hksReady;
+        {
+            StartupProfiler::ScopedPhase phase("injectIntoHksFile");
+            hksReady = injectIntoHksFile(g_config);
+        }
+
+        // Only a fully successful launch may be reused next time
+        if (scriptReady && hksReady) {
+            recordStartupManifest(g_config, g_dllPath);
+        }
+        else {
+            invalidateStartupManifest(g_config.modulePath.absolutePath);
+        }
+    }
+
+    // Release a setup script waiting on the session
+    updateSessionState(SESSION_STATE_READY);
 
-        // Always clear the flag file on DLL load to ensure fresh module loading
-        clearModuleLoadedFlag(g_config.modulePath.absolutePath);
-        log("Cleared module loaded flag for fresh reload", LOG_DEBUG, "LuaLoader");
+    // Register cleanup function for process exit
+    atexit(cleanup);
 
-        log("Creating setup script...", LOG_DEBUG, "LuaLoader");
-        createWorkingSetupScript(g_config);
+    // From here on edits to the TOML are picked up while the game runs
+    publishActiveConfig(g_config);
+    if (!startConfigWatcher(g_config.configFile)) {
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Config changes will need a restart to apply");
+    }
+
+    // Modules added or saved from now on show up in the index the setup script checks
+    if (!startModuleWatcher(g_config.modulePath.absolutePath)) {
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Module changes will need a restart to show up");
+    }
 
-        log("Injecting into HKS file...", LOG_DEBUG, "LuaLoader");
-        injectIntoHksFile(g_config);
+    // Show success branding banner
+    logSuccessBranding();
+
+    // Per-phase timings and filesystem counters
+    std::string profilePath = g_config.modulePath.absolutePath + "/_module_loader/startup_profile.json";
+    if (!StartupProfiler::writeReport(profilePath)) {
+        LOG_AT(LOG_DEBUG, "LuaLoader", "Cannot write startup profile: ", profilePath);
+    }
+    log(StartupProfiler::formatSummary(), LOG_INFO, "LuaLoader");
 
-        // Register cleanup function for process exit
-        atexit(cleanup);
+    log("Initialization complete - ready for module loading", LOG_INFO, "LuaLoader");
+    log("Config: " + fs::path(g_config.configFile).filename().string() + " | Modules will load when game script runs", LOG_INFO, "LuaLoader");
+    return true;
+}
 
-        // Show success branding banner
-        logSuccessBranding();
+// Barrier for native callers that must not run before the loader is ready.
+// Returns 1 once initialization succeeded, 0 on failure or timeout.
+extern "C" __declspec(dllexport) int LuaLoader_WaitForInitialization(unsigned int timeoutMs) {
+    return waitForInitialization(timeoutMs) == InitState::Succeeded ? 1 : 0;
+}
 
-        log("Initialization complete - ready for module loading", LOG_INFO, "LuaLoader");
-        log("Config: " + fs::path(g_config.configFile).filename().string() + " | Modules will load when game script runs", LOG_INFO, "LuaLoader");
+// DLL Entry Point
+BOOL APIENTRY DllMain(HMODULE hMod, DWORD reason, LPVOID reserved) {
+    switch (reason) {
+    case DLL_PROCESS_ATTACH: {
+        // Attach stub only: all file I/O happens on the init worker after the loader lock is released
+        auto attachStart = std::chrono::steady_clock::now();
+        g_hModule = hMod;
+        DisableThreadLibraryCalls(hMod);
+
+        // Replace the last launch's session (and with it its "ready" state and
+        // flag token) before the game can run the HKS; one small write
+        char buf[MAX_PATH] = {};
+        if (GetModuleFileNameA(hMod, buf, MAX_PATH)) {
+            g_dllPath = buf;
+            beginSession(g_dllPath);
+        }
+
+        auto initialize = []() {
+            bool succeeded = runInitialization();
+            if (!succeeded) {
+                // Don't leave a waiting setup script hanging until its timeout
+                updateSessionState(SESSION_STATE_FAILED);
+            }
+            return succeeded;
+        };
+        if (!startInitializationWorker(initialize)) {
+            log("Failed to start initialization worker", LOG_ERROR, "LuaLoader");
+            updateSessionState(SESSION_STATE_FAILED);
+        }
+
+        std::chrono::duration<double, std::micro> attachTime = std::chrono::steady_clock::now() - attachStart;
+        LOG_AT(LOG_TRACE, "LuaLoader", "DLL_PROCESS_ATTACH returned after ", static_cast<long long>(attachTime.count()), " us");
         break;
+    }
 
     case DLL_PROCESS_DETACH:
-        log("DLL_PROCESS_DETACH - Cleaning up", LOG_TRACE, "LuaLoader");
-        // Clean up flag file on process detach
-        cleanup();
+        LOG_AT(LOG_TRACE, "LuaLoader", "DLL_PROCESS_DETACH - Cleaning up");
+        // Clean up flag file on process detach (config is only stable once the worker is done).
+        // On FreeLibrary the worker's module reference means it has already
+        // finished; only ExitProcess can end it mid-run and leave Running here.
+        if (getInitializationState() != InitState::Running) {
+            cleanup();
+        }
+        // Queued backups are optional and are dropped. At process exit the lane
+        // thread is already gone; on FreeLibrary it holds a reference on this
+        // module while it runs, so getting here means it has already left. The
+        // config and module watchers hold one too and only exit when stopped,
+        // so after a FreeLibrary the DLL stays loaded until the process exits.
+        stopConfigWatcher();
+        stopModuleWatcher();
+        stopBackgroundIO();
+        if (reserved == nullptr) {
+            BackgroundIOStats stats = getBackgroundIOStats();
+            LOG_AT(LOG_DEBUG, "LuaLoader", "Background I/O: ", stats.completed, " completed, ", stats.failed, " failed, ",
+                stats.cancelled, " cancelled, ", stats.rejected, " rejected, ", stats.replaced, " replaced");
+        }
+        // Write out queued log lines; later messages (atexit) go straight to the console.
+        // A non-null reserved means ExitProcess, which has already ended the flusher.
+        shutdownLogger(reserved != nullptr);
         break;
     }
     return TRUE;
@@ -6,9 +6,13 @@
 #include "LuaSetup.h"
 #include "Logger.h"
 #include "ErrorMessages.h"  // For beautiful error messages
+#include "ModuleManifest.h"
+#include "BytecodeCache.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
 #include <filesystem>
-#include <fstream>
 #include <sstream>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
@@ -43,19 +47,19 @@ static bool validateConfiguration(const LoaderConfig& config) {
         return false;
     }
 
-    log("Configuration validation passed", LOG_DEBUG, "LuaSetup");
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Configuration validation passed");
     return true;
 }
 
 // Create the loader directory with proper error handling
 static bool createLoaderDirectory(const std::string& loaderDir) {
     try {
-        if (fs::exists(loaderDir)) {
-            log("Loader directory already exists: " + loaderDir, LOG_DEBUG, "LuaSetup");
+        if (pfs::exists(loaderDir)) {
+            LOG_AT(LOG_DEBUG, "LuaSetup", "Loader directory already exists: ", loaderDir);
         }
         else {
             fs::create_directories(loaderDir);
-            log("Created loader directory: " + loaderDir, LOG_DEBUG, "LuaSetup");
+            LOG_AT(LOG_DEBUG, "LuaSetup", "Created loader directory: ", loaderDir);
         }
         return true;
     }
@@ -73,27 +77,32 @@ static bool createLoaderDirectory(const std::string& loaderDir) {
     }
 }
 
-// Remove existing setup script if present
-static bool cleanupExistingScript(const std::string& setupScript) {
-    try {
-        if (fs::exists(setupScript)) {
-            fs::remove(setupScript);
-            log("Removed existing setup script", LOG_DEBUG, "LuaSetup");
+// Helper: Warn about [modules.<name>] tables that match no module file (usually a typo)
+static void reportUnmatchedModuleTables(const ModulePolicyTable& policy, const std::vector<ModuleEntry>& modules) {
+    // scanModuleDirectory returns the modules sorted by name
+    for (ModulePolicyTable::ModuleId id = 0; id < policy.size(); ++id) {
+        std::string_view name = policy.name(id);
+        auto it = std::lower_bound(modules.begin(), modules.end(), name,
+            [](const ModuleEntry& module, std::string_view value) { return module.name < value; });
+        if (it == modules.end() || it->name != name) {
+            log("Module settings for '" + std::string(name) + "' match no .lua file in the module path", LOG_WARNING, "LuaSetup");
         }
-        return true;
-    }
-    catch (const std::filesystem::filesystem_error& e) {
-        log("Filesystem error removing existing script: " + std::string(e.what()), LOG_WARNING, "LuaSetup");
-        return false;  // Continue anyway, might overwrite
     }
-    catch (...) {
-        log("Unknown error removing existing script", LOG_WARNING, "LuaSetup");
-        return false;  // Continue anyway
+}
+
+// Helper: Render the bytecode cache map as a Lua table constructor
+static std::string formatBytecodeCacheAsLua(const BytecodeCacheResult& cache) {
+    std::string lua = "{\n";
+    for (const auto& [name, chunkFile] : cache.chunkFiles) {
+        lua += "    [" + quoteLuaString(name) + "] = " + quoteLuaString(chunkFile) + ",\n";
     }
+    lua += "}";
+    return lua;
 }
 
 // Generate the Lua template with all substitutions
-static std::string generateLuaScript(const LoaderConfig& config, const std::string& loaderDir) {
+static std::string generateLuaScript(const LoaderConfig& config, const std::string& loaderDir,
+    const std::string& sessionFile, const std::vector<ModuleEntry>& modules, const BytecodeCacheResult& bytecodeCache) {
     static const char* LUA_TEMPLATE = R"LUASCRIPT(
 -- Lua Loader by Malice - Setup Script (Enhanced Path Resolution Version)
 local MODULE_PATH = "${MODULE_PATH}"
@@ -107,19 +116,63 @@ function consolePrint(msg)
 end
 print = consolePrint
 
--- Get current process ID (Windows specific)
-local function getCurrentProcessId()
-    local handle = io.popen("echo %WINPID% 2>nul || powershell -Command \"Get-Process -Id $PID | Select-Object -ExpandProperty Id\"")
-    local pid = "unknown"
-    if handle then
-        pid = handle:read("*l") or "unknown"
-        handle:close()
+-- Process ID, launch token and init state recorded by the loader DLL (no child processes)
+local SESSION_FILE = ${SESSION_FILE}
+local INIT_TIMEOUT_SECONDS = 10
+
+local function readSession()
+    local f = io.open(SESSION_FILE, "r")
+    if not f then return nil end
+    local content = f:read("*a")
+    f:close()
+    return content
+end
+
+-- Lua has no sleep; pause between polls with a spin that doubles up to a cap
+local POLL_SPIN_MIN = 10000
+local POLL_SPIN_MAX = 1000000
+
+local function pause(spins)
+    local x = 0
+    for i = 1, spins do x = x + i end
+    return x
+end
+
+-- Barrier: wait (bounded, wall clock) while the loader's background initialization is still running
+local function waitForSession()
+    local content = readSession()
+    -- os.time() has one-second resolution; the extra second keeps the wait at least INIT_TIMEOUT_SECONDS
+    local deadline = os.time() + INIT_TIMEOUT_SECONDS + 1
+    local spins = POLL_SPIN_MIN
+    while content and content:find("STATE:initializing", 1, true) do
+        if os.time() >= deadline then
+            print("Loader initialization still running after " .. INIT_TIMEOUT_SECONDS .. "s - continuing without waiting")
+            break
+        end
+        pause(spins)
+        spins = math.min(spins * 2, POLL_SPIN_MAX)
+        content = readSession()
+    end
+    if content and content:find("STATE:failed", 1, true) then
+        print("Loader initialization failed - using the setup from the last successful launch")
     end
-    return tostring(pid):gsub("%s+", "") -- trim whitespace
+    return content
 end
 
--- Check if modules are already loaded for this process
+local SESSION = waitForSession()
+local CURRENT_PID = SESSION and SESSION:match("PID:(%d+)") or "unknown"
+local CURRENT_SESSION = SESSION and SESSION:match("SESSION:([%w%-]+)")
+
+-- Check if modules are already loaded in this launch
 local function isAlreadyLoaded()
+    -- Same Lua state re-running the script: answer without touching the disk
+    if _G.ModulesLoadedSession ~= nil and _G.ModulesLoadedSession == (CURRENT_SESSION or false) then
+        return true
+    end
+
+    -- Without a session token a flag file cannot be tied to this launch
+    if not CURRENT_SESSION then return false end
+
     local f = io.open(FLAG_FILE, "r")
     if not f then return false end
     
@@ -128,13 +181,8 @@ local function isAlreadyLoaded()
     
     if not content then return false end
     
-    -- Look for current process ID in the flag file
-    local currentPid = getCurrentProcessId()
-    if content:find("PID:" .. currentPid) then
-        return true
-    end
-    
-    return false
+    -- The token changes every launch, so a flag left by an earlier one (even with a reused PID) never matches
+    return content:find("SESSION:" .. CURRENT_SESSION .. "\n", 1, true) ~= nil
 end
 
 -- Early exit if already loaded in this process
@@ -153,38 +201,160 @@ print("Module path (relative): ${MODULE_RELATIVE_PATH}")
 print("==========================================")
 print("")
 
--- Scan for .lua modules
-local function scanForModules()
+-- Module manifest baked in by the loader DLL (sorted by name)
+local MODULE_MANIFEST = ${MODULE_MANIFEST}
+local MANIFEST_STAMP = "${MANIFEST_STAMP}"
+
+-- The DLL keeps this index current while the game runs: "STAMP:<hash>" and one name per line
+local MODULE_INDEX = LOADER_DIR .. "/module_index.txt"
+
+local function readModuleIndex()
+    local f = io.open(MODULE_INDEX, "r")
+    if not f then return nil end
+    local stamp = (f:read("*l") or ""):match("^STAMP:(%x+)")
+    local names = {}
+    for line in f:lines() do
+        if line ~= "" then table.insert(names, line) end
+    end
+    f:close()
+    if not stamp then return nil end
+    return stamp, names
+end
+
+-- Without an index: the manifest is stale if any listed module vanished or changed size
+local function isManifestCurrent()
+    for _, entry in ipairs(MODULE_MANIFEST) do
+        local f = io.open(MODULE_PATH .. "/" .. entry.name .. ".lua", "rb")
+        if not f then return false end
+        local size = f:seek("end")
+        f:close()
+        if size ~= entry.size then return false end
+    end
+    return true
+end
+
+local function manifestNames(onlyExisting)
     local modules = {}
-    local handle = io.popen('dir "' .. MODULE_PATH .. '\\*.lua" /b 2>nul')
-    if handle then
-        for filename in handle:lines() do
-            local name = filename:match("(.+)%.lua$")
-            if name and name ~= "module_loader_setup" then
-                table.insert(modules, name)
-            end
+    for _, entry in ipairs(MODULE_MANIFEST) do
+        local f = not onlyExisting or io.open(MODULE_PATH .. "/" .. entry.name .. ".lua", "rb")
+        if f then
+            if onlyExisting then f:close() end
+            table.insert(modules, entry.name)
         end
-        handle:close()
     end
     return modules
 end
 
+-- Resolve the module list, preferring the baked manifest
+local function scanForModules()
+    local stamp, indexed = readModuleIndex()
+    if stamp == MANIFEST_STAMP or (not stamp and isManifestCurrent()) then
+        return manifestNames(false), true
+    end
+
+    if indexed then
+        print("Module manifest is stale - using the loader's module index")
+        return indexed, false
+    end
+    print("Module manifest is stale and no module index was found - loading the listed modules that remain")
+    return manifestNames(true), false
+end
+
+-- Per-module settings from the [modules.<name>] tables, as arrays indexed by module ID
+${MODULE_POLICY}
+
+-- Values from a module's env table, for the module to read while it loads
+function moduleEnv(moduleName)
+    local id = MODULE_IDS[moduleName]
+    return id and MODULE_ENV[id] or {}
+end
+
+-- Drops disabled and lazy modules, then orders the rest by priority (higher first) and name
+local function applyModulePolicy(modules)
+    if next(MODULE_IDS) == nil then
+        return modules, 0, 0
+    end
+
+    local selected, disabled, deferred = {}, 0, 0
+    for _, moduleName in ipairs(modules) do
+        local id = MODULE_IDS[moduleName]
+        if id and not MODULE_ENABLED[id] then
+            disabled = disabled + 1
+        elseif id and MODULE_LAZY[id] then
+            deferred = deferred + 1
+        else
+            table.insert(selected, moduleName)
+        end
+    end
+
+    local function priorityOf(moduleName)
+        local id = MODULE_IDS[moduleName]
+        return id and MODULE_PRIORITY[id] or 0
+    end
+    table.sort(selected, function(a, b)
+        local pa, pb = priorityOf(a), priorityOf(b)
+        if pa ~= pb then return pa > pb end
+        return a < b
+    end)
+    return selected, disabled, deferred
+end
+
+-- Precompiled chunks from the loader's bytecode cache (module name -> chunk file)
+local BYTECODE_DIR = LOADER_DIR .. "/bytecode"
+local BYTECODE_CACHE = ${BYTECODE_CACHE}
+
+-- Register cached chunks with require, only when this runtime can load them
+local function installCachedChunks(modules)
+    if _VERSION ~= "${BYTECODE_VERSION}" or type(package.preload) ~= "table" then
+        return 0
+    end
+
+    local installed = 0
+    for _, moduleName in ipairs(modules) do
+        local chunkFile = BYTECODE_CACHE[moduleName]
+        if chunkFile and package.preload[moduleName] == nil then
+            local chunk = loadfile(BYTECODE_DIR .. "/" .. chunkFile)
+            if chunk then
+                package.preload[moduleName] = chunk
+                installed = installed + 1
+            end
+        end
+    end
+    return installed
+end
+
 -- Main module loading function
 function loadModules()
     -- Add module path to package.path
     package.path = package.path .. ";" .. MODULE_PATH .. "/?.lua"
     
-    local modules = scanForModules()
+    local modules, fromManifest = scanForModules()
     if #modules == 0 then
         print("No modules found in: " .. MODULE_PATH)
         return false
     end
 
+    -- The cache was built from the manifest, so only trust it while the manifest is current
+    if fromManifest and next(BYTECODE_CACHE) ~= nil then
+        local cached = installCachedChunks(modules)
+        if cached > 0 then
+            print("Using " .. cached .. " precompiled module(s) from cache")
+        end
+    end
+
+    -- Lazy modules keep their cached chunk, so a later require still uses it
+    local found = #modules
+    local disabled, deferred
+    modules, disabled, deferred = applyModulePolicy(modules)
+
     -- List modules to be loaded
-    print("Loading " .. #modules .. "/" .. #modules .. " Modules:")
+    print("Loading " .. #modules .. "/" .. found .. " Modules:")
     for i, moduleName in ipairs(modules) do
         print("  " .. i .. ". " .. moduleName .. ".lua")
     end
+    if disabled > 0 or deferred > 0 then
+        print("  (" .. disabled .. " disabled, " .. deferred .. " lazy - loaded by require on first use)")
+    end
     print("")
 
     -- Load each module
@@ -203,11 +373,15 @@ function loadModules()
         end
     end
 
-    -- Create flag file with process ID to prevent reloading
+    -- Remember the load in this Lua state and in the flag file to prevent reloading
+    _G.ModulesLoadedSession = CURRENT_SESSION or false
     local flagFile = io.open(FLAG_FILE, "w")
     if flagFile then
         flagFile:write("Loaded at: " .. os.date() .. "\n")
-        flagFile:write("PID:" .. getCurrentProcessId() .. "\n")
+        flagFile:write("PID:" .. CURRENT_PID .. "\n")
+        if CURRENT_SESSION then
+            flagFile:write("SESSION:" .. CURRENT_SESSION .. "\n")
+        end
         flagFile:write("Modules loaded: " .. loadedCount .. "/" .. #modules .. "\n")
         flagFile:write("Config directory: " .. CONFIG_DIR .. "\n")
         flagFile:write("Module path (absolute): " .. MODULE_PATH .. "\n")
@@ -234,97 +408,89 @@ loadModules()
     // Perform all path substitutions
     std::string lua = LUA_TEMPLATE;
     lua = replaceAll(lua, "${LOADER_DIR}", loaderDir);
+    lua = replaceAll(lua, "${SESSION_FILE}", quoteLuaString(sessionFile));
     lua = replaceAll(lua, "${MODULE_PATH}", config.modulePath.absolutePath);
     lua = replaceAll(lua, "${CONFIG_DIR}", config.configDir);
     lua = replaceAll(lua, "${CONFIG_RELATIVE_PATH}", config.gameScriptPath.relativePath);
     lua = replaceAll(lua, "${MODULE_RELATIVE_PATH}", config.modulePath.relativePath);
+    lua = replaceAll(lua, "${BYTECODE_VERSION}", getBytecodeRuntimeVersion());
+    lua = replaceAll(lua, "${BYTECODE_CACHE}", formatBytecodeCacheAsLua(bytecodeCache));
+    lua = replaceAll(lua, "${MODULE_MANIFEST}", formatManifestAsLua(modules));
+    lua = replaceAll(lua, "${MANIFEST_STAMP}", computeModuleListingStamp(modules));
+    lua = replaceAll(lua, "${MODULE_POLICY}", formatModulePolicyAsLua(*config.modulePolicy));
 
-    log("Applied all path substitutions to Lua template", LOG_DEBUG, "LuaSetup");
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Applied all path substitutions to Lua template");
     return lua;
 }
 
-// Write the script file with comprehensive error handling
+// Write the script file; the game never sees a partially written script
 static bool writeScriptFile(const std::string& setupScript, const std::string& luaContent) {
-    try {
-        std::ofstream out(setupScript, std::ios::binary);  // Use binary mode for consistency
-        if (!out.is_open()) {
-            log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, "Unable to open file for writing"), LOG_BRAND);
-            return false;
-        }
-
-        out << luaContent;
-
-        // Check for write errors
-        if (out.bad()) {
-            out.close();
-            log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, "Write operation failed"), LOG_BRAND);
-            return false;
-        }
-
-        // Flush and close with error checking
-        out.flush();
-        if (out.bad()) {
-            out.close();
-            log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, "Flush operation failed"), LOG_BRAND);
-            return false;
-        }
-
-        out.close();
-        log("Setup script written successfully", LOG_DEBUG, "LuaSetup");
-        return true;
-
-    }
-    catch (const std::ios_base::failure& e) {
-        log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, "I/O error: " + std::string(e.what())), LOG_BRAND);
-        return false;
-    }
-    catch (const std::exception& e) {
-        log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, "Write error: " + std::string(e.what())), LOG_BRAND);
-        return false;
-    }
-    catch (...) {
-        log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, "Unknown error occurred during write operation"), LOG_BRAND);
+    std::string error;
+    if (!writeFileAtomic(setupScript, luaContent, error)) {
+        log(ErrorMessages::formatLuaSetupScriptWriteError(setupScript, error), LOG_BRAND);
         return false;
     }
+
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Setup script written successfully");
+    return true;
 }
 
 // Main function - now clean and organized
-void createWorkingSetupScript(const LoaderConfig& config) {
-    log("Starting setup script creation", LOG_DEBUG, "LuaSetup");
+bool createWorkingSetupScript(const LoaderConfig& config, const std::string& sessionFile) {
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Starting setup script creation");
 
     // Step 1: Validate configuration
     if (!validateConfiguration(config)) {
         log("Setup script creation aborted due to configuration issues", LOG_ERROR, "LuaSetup");
-        return;
+        return false;
     }
 
     // Step 2: Determine paths
     std::string loaderDir = config.modulePath.absolutePath + "/_module_loader";
     std::string setupScript = loaderDir + "/module_loader_setup.lua";
 
-    log("Target setup script: " + setupScript, LOG_DEBUG, "LuaSetup");
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Target setup script: ", setupScript);
 
     // Step 3: Create loader directory
     if (!createLoaderDirectory(loaderDir)) {
         log("Setup script creation aborted due to directory creation failure", LOG_ERROR, "LuaSetup");
-        return;
+        return false;
+    }
+
+    // Step 4: Enumerate modules and optionally refresh the bytecode cache
+    std::vector<ModuleEntry> modules = scanModuleDirectory(config.modulePath.absolutePath);
+    reportUnmatchedModuleTables(*config.modulePolicy, modules);
+    BytecodeCacheResult bytecodeCache;
+    if (config.precompileModules) {
+        // Disabled modules never run, so they are not worth compiling
+        std::vector<ModuleEntry> compiled;
+        compiled.reserve(modules.size());
+        for (const auto& module : modules) {
+            if (config.modulePolicy->isEnabled(module.name)) {
+                compiled.push_back(module);
+            }
+        }
+        bytecodeCache = updateBytecodeCache(config.modulePath.absolutePath, compiled);
+        log("Precompiled modules: " + std::to_string(bytecodeCache.compiled) + " compiled, " +
+            std::to_string(bytecodeCache.reused) + " cached", LOG_INFO, "LuaSetup");
     }
 
-    // Step 4: Clean up existing script (non-fatal if fails)
-    cleanupExistingScript(setupScript);
+    // The index tells the script whether the baked manifest still matches the directory
+    writeModuleIndex(config.modulePath.absolutePath, modules);
 
     // Step 5: Generate Lua script content
-    log("Generating Lua script content", LOG_DEBUG, "LuaSetup");
-    std::string luaContent = generateLuaScript(config, loaderDir);
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Generating Lua script content");
+    std::string luaContent = generateLuaScript(config, loaderDir, sessionFile, modules, bytecodeCache);
 
     // Step 6: Write the script file
     if (!writeScriptFile(setupScript, luaContent)) {
         log("Setup script creation failed during file write operation", LOG_ERROR, "LuaSetup");
-        return;
+        return false;
     }
 
     // Step 7: Success!
     log("Setup script created successfully: " + setupScript, LOG_INFO, "LuaSetup");
-    log("Script size: " + std::to_string(luaContent.length()) + " bytes", LOG_DEBUG, "LuaSetup");
+    LOG_AT(LOG_DEBUG, "LuaSetup", "Script size: ", luaContent.length(), " bytes");
     log("Lua module loader is ready for operation", LOG_INFO, "LuaSetup");
+    return true;
 }
\ No newline at end of file
@@ -7,4 +7,6 @@
 #include <string>
 #include "ConfigParser.h"
 
-void createWorkingSetupScript(const LoaderConfig& config);
\ No newline at end of file
+// Returns true when the setup script was written successfully. sessionFile is
+// the launch session file (getSessionFilePath) the script reads and waits on.
+bool createWorkingSetupScript(const LoaderConfig& config, const std::string& sessionFile);
\ No newline at end of file
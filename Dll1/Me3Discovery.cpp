@@ -0,0 +1,240 @@
+// =============================================
+// File: Me3Discovery.cpp
+// Category: Startup Fast Path
+// Purpose: Implements stat-validated caching of the .me3 directory scan.
+// =============================================
+#include "Me3Discovery.h"
+#include "Logger.h"
+#include "StartupProfiler.h"
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* CACHE_HEADER = "LuaLoaderMe3Discovery 1";
+
+    bool stampsMatch(const PathStamp& recorded, const PathStamp& current) {
+        return recorded.present == current.present &&
+            recorded.size == current.size &&
+            recorded.mtime == current.mtime;
+    }
+
+    // Line format: "key<TAB>present size mtime<TAB>path"
+    void writeLine(std::ostream& out, const char* key, const PathStamp& stamp) {
+        out << key << '\t' << (stamp.present ? 1 : 0) << ' ' << stamp.size << ' ' << stamp.mtime << '\t' << stamp.path << '\n';
+    }
+
+    bool parseLine(const std::string& line, std::string& key, PathStamp& stamp) {
+        size_t firstTab = line.find('\t');
+        size_t secondTab = firstTab == std::string::npos ? std::string::npos : line.find('\t', firstTab + 1);
+        if (secondTab == std::string::npos) {
+            return false;
+        }
+
+        key = line.substr(0, firstTab);
+        std::istringstream fields(line.substr(firstTab + 1, secondTab - firstTab - 1));
+        int present = 0;
+        if (!(fields >> present >> stamp.size >> stamp.mtime)) {
+            return false;
+        }
+        stamp.present = present != 0;
+        stamp.path = line.substr(secondTab + 1);
+        return true;
+    }
+}
+
+std::string getMe3DiscoveryCachePath(const std::string& dllPath) {
+    return fs::path(dllPath).replace_extension(".discovery").string();
+}
+
+std::vector<fs::path> getMe3SearchPaths(const fs::path& dllPath) {
+    std::vector<fs::path> searchPaths = {
+        dllPath.parent_path(),
+        dllPath.parent_path().parent_path(),
+        dllPath.parent_path().parent_path().parent_path(),
+    };
+
+    std::error_code ec;
+    fs::path currentDir = fs::current_path(ec);
+    if (!ec) {
+        searchPaths.push_back(currentDir);
+    }
+    searchPaths.push_back(fs::path("C:/"));
+    return searchPaths;
+}
+
+PathStamp stampPath(const std::string& path) {
+    PathStamp stamp;
+    stamp.path = path;
+
+    std::error_code ec;
+    auto writeTime = pfs::last_write_time(path, ec);
+    if (ec) {
+        return stamp;
+    }
+    stamp.present = true;
+    stamp.mtime = static_cast<long long>(writeTime.time_since_epoch().count());
+
+    if (!pfs::is_directory(path)) {
+        stamp.size = pfs::file_size(path, ec);
+        if (ec) {
+            stamp.size = 0;
+        }
+    }
+    return stamp;
+}
+
+std::vector<PathStamp> stampSearchDirectories(const std::string& dllPath, const std::vector<fs::path>& searchPaths) {
+    std::string cachePath = getMe3DiscoveryCachePath(dllPath);
+    std::error_code ec;
+    if (!pfs::exists(cachePath, ec)) {
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        std::ofstream create(cachePath, std::ios::binary | std::ios::app);
+    }
+
+    std::vector<PathStamp> stamps;
+    stamps.reserve(searchPaths.size());
+    for (const auto& dir : searchPaths) {
+        stamps.push_back(stampPath(dir.string()));
+    }
+    return stamps;
+}
+
+fs::path scanForMe3(const std::vector<fs::path>& searchPaths, const std::vector<PathStamp>& dirStamps, Me3Discovery& discovery) {
+    for (size_t i = 0; i < searchPaths.size(); ++i) {
+        const fs::path& dir = searchPaths[i];
+        LOG_AT(LOG_TRACE, "Me3Discovery", "Searching: ", dir.string());
+        discovery.searchedDirs.push_back(dirStamps[i]);
+
+        try {
+            if (!pfs::exists(dir) || !pfs::is_directory(dir)) {
+                continue;
+            }
+
+            StartupProfiler::count(StartupProfiler::FS_OPEN);
+            for (const auto& entry : fs::directory_iterator(dir)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".me3") {
+                    LOG_AT(LOG_DEBUG, "Me3Discovery", "Found .me3 file: ", entry.path().filename().string());
+                    return entry.path();
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            LOG_AT(LOG_TRACE, "Me3Discovery", "Cannot access directory ", dir.string(), ": ", e.what());
+        }
+    }
+    return fs::path();
+}
+
+bool loadMe3Discovery(const std::string& dllPath, const std::vector<fs::path>& searchPaths, Me3Discovery& out) {
+    std::string cachePath = getMe3DiscoveryCachePath(dllPath);
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != CACHE_HEADER) {
+        return false;
+    }
+
+    Me3Discovery discovery;
+    bool keyMatches = false;
+    while (std::getline(in, line)) {
+        StartupProfiler::count(StartupProfiler::FS_READ_BYTES, line.size() + 1);
+        std::string key;
+        PathStamp stamp;
+        if (!parseLine(line, key, stamp)) {
+            return false;
+        }
+
+        if (key == "dll") {
+            keyMatches = stamp.path == dllPath;
+        }
+        else if (key == "me3") {
+            discovery.me3Path = stamp.path;
+            discovery.me3Stamp = stamp;
+        }
+        else if (key == "config") {
+            discovery.configPath = stamp.path;
+        }
+        else if (key == "dir") {
+            discovery.searchedDirs.push_back(stamp);
+        }
+    }
+
+    if (!keyMatches || discovery.me3Path.empty() || discovery.configPath.empty()) {
+        return false;
+    }
+    if (discovery.searchedDirs.empty() || discovery.searchedDirs.size() > searchPaths.size()) {
+        return false;
+    }
+
+    // Any entry added, removed or renamed in a scanned directory changes its
+    // write time, so matching stamps mean the scan would find the same .me3
+    for (size_t i = 0; i < discovery.searchedDirs.size(); ++i) {
+        const PathStamp& recorded = discovery.searchedDirs[i];
+        if (recorded.path != searchPaths[i].string()) {
+            LOG_AT(LOG_DEBUG, "Me3Discovery", "Search path changed: ", searchPaths[i].string());
+            return false;
+        }
+        if (!stampsMatch(recorded, stampPath(recorded.path))) {
+            LOG_AT(LOG_DEBUG, "Me3Discovery", "Directory changed since last scan: ", recorded.path);
+            return false;
+        }
+    }
+
+    // The TOML override lives inside the .me3, so an edited .me3 needs a fresh parse
+    PathStamp me3Now = stampPath(discovery.me3Path);
+    if (!me3Now.present || !stampsMatch(discovery.me3Stamp, me3Now)) {
+        LOG_AT(LOG_DEBUG, "Me3Discovery", ".me3 file changed since last scan: ", discovery.me3Path);
+        return false;
+    }
+
+    out = discovery;
+    return true;
+}
+
+bool saveMe3Discovery(const std::string& dllPath, const Me3Discovery& discovery) {
+    std::string cachePath = getMe3DiscoveryCachePath(dllPath);
+
+    std::ostringstream content;
+    content << CACHE_HEADER << '\n';
+    PathStamp dllKey;
+    dllKey.path = dllPath;
+    dllKey.present = true;
+    writeLine(content, "dll", dllKey);
+    writeLine(content, "me3", discovery.me3Stamp);
+    PathStamp config;
+    config.path = discovery.configPath;
+    config.present = true;
+    writeLine(content, "config", config);
+    for (const auto& dir : discovery.searchedDirs) {
+        writeLine(content, "dir", dir);
+    }
+
+    // Rewritten in place: a temp file + rename would itself change the DLL directory's stamp
+    std::string data = content.str();
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    std::ofstream out(cachePath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        LOG_AT(LOG_DEBUG, "Me3Discovery", "Cannot write discovery cache: ", cachePath);
+        return false;
+    }
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    StartupProfiler::count(StartupProfiler::FS_WRITE_BYTES, data.size());
+    out.close();
+
+    LOG_AT(LOG_DEBUG, "Me3Discovery", "Discovery cache recorded: ", cachePath);
+    return !out.fail();
+}
+
+void invalidateMe3Discovery(const std::string& dllPath) {
+    if (dllPath.empty()) {
+        return;
+    }
+    std::error_code ec;
+    fs::remove(getMe3DiscoveryCachePath(dllPath), ec);
+}
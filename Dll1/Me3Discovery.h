@@ -0,0 +1,53 @@
+// =============================================
+// File: Me3Discovery.h
+// Category: Startup Fast Path
+// Purpose: Declares the cached .me3/TOML discovery keyed by the loader DLL path.
+// =============================================
+#pragma once
+#include <string>
+#include <vector>
+#include <filesystem>
+
+// Existence and last write time of a path at the moment it was checked
+struct PathStamp {
+    std::string path;
+    bool present = false;
+    std::uintmax_t size = 0;
+    long long mtime = 0;
+};
+
+struct Me3Discovery {
+    std::string me3Path;
+    std::string configPath;
+    PathStamp me3Stamp;
+    // Directories scanned up to and including the one holding the .me3
+    std::vector<PathStamp> searchedDirs;
+};
+
+// Path of the cache file (<dll directory>/<dll name>.discovery)
+std::string getMe3DiscoveryCachePath(const std::string& dllPath);
+
+// Directories searched for a .me3 file, in priority order
+std::vector<std::filesystem::path> getMe3SearchPaths(const std::filesystem::path& dllPath);
+
+// Stamps the search directories before a scan so that changes made during the
+// scan invalidate the result. Creates the cache file first, since adding it to
+// the DLL directory would otherwise change that directory's stamp.
+std::vector<PathStamp> stampSearchDirectories(const std::string& dllPath, const std::vector<std::filesystem::path>& searchPaths);
+
+// Enumerates the search directories in order and returns the first .me3 found (empty
+// if none). Each directory scanned is recorded in discovery.searchedDirs with its
+// stamp from dirStamps.
+std::filesystem::path scanForMe3(const std::vector<std::filesystem::path>& searchPaths, const std::vector<PathStamp>& dirStamps, Me3Discovery& discovery);
+
+// Stamps a single file or directory
+PathStamp stampPath(const std::string& path);
+
+// True when the cache was written for this DLL and every recorded stamp still matches
+bool loadMe3Discovery(const std::string& dllPath, const std::vector<std::filesystem::path>& searchPaths, Me3Discovery& out);
+
+// Stores a successful discovery for the next launch
+bool saveMe3Discovery(const std::string& dllPath, const Me3Discovery& discovery);
+
+// Removes the cache so the next launch rescans
+void invalidateMe3Discovery(const std::string& dllPath);
@@ -0,0 +1,198 @@
+// =============================================
+// File: Me3Document.cpp
+// Category: ME3 File Utilities
+// Purpose: Implements single-read .me3 lookup and minimal in-place patching.
+// =============================================
+#include "Me3Document.h"
+#include "FileIO.h"
+#include "StartupProfiler.h"
+#include <fstream>
+
+namespace {
+    bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // Shrinks [start, end) past surrounding blanks
+    void trimRange(std::string_view text, size_t& start, size_t& end) {
+        while (start < end && isBlank(text[start])) ++start;
+        while (end > start && isBlank(text[end - 1])) --end;
+    }
+
+    bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            char x = (a[i] >= 'A' && a[i] <= 'Z') ? static_cast<char>(a[i] - 'A' + 'a') : a[i];
+            char y = (b[i] >= 'A' && b[i] <= 'Z') ? static_cast<char>(b[i] - 'A' + 'a') : b[i];
+            if (x != y) return false;
+        }
+        return true;
+    }
+}
+
+bool Me3Document::load(const std::string& path) {
+    path_ = path;
+    buffer_.clear();
+    edits_.clear();
+    loaded_ = false;
+
+    StartupProfiler::count(StartupProfiler::FS_OPEN);
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::streamoff size = in.tellg();
+    if (size < 0) {
+        return false;
+    }
+    buffer_.resize(static_cast<size_t>(size));
+    in.seekg(0);
+    if (size > 0 && !in.read(&buffer_[0], size)) {
+        return false;
+    }
+    StartupProfiler::count(StartupProfiler::FS_READ_BYTES, buffer_.size());
+
+    index();
+    loaded_ = true;
+    return true;
+}
+
+void Me3Document::index() {
+    entries_.clear();
+    std::string_view text(buffer_);
+
+    size_t firstNewline = text.find('\n');
+    if (firstNewline != std::string_view::npos) {
+        newline_ = (firstNewline > 0 && text[firstNewline - 1] == '\r') ? "\r\n" : "\n";
+    }
+
+    for (size_t lineStart = 0; lineStart < text.size();) {
+        size_t newline = text.find('\n', lineStart);
+        size_t lineEnd = newline == std::string_view::npos ? text.size() : newline + 1;
+        size_t contentEnd = newline == std::string_view::npos ? text.size() : newline;
+
+        // The first '=' and the comment start, ignoring both inside quotes
+        size_t eq = std::string_view::npos;
+        size_t commentStart = contentEnd;
+        char quoteChar = '\0';
+        for (size_t i = lineStart; i < contentEnd; ++i) {
+            char c = text[i];
+            if (quoteChar != '\0') {
+                if (c == quoteChar) quoteChar = '\0';
+            }
+            else if (c == '"' || c == '\'') quoteChar = c;
+            else if (c == '#') {
+                commentStart = i;
+                break;
+            }
+            else if (c == '=' && eq == std::string_view::npos) eq = i;
+        }
+
+        if (eq != std::string_view::npos) {
+            Entry entry;
+            entry.lineStart = lineStart;
+            entry.lineEnd = lineEnd;
+            size_t keyStart = lineStart, keyEnd = eq;
+            size_t valueStart = eq + 1, valueEnd = commentStart;
+            trimRange(text, keyStart, keyEnd);
+            trimRange(text, valueStart, valueEnd);
+            entry.keyStart = keyStart;
+            entry.keyLength = keyEnd - keyStart;
+            entry.valueStart = valueStart;
+            entry.valueLength = valueEnd - valueStart;
+            if (entry.keyLength > 0) {
+                entries_.push_back(entry);
+            }
+        }
+        lineStart = lineEnd;
+    }
+}
+
+bool Me3Document::find(std::string_view key, std::string_view& outValue) const {
+    for (const auto& entry : entries_) {
+        if (this->key(entry) != key) continue;
+
+        std::string_view value = std::string_view(buffer_).substr(entry.valueStart, entry.valueLength);
+        if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+            value = value.substr(1, value.size() - 2);
+        }
+        outValue = value;
+        return true;
+    }
+    return false;
+}
+
+Me3Placement Me3Document::setConfigPath(std::string_view value) {
+    edits_.clear();
+    std::string quoted = "\"" + std::string(value) + "\"";
+
+    // Rewrite only the value of the first entry and drop any repeats
+    bool replaced = false;
+    for (const auto& entry : entries_) {
+        if (key(entry) != ME3_CONFIG_PATH_KEY) continue;
+        if (!replaced) {
+            edits_.push_back(Edit{ entry.valueStart, entry.valueLength, quoted });
+            replaced = true;
+        }
+        else {
+            edits_.push_back(Edit{ entry.lineStart, entry.lineEnd - entry.lineStart, std::string() });
+        }
+    }
+    if (replaced) {
+        return Me3Placement::Replaced;
+    }
+
+    std::string entryLine = std::string(ME3_CONFIG_PATH_KEY) + " = " + quoted;
+    for (const auto& entry : entries_) {
+        if (!equalsIgnoreCase(key(entry), "profileVersion")) continue;
+
+        std::string text;
+        if (buffer_[entry.lineEnd - 1] != '\n') text += newline_;
+        text += newline_ + "# LuaLoader Configuration (relative path for portability)" + newline_ + entryLine + newline_ + newline_;
+        edits_.push_back(Edit{ entry.lineEnd, 0, std::move(text) });
+        return Me3Placement::AfterProfileVersion;
+    }
+
+    std::string text;
+    if (!buffer_.empty() && buffer_.back() != '\n') text += newline_;
+    text += newline_ + "# --- Added by LuaLoader ---" + newline_ + entryLine + newline_;
+    edits_.push_back(Edit{ buffer_.size(), 0, std::move(text) });
+    return Me3Placement::AppendedAtEnd;
+}
+
+bool Me3Document::save(std::string& outError) {
+    if (!loaded_) {
+        outError = "Document is not loaded";
+        return false;
+    }
+
+    // Unchanged ranges go straight from the buffer, between the edited ones
+    std::string_view original(buffer_);
+    AtomicFileWriter writer(path_);
+    bool ok = writer.open();
+    size_t pos = 0;
+    for (const auto& edit : edits_) {
+        ok = ok && writer.write(original.substr(pos, edit.offset - pos)) && writer.write(edit.text);
+        pos = edit.offset + edit.length;
+    }
+    ok = ok && writer.write(original.substr(pos)) && writer.commit();
+    if (!ok) {
+        outError = writer.lastError();
+        return false;
+    }
+
+    // Keep the document in step with the file it was saved to
+    std::string updated;
+    updated.reserve(buffer_.size() + 128);
+    pos = 0;
+    for (const auto& edit : edits_) {
+        updated.append(original.substr(pos, edit.offset - pos));
+        updated.append(edit.text);
+        pos = edit.offset + edit.length;
+    }
+    updated.append(original.substr(pos));
+    buffer_.swap(updated);
+    edits_.clear();
+    index();
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+// =============================================
+// File: Me3Document.h
+// Category: ME3 File Utilities
+// Purpose: Declares the single-read .me3 document with in-place, byte-range edits.
+// =============================================
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Key the loader stores the TOML location under
+constexpr std::string_view ME3_CONFIG_PATH_KEY = "luaLoaderConfigPath";
+
+// Where setConfigPath put the entry
+enum class Me3Placement {
+    Replaced,               // An existing line's value was rewritten
+    AfterProfileVersion,
+    AppendedAtEnd,          // No profileVersion line to anchor to
+};
+
+// A .me3 file read with one read into one buffer. Every "key = value" line is
+// indexed once; lookups return views into the buffer. Edits are byte ranges
+// applied when saving, so every line the loader does not touch keeps its
+// exact bytes (comments, spacing, line endings).
+class Me3Document {
+public:
+    bool load(const std::string& path);
+    bool isLoaded() const { return loaded_; }
+    const std::string& path() const { return path_; }
+
+    // Unquoted value of the first "key = value" line (comments ignored, any
+    // table); false when the key does not appear
+    bool find(std::string_view key, std::string_view& outValue) const;
+
+    // Points luaLoaderConfigPath at value. An existing line keeps its place
+    // and formatting and only its value changes; later duplicates are
+    // removed. Otherwise a commented entry goes after the profileVersion
+    // line, or at the end of the file. Replaces any earlier pending edit.
+    Me3Placement setConfigPath(std::string_view value);
+
+    bool isModified() const { return !edits_.empty(); }
+
+    // Writes the document with its edits through an atomic replace
+    bool save(std::string& outError);
+
+private:
+    // One "key = value" line; offsets into buffer_
+    struct Entry {
+        size_t lineStart = 0;
+        size_t lineEnd = 0;         // Past the line's newline
+        size_t keyStart = 0;
+        size_t keyLength = 0;
+        size_t valueStart = 0;      // Trimmed value, quotes included
+        size_t valueLength = 0;
+    };
+
+    // Replaces buffer_[offset, offset + length) with text
+    struct Edit {
+        size_t offset = 0;
+        size_t length = 0;
+        std::string text;
+    };
+
+    void index();
+    std::string_view key(const Entry& entry) const { return std::string_view(buffer_).substr(entry.keyStart, entry.keyLength); }
+
+    std::string path_;
+    std::string buffer_;
+    std::string newline_ = "\r\n";  // The file's own line ending
+    std::vector<Entry> entries_;
+    std::vector<Edit> edits_;       // Sorted by offset, never overlapping
+    bool loaded_ = false;
+};
\ No newline at end of file
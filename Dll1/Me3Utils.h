@@ -4,8 +4,11 @@
 // Purpose: Declarations for .me3 file manipulation functions.
 // =============================================
 #pragma once
+#include "Me3Document.h"
 #include <string>
 
-std::string toLower(const std::string& str);
 std::string makePathRelative(const std::string& me3Path, const std::string& tomlPath);  // ADDED
-void injectTomlPathToMe3(const std::string& me3Path, const std::string& tomlPath);
\ No newline at end of file
+
+// Points the loaded .me3's luaLoaderConfigPath at tomlPath (stored relative
+// to the .me3) and saves it
+void injectTomlPathToMe3(Me3Document& me3, const std::string& tomlPath);
\ No newline at end of file
@@ -0,0 +1,122 @@
+// =============================================
+// File: ModuleManifest.cpp
+// Category: Lua Setup Script Generation
+// Purpose: Enumerates Lua modules once in the DLL so the setup script never shells out.
+// =============================================
+#include "ModuleManifest.h"
+#include "Logger.h"
+#include "StartupProfiler.h"
+#include "ContentHash.h"
+#include "FileIO.h"
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+std::string quoteLuaString(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+        switch (c) {
+        case '\\': quoted += "\\\\"; break;
+        case '"': quoted += "\\\""; break;
+        case '\n': quoted += "\\n"; break;
+        case '\r': quoted += "\\r"; break;
+        default: quoted += c; break;
+        }
+    }
+    quoted += "\"";
+    return quoted;
+}
+
+std::vector<ModuleEntry> scanModuleDirectory(const std::string& modulePath) {
+    std::vector<ModuleEntry> modules;
+    if (modulePath.empty()) {
+        return modules;
+    }
+
+    try {
+        std::error_code ec;
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        for (const auto& entry : fs::directory_iterator(modulePath, ec)) {
+            if (!entry.is_regular_file(ec) || entry.path().extension() != ".lua") {
+                continue;
+            }
+
+            ModuleEntry module;
+            module.name = entry.path().stem().string();
+            if (module.name == "module_loader_setup") {
+                continue;
+            }
+
+            module.size = entry.file_size(ec);
+            auto writeTime = entry.last_write_time(ec);
+            // Full resolution: a same-size edit within the same second still changes it
+            module.mtime = static_cast<long long>(writeTime.time_since_epoch().count());
+            modules.push_back(std::move(module));
+        }
+        if (ec) {
+            log("Module directory scan incomplete: " + ec.message(), LOG_WARNING, "ModuleManifest");
+        }
+    }
+    catch (const std::exception& e) {
+        log("Failed to scan module directory: " + std::string(e.what()), LOG_WARNING, "ModuleManifest");
+    }
+
+    // Deterministic order keeps the generated script stable between launches
+    std::sort(modules.begin(), modules.end(),
+        [](const ModuleEntry& a, const ModuleEntry& b) { return a.name < b.name; });
+
+    LOG_AT(LOG_DEBUG, "ModuleManifest", "Module manifest contains ", modules.size(), " modules");
+    return modules;
+}
+
+std::string formatManifestAsLua(const std::vector<ModuleEntry>& modules) {
+    std::string lua = "{\n";
+    for (const auto& module : modules) {
+        lua += "    { name = " + quoteLuaString(module.name) +
+            ", size = " + std::to_string(module.size) +
+            ", mtime = " + std::to_string(module.mtime) + " },\n";
+    }
+    lua += "}";
+    return lua;
+}
+
+std::string computeModuleListingStamp(const std::vector<ModuleEntry>& modules) {
+    std::string listing = formatManifestAsLua(modules);
+    return toHexString(hashBuffer(listing.data(), listing.size()));
+}
+
+std::string getModuleIndexPath(const std::string& modulePath) {
+    return modulePath + "/_module_loader/module_index.txt";
+}
+
+bool writeModuleIndex(const std::string& modulePath, const std::vector<ModuleEntry>& modules) {
+    const std::string indexPath = getModuleIndexPath(modulePath);
+    const std::string stampLine = "STAMP:" + computeModuleListingStamp(modules);
+
+    // Unchanged listing: leave the file (and its timestamp) alone
+    {
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        std::ifstream in(indexPath);
+        std::string firstLine;
+        if (in.is_open() && std::getline(in, firstLine) && firstLine == stampLine) {
+            return true;
+        }
+    }
+
+    std::string content = stampLine + "\n";
+    for (const auto& module : modules) {
+        content += module.name + "\n";
+    }
+
+    // Only a hint for the script: a lost index just means the size checks run
+    std::string error;
+    if (!writeFileAtomic(indexPath, content, FsyncPolicy::Never, error)) {
+        log("Failed to write module index: " + error, LOG_WARNING, "ModuleManifest");
+        return false;
+    }
+    LOG_AT(LOG_DEBUG, "ModuleManifest", "Module index updated (", modules.size(), " modules)");
+    return true;
+}
@@ -0,0 +1,36 @@
+// =============================================
+// File: ModuleManifest.h
+// Category: Lua Setup Script Generation
+// Purpose: Declares module directory enumeration baked into the setup script.
+// =============================================
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct ModuleEntry {
+    std::string name;       // Module name without the .lua extension
+    std::uintmax_t size = 0;
+    long long mtime = 0;    // Last write time in file clock ticks (100 ns on Windows)
+};
+
+// Lists the *.lua modules directly inside modulePath, sorted by name
+std::vector<ModuleEntry> scanModuleDirectory(const std::string& modulePath);
+
+// Quotes a string as a Lua string literal
+std::string quoteLuaString(const std::string& value);
+
+// Renders the manifest as a Lua table constructor for the setup script
+std::string formatManifestAsLua(const std::vector<ModuleEntry>& modules);
+
+
+// Hash of the listing (names, sizes, mtimes); changes when a module is added,
+// removed or rewritten
+std::string computeModuleListingStamp(const std::vector<ModuleEntry>& modules);
+
+// _module_loader/module_index.txt: "STAMP:<stamp>", then one module name per
+// line. The setup script compares the stamp with the one baked into it.
+std::string getModuleIndexPath(const std::string& modulePath);
+
+// Writes the index for modules unless it already carries their stamp
+bool writeModuleIndex(const std::string& modulePath, const std::vector<ModuleEntry>& modules);
@@ -0,0 +1,157 @@
+// =============================================
+// File: ModulePolicy.cpp
+// Category: Config Parsing
+// Purpose: Compiles per-module TOML tables into flat arrays with an O(1) name index.
+// =============================================
+#include "ModulePolicy.h"
+#include "ModuleManifest.h"
+
+namespace {
+    // FNV-1a; module names are short and the index only needs a good spread
+    std::uint32_t hashName(std::string_view name) {
+        std::uint32_t hash = 2166136261u;
+        for (char c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    size_t slotCountFor(size_t modules) {
+        size_t slots = 8;
+        while (slots < modules * 2) slots <<= 1;
+        return slots;
+    }
+}
+
+std::shared_ptr<const ModulePolicyTable> ModulePolicyTable::none() {
+    static const std::shared_ptr<const ModulePolicyTable> empty = std::make_shared<const ModulePolicyTable>();
+    return empty;
+}
+
+ModulePolicyTable::Span ModulePolicyTable::intern(std::string_view text) {
+    Span span;
+    span.offset = static_cast<std::uint32_t>(strings_.size());
+    span.length = static_cast<std::uint32_t>(text.size());
+    strings_.append(text);
+    return span;
+}
+
+ModulePolicyTable::ModuleId ModulePolicyTable::find(std::string_view name) const {
+    if (slots_.empty()) {
+        return NO_MODULE;
+    }
+    std::uint32_t hash = hashName(name);
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        ModuleId id = slots_[slot];
+        if (id == NO_MODULE) {
+            return NO_MODULE;
+        }
+        if (nameHashes_[id] == hash && view(names_[id]) == name) {
+            return id;
+        }
+    }
+}
+
+bool ModulePolicyTable::isEnabled(std::string_view name) const {
+    ModuleId id = find(name);
+    return id == NO_MODULE || enabled(id);
+}
+
+bool ModulePolicyTable::operator==(const ModulePolicyTable& other) const {
+    // Tables are compiled in name order, so equal settings give equal arrays
+    if (strings_ != other.strings_ || flags_ != other.flags_ || priorities_ != other.priorities_ ||
+        envStart_ != other.envStart_ || names_.size() != other.names_.size() || env_.size() != other.env_.size()) {
+        return false;
+    }
+    auto sameSpan = [](Span a, Span b) { return a.offset == b.offset && a.length == b.length; };
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (!sameSpan(names_[i], other.names_[i])) return false;
+    }
+    for (size_t i = 0; i < env_.size(); ++i) {
+        if (!sameSpan(env_[i].key, other.env_[i].key) || !sameSpan(env_[i].value, other.env_[i].value)) return false;
+    }
+    return true;
+}
+
+ModuleSettings& ModulePolicyBuilder::module(std::string_view name) {
+    auto it = modules_.find(name);
+    if (it == modules_.end()) {
+        it = modules_.emplace(std::string(name), ModuleSettings()).first;
+    }
+    return it->second;
+}
+
+std::shared_ptr<const ModulePolicyTable> ModulePolicyBuilder::compile() const {
+    if (modules_.empty()) {
+        return ModulePolicyTable::none();
+    }
+
+    auto table = std::make_shared<ModulePolicyTable>();
+    size_t count = modules_.size();
+    table->names_.reserve(count);
+    table->nameHashes_.reserve(count);
+    table->flags_.reserve(count);
+    table->priorities_.reserve(count);
+    table->envStart_.reserve(count + 1);
+
+    for (const auto& [name, settings] : modules_) {
+        table->names_.push_back(table->intern(name));
+        table->nameHashes_.push_back(hashName(name));
+
+        std::uint8_t flags = 0;
+        if (settings.enabled) flags |= ModulePolicyTable::FLAG_ENABLED;
+        if (settings.lazy) flags |= ModulePolicyTable::FLAG_LAZY;
+        table->flags_.push_back(flags);
+        table->priorities_.push_back(settings.priority);
+
+        table->envStart_.push_back(static_cast<std::uint32_t>(table->env_.size()));
+        for (const auto& [key, value] : settings.env) {
+            ModulePolicyTable::EnvSpan entry;
+            entry.key = table->intern(key);
+            entry.value = table->intern(value);
+            table->env_.push_back(entry);
+        }
+    }
+    table->envStart_.push_back(static_cast<std::uint32_t>(table->env_.size()));
+
+    // At most half full, so probes stay short
+    table->slots_.assign(slotCountFor(count), ModulePolicyTable::NO_MODULE);
+    size_t mask = table->slots_.size() - 1;
+    for (ModulePolicyTable::ModuleId id = 0; id < count; ++id) {
+        size_t slot = table->nameHashes_[id] & mask;
+        while (table->slots_[slot] != ModulePolicyTable::NO_MODULE) {
+            slot = (slot + 1) & mask;
+        }
+        table->slots_[slot] = id;
+    }
+    return table;
+}
+
+std::string formatModulePolicyAsLua(const ModulePolicyTable& policy) {
+    // Lua arrays are 1-based: module ID n is entry n + 1
+    std::string ids = "local MODULE_IDS = {\n";
+    std::string enabled = "local MODULE_ENABLED = {";
+    std::string priority = "local MODULE_PRIORITY = {";
+    std::string lazy = "local MODULE_LAZY = {";
+    std::string env = "local MODULE_ENV = {\n";
+
+    for (ModulePolicyTable::ModuleId id = 0; id < policy.size(); ++id) {
+        const char* separator = id == 0 ? " " : ", ";
+        ids += "    [" + quoteLuaString(std::string(policy.name(id))) + "] = " + std::to_string(id + 1) + ",\n";
+        enabled += separator + std::string(policy.enabled(id) ? "true" : "false");
+        priority += separator + std::to_string(policy.priority(id));
+        lazy += separator + std::string(policy.lazy(id) ? "true" : "false");
+
+        env += "    {";
+        for (size_t i = 0; i < policy.envCount(id); ++i) {
+            env += " [" + quoteLuaString(std::string(policy.envKey(id, i))) + "] = " +
+                quoteLuaString(std::string(policy.envValue(id, i))) + ",";
+        }
+        env += " },\n";
+    }
+
+    const char* close = policy.empty() ? "}\n" : " }\n";
+    return ids + "}\n" + enabled + close + priority + close + lazy + close + env + "}";
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+// =============================================
+// File: ModulePolicy.h
+// Category: Config Parsing
+// Purpose: Declares per-module settings and their compiled, immutable lookup table.
+// =============================================
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <map>
+#include <cstdint>
+
+// Settings from one [modules.<name>] table in the TOML
+struct ModuleSettings {
+    bool enabled = true;
+    int priority = 0;       // Higher loads first; equal priorities load by name
+    bool lazy = false;      // Skipped at startup; require() loads it on first use
+    std::vector<std::pair<std::string, std::string>> env;   // Handed to the module via moduleEnv(name)
+};
+
+// Module settings flattened into parallel arrays indexed by module ID. IDs
+// follow module name order. Built once by ModulePolicyBuilder and never
+// changed, so configs share one instance.
+class ModulePolicyTable {
+public:
+    using ModuleId = std::uint32_t;
+    static constexpr ModuleId NO_MODULE = 0xFFFFFFFFu;
+
+    // Shared table with no modules (every module enabled, eager, priority 0)
+    static std::shared_ptr<const ModulePolicyTable> none();
+
+    size_t size() const { return names_.size(); }
+    bool empty() const { return names_.empty(); }
+
+    // O(1) name lookup; NO_MODULE when the module has no table
+    ModuleId find(std::string_view name) const;
+
+    std::string_view name(ModuleId id) const { return view(names_[id]); }
+    bool enabled(ModuleId id) const { return (flags_[id] & FLAG_ENABLED) != 0; }
+    bool lazy(ModuleId id) const { return (flags_[id] & FLAG_LAZY) != 0; }
+    int priority(ModuleId id) const { return priorities_[id]; }
+    size_t envCount(ModuleId id) const { return envStart_[id + 1] - envStart_[id]; }
+    std::string_view envKey(ModuleId id, size_t index) const { return view(env_[envStart_[id] + index].key); }
+    std::string_view envValue(ModuleId id, size_t index) const { return view(env_[envStart_[id] + index].value); }
+
+    // Modules without a table are enabled
+    bool isEnabled(std::string_view name) const;
+
+    bool operator==(const ModulePolicyTable& other) const;
+    bool operator!=(const ModulePolicyTable& other) const { return !(*this == other); }
+
+private:
+    friend class ModulePolicyBuilder;
+
+    enum : std::uint8_t {
+        FLAG_ENABLED = 1u << 0,
+        FLAG_LAZY = 1u << 1,
+    };
+
+    // A range of strings_
+    struct Span {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+
+    struct EnvSpan {
+        Span key;
+        Span value;
+    };
+
+    std::string_view view(Span span) const { return std::string_view(strings_).substr(span.offset, span.length); }
+    Span intern(std::string_view text);
+
+    std::string strings_;                   // Every name, env key and value back to back
+    std::vector<Span> names_;
+    std::vector<std::uint32_t> nameHashes_;
+    std::vector<std::uint8_t> flags_;
+    std::vector<std::int32_t> priorities_;
+    std::vector<std::uint32_t> envStart_;   // size() + 1 entries into env_
+    std::vector<EnvSpan> env_;
+    std::vector<ModuleId> slots_;           // Open-addressing index, power-of-two size
+};
+
+// Collects module tables while the TOML is read. A module named by several
+// tables keeps one entry; later keys overwrite earlier ones.
+class ModulePolicyBuilder {
+public:
+    ModuleSettings& module(std::string_view name);
+    bool empty() const { return modules_.empty(); }
+
+    std::shared_ptr<const ModulePolicyTable> compile() const;
+
+private:
+    std::map<std::string, ModuleSettings, std::less<>> modules_;
+};
+
+// Renders the table as the setup script's MODULE_* arrays (Lua statements)
+std::string formatModulePolicyAsLua(const ModulePolicyTable& policy);
\ No newline at end of file
@@ -0,0 +1,57 @@
+// =============================================
+// File: ModuleThread.cpp
+// Category: Main Loader Orchestration
+// Purpose: Implements module-pinning background threads.
+// =============================================
+#include "ModuleThread.h"
+#include "Logger.h"
+#include <windows.h>
+#include <memory>
+#include <new>
+
+namespace {
+    struct ThreadStart {
+        std::function<void()> routine;
+        HMODULE module;
+    };
+
+    DWORD WINAPI moduleThreadMain(LPVOID parameter) {
+        HMODULE module = nullptr;
+        {
+            // The routine and its captures are destroyed while the module is still held
+            std::unique_ptr<ThreadStart> start(static_cast<ThreadStart*>(parameter));
+            module = start->module;
+            try {
+                start->routine();
+            }
+            catch (const std::exception& e) {
+                log("Background thread failed: " + std::string(e.what()), LOG_ERROR, "ModuleThread");
+            }
+            catch (...) {
+                log("Background thread failed: unknown error", LOG_ERROR, "ModuleThread");
+            }
+        }
+        // Drops the reference from kernel32; if it was the last one the DLL
+        // detaches and unmaps here, with nothing of ours left to return to
+        FreeLibraryAndExitThread(module, 0);
+    }
+}
+
+bool startModuleThread(std::function<void()> routine) {
+    HMODULE module = nullptr;
+    if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&moduleThreadMain), &module)) {
+        LOG_AT(LOG_DEBUG, "ModuleThread", "Cannot take a reference on the loader module (error ", GetLastError(), ")");
+        return false;
+    }
+
+    auto* start = new (std::nothrow) ThreadStart{ std::move(routine), module };
+    HANDLE thread = start ? CreateThread(nullptr, 0, moduleThreadMain, start, 0, nullptr) : nullptr;
+    if (!thread) {
+        LOG_AT(LOG_DEBUG, "ModuleThread", "Cannot start background thread (error ", GetLastError(), ")");
+        delete start;
+        FreeLibrary(module);
+        return false;
+    }
+    CloseHandle(thread);
+    return true;
+}
@@ -0,0 +1,16 @@
+// =============================================
+// File: ModuleThread.h
+// Category: Main Loader Orchestration
+// Purpose: Declares background threads that keep the loader DLL mapped while they run.
+// =============================================
+#pragma once
+#include <functional>
+
+// Runs routine on a new thread that holds a reference on this DLL for as long
+// as it runs, and leaves through FreeLibraryAndExitThread, so no code from the
+// module is on its stack once the reference is gone. A FreeLibrary by the host
+// while such a thread runs only drops the host's reference; DLL_PROCESS_DETACH
+// comes after the last of them has exited, on that thread. Safe to call from
+// DllMain: nothing here waits on the new thread. Returns false if the thread
+// cannot start.
+bool startModuleThread(std::function<void()> routine);
@@ -0,0 +1,97 @@
+// =============================================
+// File: ModuleWatcher.cpp
+// Category: Lua Setup Script Generation
+// Purpose: Implements the module directory watcher behind module_index.txt.
+// =============================================
+#include "ModuleWatcher.h"
+#include "ModuleManifest.h"
+#include "Logger.h"
+#include "ModuleThread.h"
+#include <windows.h>
+#include <mutex>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Saves arrive in bursts (editor temp files, copying a folder of modules)
+    constexpr DWORD SETTLE_MS = 250;
+
+    std::mutex g_watcherMutex;
+    HANDLE g_stopEvent = nullptr;
+    bool g_watcherStarted = false;
+
+    void watcherMain(std::string modulePath, HANDLE change, HANDLE stopEvent) {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+
+        // The fast path reuses last launch's index; make sure it matches now
+        writeModuleIndex(modulePath, scanModuleDirectory(modulePath));
+
+        HANDLE handles[2] = { stopEvent, change };
+        for (;;) {
+            DWORD signaled = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+            if (signaled != WAIT_OBJECT_0 + 1) {
+                break;
+            }
+            if (WaitForSingleObject(stopEvent, SETTLE_MS) == WAIT_OBJECT_0) {
+                break;
+            }
+            // Re-arm before scanning, so a save during the scan triggers another pass
+            if (!FindNextChangeNotification(change)) {
+                LOG_AT(LOG_DEBUG, "ModuleWatcher", "Cannot re-arm module change notification");
+                break;
+            }
+
+            // writeModuleIndex skips the write when the listing stamp is unchanged,
+            // so the index write itself (in a subdirectory) never loops back here
+            writeModuleIndex(modulePath, scanModuleDirectory(modulePath));
+        }
+
+        FindCloseChangeNotification(change);
+        LOG_AT(LOG_DEBUG, "ModuleWatcher", "Module watcher stopped");
+    }
+}
+
+bool startModuleWatcher(const std::string& modulePath) {
+    std::lock_guard<std::mutex> lock(g_watcherMutex);
+    if (g_watcherStarted) {
+        return true;
+    }
+
+    // Only the directory itself: the index lives in _module_loader below it
+    std::wstring dir = fs::path(modulePath).wstring();
+    HANDLE change = FindFirstChangeNotificationW(dir.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+    if (change == INVALID_HANDLE_VALUE) {
+        LOG_AT(LOG_DEBUG, "ModuleWatcher", "Cannot watch module directory (error ", GetLastError(), ")");
+        return false;
+    }
+
+    // Never closed, so stopModuleWatcher cannot race the thread's exit
+    if (!g_stopEvent) {
+        g_stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    }
+    if (!g_stopEvent) {
+        FindCloseChangeNotification(change);
+        return false;
+    }
+
+    // Holds a reference on the module until it exits, like the config watcher
+    HANDLE stopEvent = g_stopEvent;
+    if (!startModuleThread([modulePath, change, stopEvent]() { watcherMain(modulePath, change, stopEvent); })) {
+        LOG_AT(LOG_DEBUG, "ModuleWatcher", "Cannot start module watcher thread");
+        FindCloseChangeNotification(change);
+        return false;
+    }
+
+    g_watcherStarted = true;
+    LOG_AT(LOG_DEBUG, "ModuleWatcher", "Watching modules for changes: ", modulePath);
+    return true;
+}
+
+void stopModuleWatcher() {
+    std::lock_guard<std::mutex> lock(g_watcherMutex);
+    if (g_stopEvent) {
+        SetEvent(g_stopEvent);
+    }
+}
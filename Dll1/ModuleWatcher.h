@@ -0,0 +1,18 @@
+// =============================================
+// File: ModuleWatcher.h
+// Category: Lua Setup Script Generation
+// Purpose: Declares the module directory watcher that keeps module_index.txt current.
+// =============================================
+#pragma once
+#include <string>
+
+// Watches the module directory on a background thread and rewrites
+// module_index.txt when a module is added, removed or saved, so a setup
+// script that runs later sees that its baked manifest is stale. The index is
+// also brought up to date once when the watch starts. Returns false if the
+// watch cannot start. The watcher thread holds a reference on the DLL until
+// it exits, so a FreeLibrary by the host leaves the DLL loaded while it runs.
+bool startModuleWatcher(const std::string& modulePath);
+
+// Signals the watcher to exit without waiting; it lets go of the DLL on its way out
+void stopModuleWatcher();
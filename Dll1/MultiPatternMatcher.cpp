@@ -0,0 +1,175 @@
+// =============================================
+// File: MultiPatternMatcher.cpp
+// Category: HKS Script Integration
+// Purpose: Implements the Aho-Corasick automaton used for injection detection.
+// =============================================
+#include "MultiPatternMatcher.h"
+#include <queue>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MPM_HAVE_SSE2 1
+#endif
+
+namespace {
+    // More distinct pairs than this and the prefilter stops paying for itself
+    constexpr size_t MAX_START_PAIRS = 8;
+}
+
+MultiPatternMatcher::MultiPatternMatcher(const std::vector<std::string>& patterns)
+    : patterns_(patterns) {
+    const uint32_t NO_STATE = UINT32_MAX;
+
+    // Build the trie
+    transitions_.assign(256, NO_STATE);
+    outputs_.emplace_back();
+    for (uint32_t index = 0; index < patterns_.size(); ++index) {
+        uint32_t state = 0;
+        for (unsigned char c : patterns_[index]) {
+            uint32_t& next = transitions_[state * 256 + c];
+            if (next == NO_STATE) {
+                next = static_cast<uint32_t>(outputs_.size());
+                outputs_.emplace_back();
+                transitions_.resize(transitions_.size() + 256, NO_STATE);
+            }
+            state = transitions_[state * 256 + c];
+        }
+        outputs_[state].push_back(index);
+    }
+
+    // Breadth-first pass turns the trie into a DFA: missing edges follow the
+    // failure link, and each state inherits the outputs of its failure state
+    std::vector<uint32_t> failure(outputs_.size(), 0);
+    std::queue<uint32_t> pending;
+    for (int c = 0; c < 256; ++c) {
+        uint32_t& next = transitions_[c];
+        if (next == NO_STATE) {
+            next = 0;
+        }
+        else {
+            failure[next] = 0;
+            pending.push(next);
+        }
+    }
+
+    while (!pending.empty()) {
+        uint32_t state = pending.front();
+        pending.pop();
+        const std::vector<uint32_t>& inherited = outputs_[failure[state]];
+        outputs_[state].insert(outputs_[state].end(), inherited.begin(), inherited.end());
+
+        for (int c = 0; c < 256; ++c) {
+            uint32_t& next = transitions_[state * 256 + c];
+            uint32_t fallback = transitions_[failure[state] * 256 + c];
+            if (next == NO_STATE) {
+                next = fallback;
+            }
+            else {
+                failure[next] = fallback;
+                pending.push(next);
+            }
+        }
+    }
+
+    // Renumber: states without outputs first (the root stays 0), then the rest
+    uint32_t stateCount = static_cast<uint32_t>(outputs_.size());
+    std::vector<uint32_t> order;
+    order.reserve(stateCount);
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        if (outputs_[state].empty()) order.push_back(state);
+    }
+    firstOutputState_ = static_cast<uint32_t>(order.size());
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        if (!outputs_[state].empty()) order.push_back(state);
+    }
+
+    std::vector<uint32_t> renamed(stateCount);
+    for (uint32_t index = 0; index < stateCount; ++index) {
+        renamed[order[index]] = index;
+    }
+
+    std::vector<uint32_t> table(transitions_.size());
+    std::vector<std::vector<uint32_t>> outputs(stateCount);
+    for (uint32_t index = 0; index < stateCount; ++index) {
+        uint32_t original = order[index];
+        for (int c = 0; c < 256; ++c) {
+            table[index * 256 + c] = renamed[transitions_[original * 256 + c]] * 256;
+        }
+        outputs[index] = std::move(outputs_[original]);
+    }
+    transitions_ = std::move(table);
+    outputs_ = std::move(outputs);
+    firstOutputState_ *= 256;
+
+    // The prefilter needs every pattern to have at least two bytes
+    usePrefilter_ = !patterns_.empty();
+    for (const auto& pattern : patterns_) {
+        if (pattern.size() < 2) {
+            usePrefilter_ = false;
+            break;
+        }
+        std::pair<unsigned char, unsigned char> pair(static_cast<unsigned char>(pattern[0]), static_cast<unsigned char>(pattern[1]));
+        if (std::find(startPairs_.begin(), startPairs_.end(), pair) == startPairs_.end()) {
+            startPairs_.push_back(pair);
+        }
+    }
+    if (startPairs_.size() > MAX_START_PAIRS) {
+        usePrefilter_ = false;
+    }
+}
+
+size_t MultiPatternMatcher::skipToCandidate(const unsigned char* bytes, size_t from, size_t size) const {
+    size_t i = from;
+#ifdef MPM_HAVE_SSE2
+    while (i + 17 <= size) {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 1));
+        __m128i hits = _mm_setzero_si128();
+        for (const auto& pair : startPairs_) {
+            __m128i a = _mm_cmpeq_epi8(first, _mm_set1_epi8(static_cast<char>(pair.first)));
+            __m128i b = _mm_cmpeq_epi8(second, _mm_set1_epi8(static_cast<char>(pair.second)));
+            hits = _mm_or_si128(hits, _mm_and_si128(a, b));
+        }
+        int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            for (int bit = 0; bit < 16; ++bit) {
+                if (mask & (1 << bit)) return i + bit;
+            }
+        }
+        i += 16;
+    }
+#endif
+    for (; i + 1 < size; ++i) {
+        for (const auto& pair : startPairs_) {
+            if (bytes[i] == pair.first && bytes[i + 1] == pair.second) return i;
+        }
+    }
+    // The final byte cannot start a match on its own, but the automaton must still see it
+    return i;
+}
+
+void MultiPatternMatcher::scan(std::string_view text, Cursor& cursor, std::vector<PatternMatch>& out) const {
+    const uint32_t* table = transitions_.data();
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t size = text.size();
+    uint32_t state = cursor.state;
+
+    for (size_t i = 0; i < size; ++i) {
+        if (state == 0 && usePrefilter_) {
+            // No partial match is pending, so no match can start before the next candidate
+            i = skipToCandidate(bytes, i, size);
+            if (i >= size) break;
+        }
+        state = table[state + bytes[i]];
+        if (state >= firstOutputState_) {
+            size_t end = cursor.offset + i + 1;
+            for (uint32_t index : outputs_[state / 256]) {
+                out.push_back({ end - patterns_[index].size(), index });
+            }
+        }
+    }
+
+    cursor.state = state;
+    cursor.offset += size;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+// =============================================
+// File: MultiPatternMatcher.h
+// Category: HKS Script Integration
+// Purpose: Declares an Aho-Corasick matcher that finds several signatures in one pass.
+// =============================================
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+struct PatternMatch {
+    size_t offset;      // Byte offset of the first character of the match
+    size_t pattern;     // Index into the pattern list given to the matcher
+};
+
+// Patterns are compiled once into a full 256-way transition table, so the
+// scan costs one table lookup per input byte regardless of pattern count
+class MultiPatternMatcher {
+public:
+    explicit MultiPatternMatcher(const std::vector<std::string>& patterns);
+
+    // Scan position carried between calls, so a buffer can be fed in pieces
+    // (e.g. a bounded header region first, then the remainder)
+    struct Cursor {
+        uint32_t state = 0;     // Premultiplied, as stored in the transition table
+        size_t offset = 0;
+    };
+
+    // Appends every match ending inside text; text must continue where the cursor left off
+    void scan(std::string_view text, Cursor& cursor, std::vector<PatternMatch>& out) const;
+
+    const std::string& pattern(size_t index) const { return patterns_[index]; }
+    size_t patternCount() const { return patterns_.size(); }
+
+private:
+    std::vector<std::string> patterns_;
+    // Indexed by (state * 256 + byte); entries hold the next state already
+    // multiplied by 256 so the scan loop is a single dependent load per byte
+    std::vector<uint32_t> transitions_;
+    // States are numbered so that every state with outputs comes last; the
+    // scan only leaves its tight loop when it reaches one of them
+    uint32_t firstOutputState_ = 0;
+    std::vector<std::vector<uint32_t>> outputs_;     // Patterns ending at each state
+
+    // Distinct first two bytes of the patterns. While the automaton is at the
+    // root, the scan skips ahead to the next position where one of them
+    // occurs, 16 bytes at a time where SSE2 is available.
+    std::vector<std::pair<unsigned char, unsigned char>> startPairs_;
+    bool usePrefilter_ = false;
+
+    size_t skipToCandidate(const unsigned char* bytes, size_t from, size_t size) const;
+};
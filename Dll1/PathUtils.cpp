@@ -6,6 +6,7 @@
 #include "PathUtils.h"
 #include "ConfigParser.h"  // Include this to get LoaderConfig definition
 #include "Logger.h"
+#include "StartupProfiler.h"
 #include <filesystem>
 #include <algorithm>
 #include <windows.h>
@@ -23,28 +24,32 @@ std::string normalizePath(const std::string& path) {
         return result;
     }
     catch (const std::exception& e) {
-        log("Path normalization failed for '" + path + "': " + std::string(e.what()), LOG_TRACE, "PathUtils");
+        LOG_AT(LOG_TRACE, "PathUtils", "Path normalization failed for '", path, "': ", e.what());
         return path;
     }
     catch (...) {
-        log("Path normalization failed for '" + path + "': unknown error", LOG_TRACE, "PathUtils");
+        LOG_AT(LOG_TRACE, "PathUtils", "Path normalization failed for '", path, "': unknown error");
         return path;
     }
 }
 
-std::string resolvePathWithFallbacks(const std::string& inputPath, const std::string& configDir) {
-    if (inputPath.empty()) return inputPath;
+std::string resolvePathWithFallbacks(const std::string& inputPath, const std::string& configDir, PathBase* outBase) {
+    auto settle = [outBase](PathBase base, std::string path) {
+        if (outBase) *outBase = base;
+        return path;
+    };
+    if (inputPath.empty()) return settle(PathBase::Fallback, inputPath);
 
-    log("Resolving path with fallbacks: " + inputPath, LOG_TRACE, "PathUtils");
-    log("Config directory base: " + configDir, LOG_TRACE, "PathUtils");
+    LOG_AT(LOG_TRACE, "PathUtils", "Resolving path with fallbacks: ", inputPath);
+    LOG_AT(LOG_TRACE, "PathUtils", "Config directory base: ", configDir);
 
     try {
         fs::path input(inputPath);
 
         // Strategy 1: If already absolute, normalize and return
         if (input.is_absolute()) {
-            log("Path is already absolute", LOG_TRACE, "PathUtils");
-            return normalizePath(input.string());
+            LOG_AT(LOG_TRACE, "PathUtils", "Path is already absolute");
+            return settle(PathBase::Absolute, normalizePath(input.string()));
         }
 
         // Strategy 2: Resolve relative to config directory
@@ -53,12 +58,12 @@ std::string resolvePathWithFallbacks(const std::string& inputPath, const std::st
         resolvedPath = resolvedPath.lexically_normal();
         std::string candidate = normalizePath(resolvedPath.string());
 
-        log("Trying config-relative path: " + candidate, LOG_TRACE, "PathUtils");
+        LOG_AT(LOG_TRACE, "PathUtils", "Trying config-relative path: ", candidate);
 
         // Verify this path makes sense (optional validation)
-        if (fs::exists(fs::path(candidate).parent_path()) || fs::exists(candidate)) {
-            log("Config-relative path exists, using: " + candidate, LOG_TRACE, "PathUtils");
-            return candidate;
+        if (pfs::exists(fs::path(candidate).parent_path()) || pfs::exists(candidate)) {
+            LOG_AT(LOG_TRACE, "PathUtils", "Config-relative path exists, using: ", candidate);
+            return settle(PathBase::ConfigDir, candidate);
         }
 
         // Strategy 3: Try relative to current working directory
@@ -66,11 +71,11 @@ std::string resolvePathWithFallbacks(const std::string& inputPath, const std::st
         cwdPath = cwdPath.lexically_normal();
         candidate = normalizePath(cwdPath.string());
 
-        log("Trying CWD-relative path: " + candidate, LOG_TRACE, "PathUtils");
+        LOG_AT(LOG_TRACE, "PathUtils", "Trying CWD-relative path: ", candidate);
 
-        if (fs::exists(fs::path(candidate).parent_path()) || fs::exists(candidate)) {
-            log("CWD-relative path exists, using: " + candidate, LOG_TRACE, "PathUtils");
-            return candidate;
+        if (pfs::exists(fs::path(candidate).parent_path()) || pfs::exists(candidate)) {
+            LOG_AT(LOG_TRACE, "PathUtils", "CWD-relative path exists, using: ", candidate);
+            return settle(PathBase::WorkingDir, candidate);
         }
 
         // Strategy 4: Try relative to executable directory
@@ -80,51 +85,57 @@ std::string resolvePathWithFallbacks(const std::string& inputPath, const std::st
             exePath = exePath.lexically_normal();
             candidate = normalizePath(exePath.string());
 
-            log("Trying executable-relative path: " + candidate, LOG_TRACE, "PathUtils");
+            LOG_AT(LOG_TRACE, "PathUtils", "Trying executable-relative path: ", candidate);
 
-            if (fs::exists(fs::path(candidate).parent_path()) || fs::exists(candidate)) {
-                log("Executable-relative path exists, using: " + candidate, LOG_TRACE, "PathUtils");
-                return candidate;
+            if (pfs::exists(fs::path(candidate).parent_path()) || pfs::exists(candidate)) {
+                LOG_AT(LOG_TRACE, "PathUtils", "Executable-relative path exists, using: ", candidate);
+                return settle(PathBase::ExecutableDir, candidate);
             }
         }
 
         // Fallback: Use config directory resolution even if parent doesn't exist
         std::string fallbackResult = normalizePath((configPath / input).lexically_normal().string());
-        log("Using config-relative fallback: " + fallbackResult, LOG_TRACE, "PathUtils");
-        return fallbackResult;
+        LOG_AT(LOG_TRACE, "PathUtils", "Using config-relative fallback: ", fallbackResult);
+        return settle(PathBase::Fallback, fallbackResult);
     }
     catch (const std::exception& e) {
         log("Path resolution failed: " + std::string(e.what()), LOG_WARNING, "PathUtils");
         // Ultimate fallback: simple concatenation
         std::string result = configDir + "/" + inputPath;
         std::replace(result.begin(), result.end(), '\\', '/');
-        log("Using simple concatenation fallback: " + result, LOG_TRACE, "PathUtils");
-        return result;
+        LOG_AT(LOG_TRACE, "PathUtils", "Using simple concatenation fallback: ", result);
+        return settle(PathBase::Fallback, result);
     }
     catch (...) {
         log("Path resolution failed: unknown error", LOG_WARNING, "PathUtils");
         // Ultimate fallback: simple concatenation
         std::string result = configDir + "/" + inputPath;
         std::replace(result.begin(), result.end(), '\\', '/');
-        log("Using simple concatenation fallback: " + result, LOG_TRACE, "PathUtils");
-        return result;
+        LOG_AT(LOG_TRACE, "PathUtils", "Using simple concatenation fallback: ", result);
+        return settle(PathBase::Fallback, result);
     }
 }
 
+bool isPathBaseCurrent(const std::string& inputPath, const std::string& configDir, PathBase base) {
+    PathBase current = PathBase::Fallback;
+    resolvePathWithFallbacks(inputPath, configDir, &current);
+    return current == base;
+}
+
 std::vector<std::string> findConfigFiles(const fs::path& searchPath, int maxDepth) {
     std::vector<std::string> configFiles;
-    if (maxDepth <= 0 || !fs::exists(searchPath)) {
-        log("Skipping config search: invalid depth or path doesn't exist: " + searchPath.string(), LOG_TRACE, "PathUtils");
+    if (maxDepth <= 0 || !pfs::exists(searchPath)) {
+        LOG_AT(LOG_TRACE, "PathUtils", "Skipping config search: invalid depth or path doesn't exist: ", searchPath.string());
         return configFiles;
     }
 
-    log("Searching for config files in: " + searchPath.string() + " (depth: " + std::to_string(maxDepth) + ")", LOG_TRACE, "PathUtils");
+    LOG_AT(LOG_TRACE, "PathUtils", "Searching for config files in: ", searchPath.string(), " (depth: ", maxDepth, ")");
 
     try {
         for (const auto& entry : fs::directory_iterator(searchPath)) {
             if (entry.is_regular_file() && entry.path().extension() == ".me3") {
                 configFiles.push_back(normalizePath(entry.path().string()));
-                log("Found .me3 config file: " + entry.path().filename().string(), LOG_DEBUG, "PathUtils");
+                LOG_AT(LOG_DEBUG, "PathUtils", "Found .me3 config file: ", entry.path().filename().string());
             }
             else if (entry.is_directory() && maxDepth > 1) {
                 auto subFiles = findConfigFiles(entry.path(), maxDepth - 1);
@@ -133,10 +144,10 @@ std::vector<std::string> findConfigFiles(const fs::path& searchPath, int maxDept
         }
     }
     catch (const std::exception& e) {
-        log("Error searching directory '" + searchPath.string() + "': " + std::string(e.what()), LOG_TRACE, "PathUtils");
+        LOG_AT(LOG_TRACE, "PathUtils", "Error searching directory '", searchPath.string(), "': ", e.what());
     }
     catch (...) {
-        log("Error searching directory '" + searchPath.string() + "': unknown error", LOG_TRACE, "PathUtils");
+        LOG_AT(LOG_TRACE, "PathUtils", "Error searching directory '", searchPath.string(), "': unknown error");
     }
 
     return configFiles;
@@ -146,18 +157,18 @@ std::vector<std::string> findConfigFiles(const fs::path& searchPath, int maxDept
 bool validatePaths(LoaderConfig& config) {
     bool allValid = true;
 
-    log("Validating configuration paths", LOG_DEBUG, "PathUtils");
+    LOG_AT(LOG_DEBUG, "PathUtils", "Validating configuration paths");
 
     // Validate gameScriptPath
     try {
-        log("Validating gameScriptPath: " + config.gameScriptPath.absolutePath, LOG_DEBUG, "PathUtils");
+        LOG_AT(LOG_DEBUG, "PathUtils", "Validating gameScriptPath: ", config.gameScriptPath.absolutePath);
 
-        if (!fs::exists(config.gameScriptPath.absolutePath)) {
-            log("Creating gameScriptPath directory: " + config.gameScriptPath.absolutePath, LOG_DEBUG, "PathUtils");
+        if (!pfs::exists(config.gameScriptPath.absolutePath)) {
+            LOG_AT(LOG_DEBUG, "PathUtils", "Creating gameScriptPath directory: ", config.gameScriptPath.absolutePath);
             fs::create_directories(config.gameScriptPath.absolutePath);
         }
 
-        if (!fs::is_directory(config.gameScriptPath.absolutePath)) {
+        if (!pfs::is_directory(config.gameScriptPath.absolutePath)) {
             log("gameScriptPath is not a directory: " + config.gameScriptPath.absolutePath, LOG_ERROR, "PathUtils");
             log("Relative path was: " + config.gameScriptPath.relativePath, LOG_ERROR, "PathUtils");
             log("Resolved from config dir: " + config.configDir, LOG_ERROR, "PathUtils");
@@ -165,8 +176,8 @@ bool validatePaths(LoaderConfig& config) {
         }
         else {
             log("Game script path validated successfully", LOG_INFO, "PathUtils");
-            log("  Relative: " + config.gameScriptPath.relativePath, LOG_DEBUG, "PathUtils");
-            log("  Absolute: " + config.gameScriptPath.absolutePath, LOG_DEBUG, "PathUtils");
+            LOG_AT(LOG_DEBUG, "PathUtils", "  Relative: ", config.gameScriptPath.relativePath);
+            LOG_AT(LOG_DEBUG, "PathUtils", "  Absolute: ", config.gameScriptPath.absolutePath);
         }
     }
     catch (const std::exception& e) {
@@ -178,21 +189,21 @@ bool validatePaths(LoaderConfig& config) {
 
     // Validate modulePath
     try {
-        log("Validating modulePath: " + config.modulePath.absolutePath, LOG_DEBUG, "PathUtils");
+        LOG_AT(LOG_DEBUG, "PathUtils", "Validating modulePath: ", config.modulePath.absolutePath);
 
-        if (!fs::exists(config.modulePath.absolutePath)) {
-            log("Creating modulePath directory: " + config.modulePath.absolutePath, LOG_DEBUG, "PathUtils");
+        if (!pfs::exists(config.modulePath.absolutePath)) {
+            LOG_AT(LOG_DEBUG, "PathUtils", "Creating modulePath directory: ", config.modulePath.absolutePath);
             fs::create_directories(config.modulePath.absolutePath);
         }
 
-        if (!fs::is_directory(config.modulePath.absolutePath)) {
+        if (!pfs::is_directory(config.modulePath.absolutePath)) {
             log("modulePath is not a directory, falling back to gameScriptPath", LOG_WARNING, "PathUtils");
             config.modulePath = config.gameScriptPath;
         }
         else {
             log("Module path validated successfully", LOG_INFO, "PathUtils");
-            log("  Relative: " + config.modulePath.relativePath, LOG_DEBUG, "PathUtils");
-            log("  Absolute: " + config.modulePath.absolutePath, LOG_DEBUG, "PathUtils");
+            LOG_AT(LOG_DEBUG, "PathUtils", "  Relative: ", config.modulePath.relativePath);
+            LOG_AT(LOG_DEBUG, "PathUtils", "  Absolute: ", config.modulePath.absolutePath);
         }
     }
     catch (const std::exception& e) {
@@ -200,6 +211,6 @@ bool validatePaths(LoaderConfig& config) {
         config.modulePath = config.gameScriptPath;
     }
 
-    log("Path validation complete. All paths valid: " + std::string(allValid ? "true" : "false"), LOG_DEBUG, "PathUtils");
+    LOG_AT(LOG_DEBUG, "PathUtils", "Path validation complete. All paths valid: ", (allValid ? "true" : "false"));
     return allValid;
 }
\ No newline at end of file
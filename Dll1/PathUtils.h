@@ -11,7 +11,22 @@
 // Forward declaration to avoid circular dependency
 struct LoaderConfig;
 
+// Which candidate resolvePathWithFallbacks settled on: the path as given, the
+// first of config dir, working dir and executable dir where it or its parent
+// exists, or the config-relative path when none does
+enum class PathBase {
+    Absolute,
+    ConfigDir,
+    WorkingDir,
+    ExecutableDir,
+    Fallback,
+};
+
 std::string normalizePath(const std::string& path);
-std::string resolvePathWithFallbacks(const std::string& inputPath, const std::string& configDir);
+std::string resolvePathWithFallbacks(const std::string& inputPath, const std::string& configDir, PathBase* outBase = nullptr);
+
+// Probes again; false when inputPath would now resolve against another base
+// (a folder was created or removed since base was recorded)
+bool isPathBaseCurrent(const std::string& inputPath, const std::string& configDir, PathBase base);
 std::vector<std::string> findConfigFiles(const std::filesystem::path& searchPath, int maxDepth = 3);
 bool validatePaths(LoaderConfig& config);
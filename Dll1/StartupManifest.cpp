@@ -0,0 +1,244 @@
+// =============================================
+// File: StartupManifest.cpp
+// Category: Startup Fast Path
+// Purpose: Implements size+mtime+hash fingerprints for the launch fast path.
+// =============================================
+#include "StartupManifest.h"
+#include "ContentHash.h"
+#include "ModuleManifest.h"
+#include "Logger.h"
+#include "StartupProfiler.h"
+#include "FileIO.h"
+#include "HksInjector.h"
+#include "FlagFile.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* MANIFEST_HEADER = "LuaLoaderStartupManifest 1";
+
+    struct Fingerprint {
+        bool present = false;
+        std::uintmax_t size = 0;
+        long long mtime = 0;
+        std::string hash;
+    };
+
+    // Stat-only fingerprint; the hash is filled in separately when needed
+    Fingerprint statFile(const std::string& path) {
+        Fingerprint fp;
+        std::error_code ec;
+        fp.size = pfs::file_size(path, ec);
+        if (ec) {
+            return fp;
+        }
+        auto writeTime = pfs::last_write_time(path, ec);
+        if (ec) {
+            return fp;
+        }
+        fp.present = true;
+        fp.mtime = static_cast<long long>(writeTime.time_since_epoch().count());
+        return fp;
+    }
+
+    Fingerprint fingerprintFile(const std::string& path) {
+        Fingerprint fp = statFile(path);
+        ContentHash hash;
+        if (fp.present && hashFile(path, hash)) {
+            fp.hash = toHexString(hash);
+        }
+        return fp;
+    }
+
+    // The listing hash covers names, sizes and mtimes of every module
+    Fingerprint fingerprintModuleListing(const std::string& modulePath) {
+        std::vector<ModuleEntry> modules = scanModuleDirectory(modulePath);
+
+        Fingerprint fp;
+        fp.present = true;
+        fp.size = modules.size();
+        fp.hash = computeModuleListingStamp(modules);
+        return fp;
+    }
+
+    // The setup script has the session file path (next to the DLL) baked in;
+    // a DLL loaded from somewhere else needs a new script
+    Fingerprint fingerprintSessionPath(const std::string& dllPath) {
+        std::string sessionFile = getSessionFilePath(dllPath);
+
+        Fingerprint fp;
+        fp.present = true;
+        fp.size = sessionFile.size();
+        fp.hash = toHexString(hashBuffer(sessionFile.data(), sessionFile.size()));
+        return fp;
+    }
+
+    // One manifest entry per injection target
+    const std::string HKS_KEY_PREFIX = "hks:";
+
+    std::string getSetupScriptPath(const LoaderConfig& config) {
+        return config.modulePath.absolutePath + "/_module_loader/module_loader_setup.lua";
+    }
+
+    // Manifest format: header line, then "key<TAB>present size mtime hash" per entry
+    bool readManifest(const std::string& path, std::map<std::string, Fingerprint>& outEntries) {
+        StartupProfiler::count(StartupProfiler::FS_OPEN);
+        std::ifstream in(path);
+        if (!in.is_open()) {
+            return false;
+        }
+
+        std::string line;
+        if (!std::getline(in, line) || line != MANIFEST_HEADER) {
+            return false;
+        }
+
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string key;
+            Fingerprint fp;
+            int present = 0;
+            if (!std::getline(fields, key, '\t') || !(fields >> present >> fp.size >> fp.mtime)) {
+                return false;
+            }
+            fields >> fp.hash;
+            fp.present = present != 0;
+            outEntries[key] = fp;
+        }
+        return true;
+    }
+
+    // Compares a file against its recorded fingerprint, hashing only when stats disagree
+    bool fileMatches(const std::string& key, const std::string& path, const std::map<std::string, Fingerprint>& recorded) {
+        auto it = recorded.find(key);
+        if (it == recorded.end()) {
+            return false;
+        }
+
+        Fingerprint current = statFile(path);
+        const Fingerprint& previous = it->second;
+        if (current.present != previous.present) {
+            return false;
+        }
+        if (!current.present) {
+            return true;
+        }
+        if (current.size != previous.size) {
+            return false;
+        }
+        if (current.mtime == previous.mtime) {
+            return true;
+        }
+
+        // Same size, new mtime: the file may only have been touched
+        ContentHash hash;
+        return !previous.hash.empty() && hashFile(path, hash) && toHexString(hash) == previous.hash;
+    }
+}
+
+std::string getStartupManifestPath(const std::string& modulePath) {
+    return modulePath + "/_module_loader/startup_manifest.txt";
+}
+
+bool isStartupUnchanged(const LoaderConfig& config, const std::string& dllPath) {
+    if (config.modulePath.absolutePath.empty() || config.gameScriptPath.absolutePath.empty()) {
+        return false;
+    }
+
+    std::map<std::string, Fingerprint> recorded;
+    if (!readManifest(getStartupManifestPath(config.modulePath.absolutePath), recorded)) {
+        LOG_AT(LOG_DEBUG, "StartupManifest", "No usable startup manifest - taking full startup path");
+        return false;
+    }
+
+    struct Check { const char* key; std::string path; };
+    const Check checks[] = {
+        { "loader", dllPath },
+        { "toml", config.configFile },
+        { "script", getSetupScriptPath(config) },
+    };
+
+    for (const auto& check : checks) {
+        if (!fileMatches(check.key, check.path, recorded)) {
+            LOG_AT(LOG_DEBUG, "StartupManifest", "Startup fingerprint changed: ", check.key);
+            return false;
+        }
+    }
+
+    // Same target set as last time (a wildcard may have picked up a new file), each unchanged
+    std::vector<std::string> targets = resolveHksTargets(config);
+    size_t recordedTargets = 0;
+    for (const auto& [key, fp] : recorded) {
+        if (key.compare(0, HKS_KEY_PREFIX.size(), HKS_KEY_PREFIX) == 0) recordedTargets++;
+    }
+    if (recordedTargets != targets.size()) {
+        LOG_AT(LOG_DEBUG, "StartupManifest", "Startup fingerprint changed: HKS target list");
+        return false;
+    }
+    for (const auto& target : targets) {
+        if (!fileMatches(HKS_KEY_PREFIX + target, target, recorded)) {
+            LOG_AT(LOG_DEBUG, "StartupManifest", "Startup fingerprint changed: ", target);
+            return false;
+        }
+    }
+
+    auto session = recorded.find("session");
+    if (session == recorded.end() || session->second.hash != fingerprintSessionPath(dllPath).hash) {
+        LOG_AT(LOG_DEBUG, "StartupManifest", "Startup fingerprint changed: session file location");
+        return false;
+    }
+
+    auto modules = recorded.find("modules");
+    if (modules == recorded.end() || modules->second.hash != fingerprintModuleListing(config.modulePath.absolutePath).hash) {
+        LOG_AT(LOG_DEBUG, "StartupManifest", "Startup fingerprint changed: modules");
+        return false;
+    }
+
+    LOG_AT(LOG_DEBUG, "StartupManifest", "All startup fingerprints match the last launch");
+    return true;
+}
+
+bool recordStartupManifest(const LoaderConfig& config, const std::string& dllPath) {
+    if (config.modulePath.absolutePath.empty()) {
+        return false;
+    }
+
+    std::map<std::string, Fingerprint> entries;
+    entries["loader"] = fingerprintFile(dllPath);
+    entries["toml"] = fingerprintFile(config.configFile);
+    for (const auto& target : resolveHksTargets(config)) {
+        entries[HKS_KEY_PREFIX + target] = fingerprintFile(target);
+    }
+    entries["script"] = fingerprintFile(getSetupScriptPath(config));
+    entries["modules"] = fingerprintModuleListing(config.modulePath.absolutePath);
+    entries["session"] = fingerprintSessionPath(dllPath);
+
+    std::string manifestPath = getStartupManifestPath(config.modulePath.absolutePath);
+    std::ostringstream out;
+    out << MANIFEST_HEADER << '\n';
+    for (const auto& [key, fp] : entries) {
+        out << key << '\t' << (fp.present ? 1 : 0) << ' ' << fp.size << ' ' << fp.mtime << ' ' << fp.hash << '\n';
+    }
+
+    // Only a hint for the next launch; a lost update just means a full startup
+    std::string error;
+    if (!writeFileAtomic(manifestPath, out.str(), FsyncPolicy::Never, error)) {
+        log("Cannot write startup manifest: " + manifestPath + " (" + error + ")", LOG_WARNING, "StartupManifest");
+        return false;
+    }
+
+    LOG_AT(LOG_DEBUG, "StartupManifest", "Startup manifest recorded: ", manifestPath);
+    return true;
+}
+
+void invalidateStartupManifest(const std::string& modulePath) {
+    if (modulePath.empty()) {
+        return;
+    }
+    std::error_code ec;
+    fs::remove(getStartupManifestPath(modulePath), ec);
+}
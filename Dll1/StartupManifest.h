@@ -0,0 +1,21 @@
+// =============================================
+// File: StartupManifest.h
+// Category: Startup Fast Path
+// Purpose: Declares fingerprinting of launch inputs/outputs to skip unchanged startups.
+// =============================================
+#pragma once
+#include "ConfigParser.h"
+#include <string>
+
+// Path of the manifest (<modulePath>/_module_loader/startup_manifest.txt)
+std::string getStartupManifestPath(const std::string& modulePath);
+
+// True when the TOML, HKS, module listing, setup script and loader DLL all
+// match the fingerprints recorded by the last complete launch
+bool isStartupUnchanged(const LoaderConfig& config, const std::string& dllPath);
+
+// Records fingerprints after a launch has written the setup script and injected the HKS
+bool recordStartupManifest(const LoaderConfig& config, const std::string& dllPath);
+
+// Removes the manifest so the next launch takes the full path
+void invalidateStartupManifest(const std::string& modulePath);
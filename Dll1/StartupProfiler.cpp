@@ -0,0 +1,146 @@
+// =============================================
+// File: StartupProfiler.cpp
+// Category: Diagnostics
+// Purpose: Implements startup phase timing, filesystem counters and the JSON report.
+// =============================================
+#include "StartupProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+
+namespace {
+    const int MAX_PHASES = 32;
+    const int OTHER_PHASE = 0;
+
+    struct PhaseRecord {
+        const char* name = nullptr;
+        int parent = -1;
+        double durationMs = 0.0;
+        std::atomic<std::uint64_t> counters[StartupProfiler::FS_OP_COUNT] = {};
+    };
+
+    const char* counterNames[StartupProfiler::FS_OP_COUNT] = {
+        "exists", "is_directory", "stat", "open", "read_bytes", "write_bytes"
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    PhaseRecord g_phases[MAX_PHASES];
+    std::atomic<int> g_phaseCount{ 1 };
+    std::mutex g_phaseMutex;
+    Clock::time_point g_phaseStart[MAX_PHASES];
+    thread_local int t_currentPhase = OTHER_PHASE;
+
+    struct OtherPhaseName {
+        OtherPhaseName() { g_phases[OTHER_PHASE].name = "other"; }
+    } g_otherPhaseName;
+
+    // Minimal JSON string escaping for phase names and paths
+    std::string jsonEscape(const char* text) {
+        std::string escaped;
+        for (const char* p = text; *p; ++p) {
+            switch (*p) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += *p; break;
+            }
+        }
+        return escaped;
+    }
+}
+
+namespace StartupProfiler {
+
+    ScopedPhase::ScopedPhase(const char* name) : m_index(-1), m_parent(t_currentPhase) {
+        std::lock_guard<std::mutex> lock(g_phaseMutex);
+        int index = g_phaseCount.load();
+        if (index >= MAX_PHASES) {
+            return;  // Out of slots: counters keep going to the enclosing phase
+        }
+        g_phases[index].name = name;
+        g_phases[index].parent = m_parent;
+        g_phaseStart[index] = Clock::now();
+        g_phaseCount.store(index + 1);
+        m_index = index;
+        t_currentPhase = index;
+    }
+
+    ScopedPhase::~ScopedPhase() {
+        if (m_index < 0) {
+            return;
+        }
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - g_phaseStart[m_index];
+        g_phases[m_index].durationMs = elapsed.count();
+        t_currentPhase = m_parent;
+    }
+
+    void count(FsOp op, std::uint64_t amount) {
+        if (op < 0 || op >= FS_OP_COUNT) {
+            return;
+        }
+        g_phases[t_currentPhase].counters[op].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    std::string formatSummary() {
+        std::ostringstream summary;
+        summary << "Startup profile:";
+
+        double totalMs = 0.0;
+        std::uint64_t totalOps = 0;
+        int phaseCount = g_phaseCount.load();
+        for (int i = 0; i < phaseCount; ++i) {
+            const PhaseRecord& phase = g_phases[i];
+            for (int op = FS_EXISTS; op <= FS_OPEN; ++op) {
+                totalOps += phase.counters[op].load(std::memory_order_relaxed);
+            }
+            if (i == OTHER_PHASE) {
+                continue;
+            }
+            if (phase.parent == OTHER_PHASE) {
+                totalMs += phase.durationMs;
+            }
+
+            char timing[32];
+            std::snprintf(timing, sizeof(timing), "%.2f", phase.durationMs);
+            summary << " " << phase.name << "=" << timing << "ms";
+        }
+
+        char total[32];
+        std::snprintf(total, sizeof(total), "%.2f", totalMs);
+        summary << " | total=" << total << "ms, fs ops=" << totalOps;
+        return summary.str();
+    }
+
+    bool writeReport(const std::string& reportPath) {
+        std::ostringstream json;
+        json << "{\n  \"clock\": \"steady_clock\",\n  \"phases\": [\n";
+
+        int phaseCount = g_phaseCount.load();
+        for (int i = 0; i < phaseCount; ++i) {
+            const PhaseRecord& phase = g_phases[i];
+            char timing[32];
+            std::snprintf(timing, sizeof(timing), "%.3f", phase.durationMs);
+
+            json << "    { \"name\": \"" << jsonEscape(phase.name) << "\""
+                << ", \"parent\": " << (phase.parent >= 0 ? "\"" + jsonEscape(g_phases[phase.parent].name) + "\"" : "null")
+                << ", \"ms\": " << timing;
+            for (int op = 0; op < FS_OP_COUNT; ++op) {
+                json << ", \"" << counterNames[op] << "\": " << phase.counters[op].load(std::memory_order_relaxed);
+            }
+            json << " }" << (i + 1 < phaseCount ? "," : "") << "\n";
+        }
+        json << "  ]\n}\n";
+
+        std::ofstream out(reportPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out << json.str();
+        return !out.fail();
+    }
+}
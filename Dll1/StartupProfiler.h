@@ -0,0 +1,78 @@
+// =============================================
+// File: StartupProfiler.h
+// Category: Diagnostics
+// Purpose: Declares per-phase startup timing and filesystem operation counters.
+// =============================================
+#pragma once
+#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+
+namespace StartupProfiler {
+
+    enum FsOp {
+        FS_EXISTS = 0,
+        FS_IS_DIRECTORY,
+        FS_STAT,
+        FS_OPEN,
+        FS_READ_BYTES,
+        FS_WRITE_BYTES,
+        FS_OP_COUNT
+    };
+
+    // Times a named phase (monotonic clock) and attributes filesystem counters to it.
+    // Phases nest: counters go to the innermost active phase on the calling thread.
+    class ScopedPhase {
+    public:
+        explicit ScopedPhase(const char* name);
+        ~ScopedPhase();
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        int m_index;
+        int m_parent;
+    };
+
+    // Adds to a counter of the current phase (ops outside any phase go to "other")
+    void count(FsOp op, std::uint64_t amount = 1);
+
+    // One-line summary for the console
+    std::string formatSummary();
+
+    // Writes the JSON report; returns false if the file cannot be written
+    bool writeReport(const std::string& reportPath);
+}
+
+// Counting wrappers for the std::filesystem queries used on the startup path
+namespace pfs {
+    inline bool exists(const std::filesystem::path& p) {
+        StartupProfiler::count(StartupProfiler::FS_EXISTS);
+        return std::filesystem::exists(p);
+    }
+    inline bool exists(const std::filesystem::path& p, std::error_code& ec) {
+        StartupProfiler::count(StartupProfiler::FS_EXISTS);
+        return std::filesystem::exists(p, ec);
+    }
+    inline bool is_directory(const std::filesystem::path& p) {
+        StartupProfiler::count(StartupProfiler::FS_IS_DIRECTORY);
+        return std::filesystem::is_directory(p);
+    }
+    inline bool is_regular_file(const std::filesystem::path& p) {
+        StartupProfiler::count(StartupProfiler::FS_STAT);
+        return std::filesystem::is_regular_file(p);
+    }
+    inline std::uintmax_t file_size(const std::filesystem::path& p) {
+        StartupProfiler::count(StartupProfiler::FS_STAT);
+        return std::filesystem::file_size(p);
+    }
+    inline std::uintmax_t file_size(const std::filesystem::path& p, std::error_code& ec) {
+        StartupProfiler::count(StartupProfiler::FS_STAT);
+        return std::filesystem::file_size(p, ec);
+    }
+    inline std::filesystem::file_time_type last_write_time(const std::filesystem::path& p, std::error_code& ec) {
+        StartupProfiler::count(StartupProfiler::FS_STAT);
+        return std::filesystem::last_write_time(p, ec);
+    }
+}
@@ -0,0 +1,52 @@
+// =============================================
+// File: WorkerPool.cpp
+// Category: Main Loader Orchestration
+// Purpose: Implements the fork-join pool used for per-file jobs.
+// =============================================
+#include "WorkerPool.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr size_t MIN_DEFAULT_WORKERS = 4;
+    constexpr size_t MAX_DEFAULT_WORKERS = 8;
+}
+
+size_t getDefaultWorkerCount() {
+    // Per-file jobs mostly wait on the disk (fsync, rename), so even one core
+    // overlaps a few of them
+    size_t hardware = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(hardware, MIN_DEFAULT_WORKERS, MAX_DEFAULT_WORKERS);
+}
+
+void runParallel(size_t count, size_t maxWorkers, const std::function<void(size_t)>& task) {
+    // Items are handed out one at a time, so a slow file never holds up a queue behind it
+    std::atomic<size_t> next{ 0 };
+    auto drain = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            task(i);
+        }
+    };
+
+    size_t helpers = std::min(count, std::max<size_t>(maxWorkers, 1)) - (count > 0 ? 1 : 0);
+    std::vector<std::thread> threads;
+    threads.reserve(helpers);
+    for (size_t i = 0; i < helpers; ++i) {
+        try {
+            threads.emplace_back(drain);
+        }
+        catch (const std::exception& e) {
+            // Fewer helpers only means less overlap; the caller still drains everything
+            LOG_AT(LOG_DEBUG, "WorkerPool", "Cannot start worker thread: ", e.what());
+            break;
+        }
+    }
+
+    drain();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,16 @@
+// =============================================
+// File: WorkerPool.h
+// Category: Main Loader Orchestration
+// Purpose: Declares a small fork-join pool for independent per-file jobs.
+// =============================================
+#pragma once
+#include <cstddef>
+#include <functional>
+
+// Runs task(0) .. task(count - 1) on up to maxWorkers threads and returns
+// once all of them are done. The calling thread takes part, so one item
+// never starts a thread. Tasks must not throw.
+void runParallel(size_t count, size_t maxWorkers, const std::function<void(size_t)>& task);
+
+// Worker count for I/O-bound jobs: the hardware threads, kept within 4..8
+size_t getDefaultWorkerCount();
@@ -0,0 +1,67 @@
+// =============================================
+// File: tests/FakeGame.h
+// Category: Test Harness
+// Purpose: Scratch game layout (DLL, .me3, TOML, c0000.hks, modules) for tests that
+//          drive DllMain the way the game does.
+// =============================================
+#pragma once
+#include "TestSupport.h"
+#include "FlagFile.h"
+#include "BackupStore.h"
+
+// <root>/game/mod/{LuaLoader.dll, loader.me3, LuaLoader.toml, action/script/c0000.hks,
+// action/script/lua/*.lua}. Every module load appends its name to <root>/loads.txt.
+struct FakeGame {
+    static constexpr const char* MODULES[] = { "alpha", "beta", "gamma" };
+    static constexpr size_t MODULE_COUNT = sizeof(MODULES) / sizeof(MODULES[0]);
+
+    TestSupport::TempDir root{ "game" };
+    fs::path modDir = root / "game/mod";
+    fs::path dll = modDir / "LuaLoader.dll";
+    fs::path scriptDir = modDir / "action/script";
+    fs::path moduleDir = scriptDir / "lua";
+    fs::path loads = root / "loads.txt";
+
+    FakeGame() {
+        TestSupport::writeText(dll, "MZ");
+        TestSupport::writeText(modDir / "loader.me3", "profileVersion = \"v1\"\n");
+        writeConfig(false);
+        TestSupport::writeText(scriptDir / "c0000.hks", "-- game script\nfunction Update() end\n");
+        for (const char* name : MODULES) {
+            TestSupport::writeText(moduleDir / (std::string(name) + ".lua"),
+                "local f = io.open(\"" + loads.string() + "\", \"a\") f:write(\"" + name + "\\n\") f:close()\nreturn {}\n");
+        }
+    }
+
+    void writeConfig(bool backupOnLaunch) {
+        TestSupport::writeText(modDir / "LuaLoader.toml",
+            "gameScriptPath = \"action/script\"\n"
+            "modulePath = \"action/script/lua\"\n"
+            "hksTargets = [\"c0000.hks\"]\n"
+            "backupHKSonLaunch = " + std::string(backupOnLaunch ? "true" : "false") + "\n"
+            "backupHKSFolder = \"\"\n");
+    }
+
+    std::string script() const { return (moduleDir / "_module_loader/module_loader_setup.lua").string(); }
+    std::string profile() const { return TestSupport::readText(moduleDir / "_module_loader/startup_profile.json"); }
+    std::string sessionFile() const { return getSessionFilePath(dll.string()); }
+    std::string flagFile() const { return getFlagFilePath(moduleDir.string()); }
+
+    size_t loadCount() const {
+        std::string text = TestSupport::readText(loads);
+        return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    }
+
+    size_t launchBackups() const {
+        std::vector<BackupEntry> entries;
+        readBackupCatalog(scriptDir.string(), entries);
+        return static_cast<size_t>(std::count_if(entries.begin(), entries.end(),
+            [](const BackupEntry& entry) { return entry.context == "launch"; }));
+    }
+
+    // The last launch reused the setup script and HKS integration
+    bool tookFastPath() const {
+        std::string report = profile();
+        return !report.empty() && report.find("createWorkingSetupScript") == std::string::npos;
+    }
+};
@@ -0,0 +1,173 @@
+// =============================================
+// File: tests/TestSupport.h
+// Category: Test Harness
+// Purpose: Checks, scratch directories, timing and a Lua runner shared by the headless tests.
+// =============================================
+#pragma once
+#include "lua.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace TestSupport {
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const std::string& what) {
+        ++failures();
+        std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, what.c_str());
+    }
+
+    // Prints the result and returns main's exit code
+    inline int finish(const char* name) {
+        if (failures() == 0) {
+            std::printf("[PASS] %s\n", name);
+            return 0;
+        }
+        std::printf("[FAIL] %s: %d check(s) failed\n", name, failures());
+        return 1;
+    }
+
+    // True when argv carries flag (benchmarks use --full for the documented sizes)
+    inline bool hasFlag(int argc, char** argv, const char* flag) {
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], flag) == 0) return true;
+        }
+        return false;
+    }
+
+    // Scratch directory under the system temp dir, removed on destruction
+    class TempDir {
+    public:
+        explicit TempDir(const char* tag = "lualoader") {
+            std::string pattern = (fs::temp_directory_path() / (std::string(tag) + "-XXXXXX")).string();
+            std::vector<char> buffer(pattern.begin(), pattern.end());
+            buffer.push_back('\0');
+            if (::mkdtemp(buffer.data())) {
+                m_path = buffer.data();
+            }
+        }
+        ~TempDir() {
+            std::error_code ec;
+            fs::remove_all(m_path, ec);
+        }
+        TempDir(const TempDir&) = delete;
+        TempDir& operator=(const TempDir&) = delete;
+
+        const fs::path& path() const { return m_path; }
+        std::string str() const { return m_path.string(); }
+        fs::path operator/(const std::string& child) const { return m_path / child; }
+
+    private:
+        fs::path m_path;
+    };
+
+    inline void writeText(const fs::path& path, const std::string& content) {
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+    }
+
+    inline std::string readText(const fs::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Monotonic stopwatch
+    class Stopwatch {
+    public:
+        Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+        void restart() { m_start = std::chrono::steady_clock::now(); }
+        double ms() const {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+        }
+        double us() const { return ms() * 1000.0; }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Value at quantile q (0..1) of samples; sorts them
+    inline double percentile(std::vector<double>& samples, double q) {
+        if (samples.empty()) return 0.0;
+        std::sort(samples.begin(), samples.end());
+        size_t index = static_cast<size_t>(q * static_cast<double>(samples.size() - 1) + 0.5);
+        return samples[std::min(index, samples.size() - 1)];
+    }
+
+    // Result of running a script in a fresh vendored Lua 5.4 state
+    struct LuaRun {
+        bool ok = false;
+        std::string error;
+        int popenCalls = 0;     // io.popen / os.execute calls (child processes)
+    };
+
+    namespace detail {
+        inline int countSpawn(lua_State* L) {
+            int* counter = static_cast<int*>(lua_touserdata(L, lua_upvalueindex(1)));
+            ++*counter;
+            lua_pushvalue(L, lua_upvalueindex(2));
+            lua_insert(L, 1);
+            lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+            return lua_gettop(L);
+        }
+
+        inline void wrapSpawn(lua_State* L, const char* table, const char* name, int* counter) {
+            lua_getglobal(L, table);
+            lua_pushlightuserdata(L, counter);
+            lua_getfield(L, -2, name);
+            lua_pushcclosure(L, countSpawn, 2);
+            lua_setfield(L, -2, name);
+            lua_pop(L, 1);
+        }
+    }
+
+    // Runs scriptPath with the standard libraries; prelude (Lua source) runs first in the same state.
+    // io.popen and os.execute are counted, not blocked.
+    inline LuaRun runLuaScript(const std::string& scriptPath, const std::string& prelude = std::string()) {
+        LuaRun run;
+        lua_State* L = luaL_newstate();
+        luaL_openlibs(L);
+        detail::wrapSpawn(L, "io", "popen", &run.popenCalls);
+        detail::wrapSpawn(L, "os", "execute", &run.popenCalls);
+
+        int status = LUA_OK;
+        if (!prelude.empty()) {
+            status = luaL_dostring(L, prelude.c_str());
+        }
+        if (status == LUA_OK) {
+            status = luaL_dofile(L, scriptPath.c_str());
+        }
+        run.ok = status == LUA_OK;
+        if (!run.ok) {
+            const char* message = lua_tostring(L, -1);
+            run.error = message ? message : "unknown Lua error";
+        }
+        lua_close(L);
+        return run;
+    }
+}
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) TestSupport::fail(__FILE__, __LINE__, #condition);     \
+    } while (0)
+
+#define CHECK_MSG(condition, message)                                            \
+    do {                                                                         \
+        if (!(condition)) TestSupport::fail(__FILE__, __LINE__, std::string(#condition) + " (" + (message) + ")"); \
+    } while (0)
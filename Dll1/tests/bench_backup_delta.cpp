@@ -0,0 +1,152 @@
+// =============================================
+// File: tests/bench_backup_delta.cpp
+// Category: Benchmark
+// Purpose: 200-revision synthetic HKS history stored as full blobs and as deltas:
+//          storage ratio, backup time per revision, and restore throughput. Every
+//          delta is taken against the newest full blob, so deltas grow with the edits
+//          since that base until one passes half the file and a new base is written.
+// =============================================
+#include "TestSupport.h"
+#include "BackupStore.h"
+#include "Logger.h"
+#include <cstdint>
+#include <map>
+
+using namespace TestSupport;
+
+namespace {
+
+    // Game-script lines, edited a few at a time like a modded c0000.hks
+    class History {
+    public:
+        explicit History(size_t bytes) {
+            size_t total = 0;
+            while (total < bytes) {
+                lines_.push_back(makeLine());
+                total += lines_.back().size();
+            }
+        }
+
+        void revise() {
+            for (int edit = 0; edit < 3; ++edit) {
+                lines_[next() % lines_.size()] = makeLine();
+            }
+            lines_.insert(lines_.begin() + static_cast<std::ptrdiff_t>(next() % lines_.size()), makeLine());
+            lines_.erase(lines_.begin() + static_cast<std::ptrdiff_t>(next() % lines_.size()));
+        }
+
+        std::string text() const {
+            std::string joined;
+            for (const auto& line : lines_) joined += line;
+            return joined;
+        }
+
+    private:
+        std::uint64_t next() {
+            state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+            return state_ >> 33;
+        }
+
+        std::string makeLine() {
+            std::uint64_t id = next();
+            return "function act_" + std::to_string(id % 100000) + "(ai, p) if env(ai, " + std::to_string(id % 997) +
+                ") then return act(ai, p, " + std::to_string(id % 31) + ") end end\n";
+        }
+
+        std::vector<std::string> lines_;
+        std::uint64_t state_ = 42;
+    };
+
+    unsigned long long objectsBytes(const std::string& backupDir) {
+        unsigned long long total = 0;
+        for (const auto& entry : fs::directory_iterator(getBackupObjectsDir(backupDir))) {
+            total += entry.file_size();
+        }
+        return total;
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    const size_t fileBytes = full ? (4u << 20) : (512u << 10);
+    const int revisions = 200;
+
+    setSilentMode(true);
+    TempDir root("backup-delta");
+    const fs::path source = root / "c0000.hks";
+    const std::string fullDir = (root / "full").string();
+    const std::string deltaDir = (root / "delta").string();
+
+    History history(fileBytes);
+    std::map<std::string, std::string> samples;       // hash -> content, every 50th revision
+    unsigned long long logicalBytes = 0;
+    double fullMs = 0;
+    double deltaMs = 0;
+    size_t deltaCount = 0;
+    BackupRetention unlimited;
+
+    for (int revision = 0; revision < revisions; ++revision) {
+        if (revision > 0) {
+            history.revise();
+        }
+        std::string content = history.text();
+        writeText(source, content);
+        logicalBytes += content.size();
+
+        BackupResult asFull;
+        Stopwatch timer;
+        CHECK(storeBackup(source.string(), fullDir, "launch", false, unlimited, asFull));
+        fullMs += timer.ms();
+
+        BackupResult asDelta;
+        timer.restart();
+        CHECK(storeBackup(source.string(), deltaDir, "launch", true, unlimited, asDelta));
+        deltaMs += timer.ms();
+        deltaCount += asDelta.delta ? 1 : 0;
+
+        if (revision % 50 == 49) {
+            std::vector<BackupEntry> entries;
+            CHECK(readBackupCatalog(deltaDir, entries));
+            samples[entries.back().hash] = std::move(content);
+        }
+    }
+
+    std::vector<BackupEntry> entries;
+    CHECK(readBackupCatalog(deltaDir, entries));
+    CHECK(entries.size() == static_cast<size_t>(revisions));
+    CHECK(deltaCount > static_cast<size_t>(revisions) / 2);
+
+    // Rebuild every revision from the delta store
+    const std::string restored = (root / "restored.hks").string();
+    unsigned long long restoredBytes = 0;
+    Stopwatch restoreTimer;
+    for (const auto& entry : entries) {
+        CHECK_MSG(restoreBackup(deltaDir, entry.hash, restored), entry.hash);
+        restoredBytes += entry.size;
+        auto sample = samples.find(entry.hash);
+        if (sample != samples.end()) {
+            CHECK(readText(restored) == sample->second);
+        }
+    }
+    double restoreMs = restoreTimer.ms();
+
+    BackupVerifyReport report = verifyBackupStore(deltaDir);
+    CHECK(report.checked == static_cast<size_t>(revisions));
+    CHECK(report.missing == 0 && report.corrupt == 0);
+
+    unsigned long long fullStored = objectsBytes(fullDir);
+    unsigned long long deltaStored = objectsBytes(deltaDir);
+    double mb = 1024.0 * 1024.0;
+    std::printf("backup history (%d revisions of a %.1f MB script, %zu stored as deltas)\n",
+        revisions, static_cast<double>(fileBytes) / mb, deltaCount);
+    std::printf("  full blobs: %8.1f MB on disk (%.2fx logical), %.2f ms per backup\n",
+        fullStored / mb, static_cast<double>(fullStored) / static_cast<double>(logicalBytes), fullMs / revisions);
+    std::printf("  deltas:     %8.1f MB on disk (%.3fx logical, %.1fx smaller), %.2f ms per backup\n",
+        deltaStored / mb, static_cast<double>(deltaStored) / static_cast<double>(logicalBytes),
+        static_cast<double>(fullStored) / static_cast<double>(deltaStored), deltaMs / revisions);
+    std::printf("  restore:    %d revisions in %.1f ms (%.0f MB/s, hash-checked)\n",
+        revisions, restoreMs, (restoredBytes / mb) / (restoreMs / 1000.0));
+
+    shutdownLogger();
+    return finish("bench_backup_delta");
+}
@@ -0,0 +1,97 @@
+// =============================================
+// File: tests/bench_bootstrap.cpp
+// Category: Benchmark
+// Purpose: Runs the generated module_loader_setup.lua under the vendored Lua 5.4 and
+//          reports HKS bootstrap latency with and without the legacy io.popen PID lookup.
+// =============================================
+#include "TestSupport.h"
+#include "LuaSetup.h"
+#include "FlagFile.h"
+#include "Logger.h"
+#include <unistd.h>
+
+using namespace TestSupport;
+
+namespace {
+
+    // What the template did before the DLL supplied the PID: one child process
+    // for the duplicate-load check and one more when writing the flag file.
+    // (On Windows the second half of the command line started PowerShell.)
+    const char* LEGACY_PID_LOOKUP = R"LUA(
+        for _ = 1, 2 do
+            local handle = io.popen("echo $PPID")
+            if handle then handle:read("*l"); handle:close() end
+        end
+    )LUA";
+
+    struct Sample {
+        double medianMs = 0;
+        double p95Ms = 0;
+        int spawns = 0;
+    };
+
+    Sample measure(const std::string& script, const std::string& flagFile, const std::string& prelude, int iterations) {
+        std::vector<double> samples;
+        Sample result;
+        for (int i = 0; i < iterations; ++i) {
+            std::error_code ec;
+            fs::remove(flagFile, ec);
+
+            Stopwatch timer;
+            LuaRun run = runLuaScript(script, prelude);
+            samples.push_back(timer.ms());
+
+            CHECK_MSG(run.ok, run.error);
+            result.spawns = std::max(result.spawns, run.popenCalls);
+        }
+        result.p95Ms = percentile(samples, 0.95);
+        result.medianMs = percentile(samples, 0.5);
+        return result;
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    const int iterations = full ? 200 : 20;
+    const int moduleCount = 20;
+
+    setSilentMode(true);
+    TempDir root("bootstrap");
+    // The script prints to "CONOUT$"; keep that file inside the scratch dir
+    CHECK(::chdir(root.str().c_str()) == 0);
+
+    LoaderConfig config;
+    config.configDir = root.str();
+    config.modulePath = PathInfo("mods", (root / "mods").string(), root.str());
+    config.gameScriptPath = PathInfo("action/script", (root / "action/script").string(), root.str());
+    for (int i = 0; i < moduleCount; ++i) {
+        writeText(root / ("mods/module_" + std::to_string(i) + ".lua"), "return { id = " + std::to_string(i) + " }\n");
+    }
+
+    const std::string dllPath = (root / "LuaLoader.dll").string();
+    CHECK(beginSession(dllPath));
+    CHECK(createWorkingSetupScript(config, getSessionFilePath(dllPath)));
+    CHECK(updateSessionState(SESSION_STATE_READY));
+
+    const std::string script = config.modulePath.absolutePath + "/_module_loader/module_loader_setup.lua";
+    const std::string flagFile = getFlagFilePath(config.modulePath.absolutePath);
+
+    Sample legacy = measure(script, flagFile, LEGACY_PID_LOOKUP, iterations);
+    Sample current = measure(script, flagFile, std::string(), iterations);
+
+    // The bootstrap itself must not start a single process
+    CHECK(current.spawns == 0);
+    CHECK(legacy.spawns == 2);
+
+    // A second run in the same launch finds its token in the flag file and skips loading
+    LuaRun rerun = runLuaScript(script);
+    CHECK_MSG(rerun.ok, rerun.error);
+    CHECK(readText(root / "CONOUT$").find("already loaded") != std::string::npos);
+
+    std::printf("bootstrap (%d modules, %d runs)\n", moduleCount, iterations);
+    std::printf("  before (io.popen PID lookup): median %.3f ms  p95 %.3f ms  spawns %d\n", legacy.medianMs, legacy.p95Ms, legacy.spawns);
+    std::printf("  after  (DLL session file):    median %.3f ms  p95 %.3f ms  spawns %d\n", current.medianMs, current.p95Ms, current.spawns);
+
+    shutdownLogger();
+    return finish("bench_bootstrap");
+}
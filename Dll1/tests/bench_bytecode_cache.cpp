@@ -0,0 +1,116 @@
+// =============================================
+// File: tests/bench_bytecode_cache.cpp
+// Category: Benchmark
+// Purpose: Cold versus warm bytecode cache on a synthetic module tree, source versus
+//          chunk load time, and the cache-hit rules for same-size and same-tick edits.
+// =============================================
+#include "TestSupport.h"
+#include "BytecodeCache.h"
+#include "ModuleManifest.h"
+#include "Logger.h"
+
+using namespace TestSupport;
+
+namespace {
+
+    std::string makeModule(int id) {
+        std::string lua = "local M = {}\n";
+        for (int i = 0; i < 40; ++i) {
+            lua += "function M.f" + std::to_string(i) + "(x) local y = x * " + std::to_string(id + i) +
+                " if y > 100 then return y - " + std::to_string(i) + " else return { y, x, \"s" +
+                std::to_string(i) + "\" } end end\n";
+        }
+        return lua + "return M\n";
+    }
+
+    // Loads (compiles or undumps) each file without running it
+    double loadAll(const std::vector<std::string>& paths) {
+        lua_State* L = luaL_newstate();
+        Stopwatch timer;
+        for (const auto& path : paths) {
+            CHECK_MSG(luaL_loadfile(L, path.c_str()) == LUA_OK, path);
+            lua_pop(L, 1);
+        }
+        double elapsed = timer.ms();
+        lua_close(L);
+        return elapsed;
+    }
+
+    void benchColdWarm(int moduleCount) {
+        TempDir root("bytecode");
+        const std::string modulePath = root.str();
+        for (int i = 0; i < moduleCount; ++i) {
+            writeText(root / ("mod_" + std::to_string(i) + ".lua"), makeModule(i));
+        }
+        std::vector<ModuleEntry> modules = scanModuleDirectory(modulePath);
+
+        Stopwatch timer;
+        BytecodeCacheResult cold = updateBytecodeCache(modulePath, modules);
+        double coldMs = timer.ms();
+        timer.restart();
+        BytecodeCacheResult warm = updateBytecodeCache(modulePath, modules);
+        double warmMs = timer.ms();
+
+        CHECK(cold.compiled == static_cast<size_t>(moduleCount));
+        CHECK(warm.reused == static_cast<size_t>(moduleCount));
+        CHECK(warm.compiled == 0);
+
+        std::vector<std::string> sources, chunks;
+        for (const auto& module : modules) {
+            sources.push_back(modulePath + "/" + module.name + ".lua");
+            chunks.push_back(getBytecodeCacheDir(modulePath) + "/" + warm.chunkFiles[module.name]);
+        }
+        double sourceLoadMs = loadAll(sources);
+        double chunkLoadMs = loadAll(chunks);
+
+        std::printf("bytecode cache (%d modules)\n", moduleCount);
+        std::printf("  cache update: cold %.2f ms, warm %.2f ms\n", coldMs, warmMs);
+        std::printf("  module load:  from source %.2f ms, from cached chunks %.2f ms\n", sourceLoadMs, chunkLoadMs);
+    }
+
+    // The fast path must not trust a rewrite that keeps the size and lands in the same second
+    void testSameSizeEditInSameSecond() {
+        TempDir root("bytecode-edit");
+        const std::string modulePath = root.str();
+        fs::path source = root / "edited.lua";
+        writeText(source, "return 1\n");
+        CHECK(updateBytecodeCache(modulePath, scanModuleDirectory(modulePath)).compiled == 1);
+
+        auto recorded = fs::last_write_time(source);
+        writeText(source, "return 2\n");
+        fs::last_write_time(source, recorded + std::chrono::milliseconds(1));
+
+        BytecodeCacheResult result = updateBytecodeCache(modulePath, scanModuleDirectory(modulePath));
+        CHECK(result.compiled == 1);
+        CHECK(result.reused == 0);
+    }
+
+    // A source stamped no earlier than the index is hashed rather than trusted
+    void testRacyEntryIsHashed() {
+        TempDir root("bytecode-racy");
+        const std::string modulePath = root.str();
+        fs::path source = root / "racy.lua";
+        writeText(source, "return 1\n");
+        CHECK(updateBytecodeCache(modulePath, scanModuleDirectory(modulePath)).compiled == 1);
+
+        // Same size and the mtime the index recorded, but written as late as the index
+        auto indexTime = fs::last_write_time(getBytecodeCacheDir(modulePath) + "/index.txt");
+        writeText(source, "return 3\n");
+        fs::last_write_time(source, indexTime);
+        CHECK(updateBytecodeCache(modulePath, scanModuleDirectory(modulePath)).compiled == 1);
+
+        // The index was rewritten after it, so the next run is a plain hit again
+        BytecodeCacheResult again = updateBytecodeCache(modulePath, scanModuleDirectory(modulePath));
+        CHECK(again.compiled == 0);
+        CHECK(again.reused == 1);
+    }
+}
+
+int main(int argc, char** argv) {
+    setSilentMode(true);
+    benchColdWarm(hasFlag(argc, argv, "--full") ? 500 : 100);
+    testSameSizeEditInSameSecond();
+    testRacyEntryIsHashed();
+    shutdownLogger();
+    return finish("bench_bytecode_cache");
+}
@@ -0,0 +1,102 @@
+// =============================================
+// File: tests/bench_config_parse.cpp
+// Category: Benchmark
+// Purpose: parseTomlConfig throughput on multi-MB configs (comments, module tables,
+//          multi-line arrays), with the bare file read as the floor.
+// =============================================
+#include "TestSupport.h"
+#include "ConfigParser.h"
+#include "ModulePolicy.h"
+#include "Logger.h"
+#include <fstream>
+#include <sstream>
+
+using namespace TestSupport;
+
+namespace {
+
+    // Top-level keys first, then one [modules.<name>] table (and its env table) per
+    // module until the file reaches targetBytes
+    size_t writeConfig(const fs::path& path, size_t targetBytes) {
+        std::string toml =
+            "# LuaLoader configuration\r\n"
+            "configVersion = 1\r\n"
+            "gameScriptPath = \"action/script\"   # where c0000.hks lives\r\n"
+            "modulePath = \"action/script/lua\"\r\n"
+            "hksTargets = [\r\n"
+            "    \"c0000.hks\",   # player\r\n"
+            "    \"c1*.hks\",\r\n"
+            "]\r\n"
+            "backupHKSonLaunch = false\r\n"
+            "backupHKSFolder = \"backups # not a comment\"\r\n"
+            "\r\n";
+
+        size_t modules = 0;
+        while (toml.size() < targetBytes) {
+            std::string name = "module_" + std::to_string(modules++);
+            toml += "\r\n# " + name + ": settings written by a mod manager, 'quoted # text' kept\r\n";
+            toml += "[modules." + name + "]\r\n";
+            toml += "enabled = " + std::string(modules % 7 ? "true" : "false") + "\r\n";
+            toml += "lazy = false\r\n";
+            toml += "priority = " + std::to_string(modules % 100) + "   # load order\r\n";
+            toml += "[modules." + name + ".env]\r\n";
+            toml += "MOD_NAME = \"" + name + "\"\r\n";
+            toml += "MOD_DATA = \"data/" + name + "/config # with hash.lua\"\r\n";
+        }
+
+        writeText(path, toml);
+        return modules;
+    }
+
+    // Floor for any parser: reading the file into memory
+    size_t readOnly(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream content;
+        content << in.rdbuf();
+        return content.str().size();
+    }
+
+    void bench(const TempDir& root, size_t targetBytes, int runs) {
+        fs::path path = root / ("LuaLoader_" + std::to_string(targetBytes >> 20) + "MB.toml");
+        size_t moduleCount = writeConfig(path, targetBytes);
+        double mb = static_cast<double>(fs::file_size(path)) / (1024.0 * 1024.0);
+
+        std::vector<double> parseSamples, readSamples;
+        for (int i = 0; i < runs; ++i) {
+            LoaderConfig config;
+            Stopwatch timer;
+            bool ok = parseTomlConfig(path.string(), config);
+            parseSamples.push_back(timer.ms());
+
+            CHECK(ok);
+            CHECK(config.modulePolicy->size() == moduleCount);
+            CHECK(config.hksTargets.size() == 2);
+            CHECK(config.backupHKSFolder == "backups # not a comment");
+
+            timer.restart();
+            CHECK(readOnly(path.string()) > targetBytes);
+            readSamples.push_back(timer.ms());
+        }
+
+        double parseMs = percentile(parseSamples, 0.5);
+        double readMs = percentile(readSamples, 0.5);
+        std::printf("  %5.1f MB (%zu module tables): parse %.2f ms (%.0f MB/s), file read alone %.2f ms\n",
+            mb, moduleCount, parseMs, mb / (parseMs / 1000.0), readMs);
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    setSilentMode(true);
+
+    TempDir root("config-parse");
+    fs::create_directories(root / "action/script/lua");
+
+    std::printf("config parse throughput (median of %d runs)\n", full ? 10 : 3);
+    for (size_t megabytes : full ? std::vector<size_t>{ 1, 4, 16 } : std::vector<size_t>{ 1, 4 }) {
+        bench(root, megabytes << 20, full ? 10 : 3);
+    }
+
+    shutdownLogger();
+    return finish("bench_config_parse");
+}
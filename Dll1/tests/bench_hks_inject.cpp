@@ -0,0 +1,221 @@
+// =============================================
+// File: tests/bench_hks_inject.cpp
+// Category: Benchmark
+// Purpose: Peak RSS and wall time of injecting into a large c0000.hks: the mapped,
+//          temp-file-replace path against the read/concatenate/stream-out path it
+//          replaced. Each run is a forked child so its peak RSS is its own.
+// =============================================
+#include "TestSupport.h"
+#include "HksInjector.h"
+#include "Logger.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <malloc.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace TestSupport;
+
+// Heap high-water mark. ru_maxrss also counts the file-backed pages of every
+// mapping, so it cannot tell a mapped view from a full-file heap copy.
+namespace {
+    std::atomic<size_t> g_heapBytes{ 0 };
+    std::atomic<size_t> g_heapPeak{ 0 };
+}
+
+namespace {
+    // Out of line so GCC never sees free() paired with a pointer it knows came
+    // from operator new (-Wmismatched-new-delete)
+    __attribute__((noinline)) void* countedAlloc(std::size_t size) {
+        void* block = std::malloc(size ? size : 1);
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        size_t now = g_heapBytes.fetch_add(malloc_usable_size(block)) + malloc_usable_size(block);
+        size_t peak = g_heapPeak.load();
+        while (now > peak && !g_heapPeak.compare_exchange_weak(peak, now)) {
+        }
+        return block;
+    }
+
+    __attribute__((noinline)) void countedFree(void* block) noexcept {
+        if (block) {
+            g_heapBytes.fetch_sub(malloc_usable_size(block));
+            std::free(block);
+        }
+    }
+}
+
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* block) noexcept {
+    countedFree(block);
+}
+
+void operator delete[](void* block) noexcept {
+    countedFree(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    countedFree(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept {
+    countedFree(block);
+}
+
+namespace {
+
+    const std::string HEADER = "-- ========================================\n-- Lua Loader\n-- ========================================\n\n";
+
+    // The injection before the mapped path: whole file into a string, a second
+    // full copy with the header in front, then streamed back over the original
+    bool legacyInject(const std::string& hksPath, const std::string& injectionLine) {
+        std::string fileContent;
+        {
+            std::ifstream in(hksPath, std::ios::binary);
+            if (!in.is_open()) return false;
+            fileContent.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        if (checkInjectionStatus(fileContent, injectionLine).isInjected) return true;
+
+        std::string newContent = HEADER + injectionLine + "\n\n" + fileContent;
+        std::ofstream out(hksPath, std::ios::binary | std::ios::trunc);
+        out << newContent;
+        return out.good();
+    }
+
+    // Synthetic game script written in chunks, so the parent never holds it in memory
+    void writeHks(const fs::path& path, size_t bytes) {
+        fs::create_directories(path.parent_path());
+        std::string chunk;
+        for (size_t i = 0; chunk.size() < (1u << 20); ++i) {
+            chunk += "function act_" + std::to_string(i) + "(ai) if ai then env(ai, " + std::to_string(i % 997) + ") end end\n";
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        for (size_t written = 0; written < bytes; written += chunk.size()) {
+            out.write(chunk.data(), static_cast<std::streamsize>(std::min(chunk.size(), bytes - written)));
+        }
+    }
+
+    struct Run {
+        bool ok = false;
+        double ms = 0;
+        long peakRssKb = 0;
+        double peakHeapMb = 0;
+    };
+
+    struct ChildReport {
+        double ms;
+        size_t heapPeak;
+    };
+
+    // Runs job in a child; its exit status carries success, a pipe the time and heap peak
+    template <typename Job>
+    Run inChild(Job job) {
+        int pipeFds[2];
+        Run run;
+        if (::pipe(pipeFds) != 0) return run;
+
+        std::fflush(stdout);
+        pid_t child = ::fork();
+        if (child == 0) {
+            ::close(pipeFds[0]);
+            size_t heapBefore = g_heapBytes.load();
+            g_heapPeak.store(heapBefore);
+            Stopwatch timer;
+            bool ok = job();
+            ChildReport report{ timer.ms(), g_heapPeak.load() - heapBefore };
+            ssize_t ignored = ::write(pipeFds[1], &report, sizeof(report));
+            (void)ignored;
+            ::_exit(ok ? 0 : 1);
+        }
+        ::close(pipeFds[1]);
+        ChildReport report{};
+        if (::read(pipeFds[0], &report, sizeof(report)) == static_cast<ssize_t>(sizeof(report))) {
+            run.ms = report.ms;
+            run.peakHeapMb = static_cast<double>(report.heapPeak) / (1024.0 * 1024.0);
+        }
+        ::close(pipeFds[0]);
+
+        int status = 0;
+        struct rusage usage {};
+        ::wait4(child, &status, 0, &usage);
+        run.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        run.peakRssKb = usage.ru_maxrss;
+        return run;
+    }
+
+    void bench(const TempDir& root, size_t megabytes, long baselineKb) {
+        LoaderConfig config;
+        config.configFile = (root / "LuaLoader.toml").string();
+        config.configDir = root.str();
+        config.gameScriptPath = PathInfo("action/script", (root / "action/script").string(), root.str());
+        config.modulePath = PathInfo("action/script/lua", (root / "action/script/lua").string(), root.str());
+        config.backupHKSonLaunch = false;
+        config.backupHKSFolder = "backups";
+        config.backupDir = (root / "backups").string();
+
+        const fs::path hks = root / "action/script/c0000.hks";
+        const std::string injectionLine = "dofile('" + config.modulePath.absolutePath + "/_module_loader/module_loader_setup.lua')";
+        const size_t bytes = megabytes << 20;
+
+        writeHks(hks, bytes);
+        Run legacy = inChild([&] { return legacyInject(hks.string(), injectionLine); });
+        CHECK(legacy.ok);
+
+        writeHks(hks, bytes);
+        fs::remove_all(config.backupDir);
+        Run current = inChild([&] { return injectIntoHksFile(config); });
+        CHECK(current.ok);
+
+        // Original body kept whole behind the header, and no temp file left behind
+        CHECK(fs::file_size(hks) > bytes);
+        std::ifstream in(hks, std::ios::binary);
+        std::string head(4096, '\0');
+        in.read(&head[0], static_cast<std::streamsize>(head.size()));
+        CHECK(head.find(injectionLine) != std::string::npos);
+        for (const auto& entry : fs::directory_iterator(hks.parent_path())) {
+            CHECK_MSG(entry.path().extension() != ".tmp", entry.path().string());
+        }
+
+        // No full-file heap copy on the mapped path
+        CHECK(current.peakHeapMb < static_cast<double>(megabytes) / 4.0);
+
+        auto report = [&](const char* label, const Run& run) {
+            std::printf("  %4zu MB  %-20s %8.1f ms   peak RSS +%6.1f MB   peak heap %7.2f MB\n", megabytes, label,
+                run.ms, static_cast<double>(run.peakRssKb - baselineKb) / 1024.0, run.peakHeapMb);
+        };
+        report("read+concat+stream", legacy);
+        report("mapped+temp+rename", current);
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    setSilentMode(true);
+
+    // What a child costs before it touches the file
+    Run idle = inChild([] { return true; });
+
+    // The mapped path's RSS is file-backed pages of its two read-only views (the
+    // pre-injection backup maps the source too); its time includes that backup and an fsync
+    std::printf("HKS injection (peak RSS above an idle child's %.1f MB)\n", static_cast<double>(idle.peakRssKb) / 1024.0);
+    for (size_t megabytes : full ? std::vector<size_t>{ 100, 500 } : std::vector<size_t>{ 32, 128 }) {
+        TempDir root("hks-inject");
+        bench(root, megabytes, idle.peakRssKb);
+    }
+
+    shutdownLogger();
+    return finish("bench_hks_inject");
+}
@@ -0,0 +1,106 @@
+// =============================================
+// File: tests/bench_hks_targets.cpp
+// Category: Benchmark
+// Purpose: First injection into 1-64 synthetic behaviour scripts through
+//          injectIntoHksFiles: wall time against the sum and the maximum of the
+//          per-target durations, on the real disk and with a simulated slow flush.
+//          Wall close to the sum means the targets ran one after another; close
+//          to the maximum means the step scales with the slowest file.
+// =============================================
+#include "TestSupport.h"
+#include "HksInjector.h"
+#include "WorkerPool.h"
+#include "Logger.h"
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace TestSupport;
+
+namespace {
+
+    std::string makeScript(size_t bytes) {
+        std::string script;
+        for (size_t i = 0; script.size() < bytes; ++i) {
+            script += "function act_" + std::to_string(i) + "(ai) if ai then env(ai, " + std::to_string(i % 997) + ") end end\n";
+        }
+        return script;
+    }
+
+    struct Timing {
+        double wallMs = 0;
+        double sumMs = 0;
+        double maxMs = 0;
+    };
+
+    Timing injectTargets(size_t targets, const std::string& script, int flushDelayMs) {
+        TempDir root("hks-targets");
+        const fs::path scripts = root / "action/script";
+        fs::create_directories(scripts / "lua");
+        for (size_t i = 0; i < targets; ++i) {
+            std::string number = std::to_string(i);
+            writeText(scripts / ("c" + std::string(number.size() < 4 ? 4 - number.size() : 0, '0') + number + ".hks"), script);
+        }
+
+        LoaderConfig config;
+        config.configFile = (root / "LuaLoader.toml").string();
+        config.configDir = root.str();
+        config.gameScriptPath = PathInfo("action/script", scripts.string(), root.str());
+        config.modulePath = PathInfo("action/script/lua", (scripts / "lua").string(), root.str());
+        config.hksTargets = { "c*.hks" };
+        config.backupHKSonLaunch = false;
+        config.backupHKSFolder = "backups";
+        config.backupDir = (root / "backups").string();
+
+        Win32Stub::delayFlushes(flushDelayMs);
+        std::vector<HksTargetResult> results;
+        Stopwatch timer;
+        bool ok = injectIntoHksFiles(config, results);
+        Timing timing;
+        timing.wallMs = timer.ms();
+        Win32Stub::resetFaults();
+
+        CHECK(ok);
+        CHECK(results.size() == targets);
+        for (const auto& result : results) {
+            CHECK_MSG(result.integrated && result.injected, result.path);
+            timing.sumMs += result.durationMs;
+            timing.maxMs = std::max(timing.maxMs, result.durationMs);
+        }
+        return timing;
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    const size_t scriptBytes = full ? (4u << 20) : (256u << 10);
+    const std::string script = makeScript(scriptBytes);
+    const size_t workers = getDefaultWorkerCount();
+    setSilentMode(true);
+
+    std::printf("HKS multi-target injection (%.2f MB scripts, %zu workers, %u hardware threads)\n",
+        static_cast<double>(scriptBytes) / (1024.0 * 1024.0), workers, std::thread::hardware_concurrency());
+
+    // The simulated flush stands in for a disk slower than this sandbox's; every
+    // target pays it on its backup, its temp file and its rename
+    for (int flushDelayMs : { 0, 5 }) {
+        std::printf("  flush %s\n", flushDelayMs ? "+5 ms (simulated)" : "as measured");
+        std::printf("    targets   wall (ms)   sum (ms)   max (ms)   wall/sum   wall/max\n");
+        for (size_t targets : { 1, 4, 16, 64 }) {
+            Timing timing = injectTargets(targets, script, flushDelayMs);
+            std::printf("    %7zu   %9.1f   %8.1f   %8.1f   %8.2f   %8.2f\n", targets, timing.wallMs, timing.sumMs,
+                timing.maxMs, timing.wallMs / timing.sumMs, timing.wallMs / timing.maxMs);
+
+            // Targets wait on the disk in parallel: with enough of them the step
+            // takes well under the serial sum. Backups share the store lock, so
+            // the wall cannot fall all the way to the slowest target.
+            if (flushDelayMs > 0 && targets >= 16) {
+                CHECK_MSG(timing.wallMs < timing.sumMs / 2.0, std::to_string(targets) + " targets ran serially");
+            }
+        }
+    }
+
+    shutdownLogger();
+    return finish("bench_hks_targets");
+}
@@ -0,0 +1,100 @@
+// =============================================
+// File: tests/bench_injection_detect.cpp
+// Category: Benchmark
+// Purpose: checkInjectionStatus (one Aho-Corasick pass, header region first) against
+//          the six std::string::find passes it replaced, on 1-100 MB synthetic HKS files.
+// =============================================
+#include "TestSupport.h"
+#include "HksInjector.h"
+#include "Logger.h"
+
+using namespace TestSupport;
+
+namespace {
+
+    // The detector before the single-pass matcher: one full find per signature
+    InjectionStatus legacyCheckInjectionStatus(const std::string& fileContent, const std::string& injectionLine) {
+        if (fileContent.find(injectionLine) != std::string::npos) {
+            return { true, injectionLine, "exact current injection", {}, std::string::npos };
+        }
+        if (fileContent.find("module_loader_setup.lua") != std::string::npos) {
+            return { true, "module_loader_setup.lua", "module loader reference", {}, std::string::npos };
+        }
+        std::vector<std::pair<std::string, std::string>> legacyPatterns = {
+            {"-- Lua Loader by Malice", "legacy header signature"},
+            {"dofile('", "legacy dofile single quotes"},
+            {"dofile(\"", "legacy dofile double quotes"},
+            {"_module_loader", "legacy module loader reference"}
+        };
+        for (const auto& [pattern, description] : legacyPatterns) {
+            if (fileContent.find(pattern) != std::string::npos) {
+                return { true, pattern, description, {}, std::string::npos };
+            }
+        }
+        return { false, "", "", {}, std::string::npos };
+    }
+
+    const std::string INJECTION_LINE = "dofile('C:/Games/mods/action/script/lua/_module_loader/module_loader_setup.lua')";
+
+    // Game-script-like filler: plenty of 'd', "do" and '_' so no pattern is trivially absent
+    std::string makeBody(size_t bytes) {
+        std::string body;
+        body.reserve(bytes + 128);
+        for (size_t i = 0; body.size() < bytes; ++i) {
+            body += "function act_" + std::to_string(i) + "(ai_param, do_flag) if do_flag then env(ai_param, " +
+                std::to_string(i % 997) + ") end return dodge_state end\n";
+        }
+        return body;
+    }
+
+    struct Scenario {
+        const char* label;
+        std::string content;
+    };
+
+    void bench(size_t megabytes, int runs) {
+        std::string body = makeBody(megabytes << 20);
+        std::vector<Scenario> scenarios = {
+            { "injected (line at top)", "-- Lua Loader by Malice\n" + INJECTION_LINE + "\n" + body },
+            { "clean (no signature)", body },
+            { "legacy signature at end", body + "dofile(\"old/loader.lua\")\n" },
+        };
+
+        for (const Scenario& scenario : scenarios) {
+            std::vector<double> currentSamples, legacySamples;
+            InjectionStatus current{}, legacy{};
+            for (int i = 0; i < runs; ++i) {
+                Stopwatch timer;
+                current = checkInjectionStatus(scenario.content, INJECTION_LINE);
+                currentSamples.push_back(timer.ms());
+
+                timer.restart();
+                legacy = legacyCheckInjectionStatus(scenario.content, INJECTION_LINE);
+                legacySamples.push_back(timer.ms());
+            }
+
+            // Same verdict as the code it replaced
+            CHECK(current.isInjected == legacy.isInjected);
+            CHECK_MSG(current.matchType == legacy.matchType, current.matchType + " vs " + legacy.matchType);
+            CHECK(current.matchedPattern == legacy.matchedPattern);
+
+            double currentMs = percentile(currentSamples, 0.5);
+            double legacyMs = percentile(legacySamples, 0.5);
+            std::printf("  %3zu MB  %-26s single pass %8.2f ms   six finds %8.2f ms   (%zu hits reported)\n",
+                megabytes, scenario.label, currentMs, legacyMs, current.matches.size());
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    setSilentMode(true);
+
+    std::printf("injection detection (median of %d runs)\n", full ? 9 : 3);
+    for (size_t megabytes : { 1, 10, 100 }) {
+        bench(megabytes, full ? 9 : 3);
+    }
+
+    shutdownLogger();
+    return finish("bench_injection_detect");
+}
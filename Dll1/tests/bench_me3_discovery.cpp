@@ -0,0 +1,106 @@
+// =============================================
+// File: tests/bench_me3_discovery.cpp
+// Category: Benchmark
+// Purpose: .me3 discovery on a synthetic 50k-entry DLL directory: full directory
+//          scan versus revalidating the discovery cache with stats.
+// =============================================
+#include "TestSupport.h"
+#include "Me3Discovery.h"
+#include "Logger.h"
+#include <fstream>
+#include <unistd.h>
+
+using namespace TestSupport;
+
+namespace {
+
+    struct Layout {
+        TempDir root{ "me3-discovery" };
+        // The DLL directory is the crowded one; the .me3 sits one level up, so
+        // the scan has to exhaust it before moving on
+        fs::path gameDir = root / "game";
+        fs::path dllDir = gameDir / "mods";
+        fs::path dll = dllDir / "LuaLoader.dll";
+        fs::path me3 = gameDir / "loader.me3";
+
+        explicit Layout(int entryCount) {
+            fs::create_directories(dllDir);
+            for (int i = 0; i < entryCount; ++i) {
+                std::ofstream(dllDir / ("asset_" + std::to_string(i) + ".bin"));
+            }
+            writeText(dll, "MZ");
+            writeText(me3, "profileVersion = \"v1\"\n");
+        }
+    };
+
+    // What initializePaths() does on a cache miss
+    bool discover(const Layout& layout, const std::vector<fs::path>& searchPaths, Me3Discovery& discovery) {
+        discovery = Me3Discovery();
+        std::vector<PathStamp> dirStamps = stampSearchDirectories(layout.dll.string(), searchPaths);
+        fs::path me3Path = scanForMe3(searchPaths, dirStamps, discovery);
+        if (me3Path.empty()) {
+            return false;
+        }
+        discovery.me3Path = me3Path.string();
+        discovery.me3Stamp = stampPath(discovery.me3Path);
+        discovery.configPath = (me3Path.parent_path() / "LuaLoader.toml").string();
+        return saveMe3Discovery(layout.dll.string(), discovery);
+    }
+}
+
+int main(int argc, char** argv) {
+    const bool full = hasFlag(argc, argv, "--full");
+    const int entryCount = 50000;
+    const int scanRuns = full ? 20 : 5;
+    const int cachedRuns = full ? 2000 : 200;
+
+    setSilentMode(true);
+    Stopwatch setup;
+    Layout layout(entryCount);
+    double setupMs = setup.ms();
+    CHECK(::chdir(layout.root.str().c_str()) == 0);
+    std::vector<fs::path> searchPaths = getMe3SearchPaths(layout.dll);
+
+    std::vector<double> scanSamples;
+    Me3Discovery scanned;
+    for (int i = 0; i < scanRuns; ++i) {
+        Stopwatch timer;
+        CHECK(discover(layout, searchPaths, scanned));
+        scanSamples.push_back(timer.ms());
+    }
+    CHECK(scanned.me3Path == layout.me3.string());
+    CHECK(scanned.searchedDirs.size() == 2);
+
+    std::vector<double> cachedSamples;
+    for (int i = 0; i < cachedRuns; ++i) {
+        Me3Discovery cached;
+        Stopwatch timer;
+        bool hit = loadMe3Discovery(layout.dll.string(), searchPaths, cached);
+        cachedSamples.push_back(timer.ms());
+        CHECK(hit);
+        CHECK(cached.me3Path == layout.me3.string());
+    }
+
+    // Adding an entry to a scanned directory invalidates the cache
+    std::ofstream(layout.dllDir / "new_asset.bin");
+    Me3Discovery stale;
+    CHECK(!loadMe3Discovery(layout.dll.string(), searchPaths, stale));
+
+    // A .me3 dropped into a directory searched earlier wins after the rescan
+    Me3Discovery rescanned;
+    CHECK(discover(layout, searchPaths, rescanned));
+    writeText(layout.dllDir / "closer.me3", "profileVersion = \"v1\"\n");
+    CHECK(!loadMe3Discovery(layout.dll.string(), searchPaths, stale));
+    CHECK(discover(layout, searchPaths, rescanned));
+    CHECK(rescanned.me3Path == (layout.dllDir / "closer.me3").string());
+    CHECK(loadMe3Discovery(layout.dll.string(), searchPaths, stale));
+
+    std::printf(".me3 discovery (%d entries in the DLL directory, setup %.0f ms)\n", entryCount, setupMs);
+    std::printf("  directory scan:    median %.3f ms  p95 %.3f ms  (%d runs)\n",
+        percentile(scanSamples, 0.5), percentile(scanSamples, 0.95), scanRuns);
+    std::printf("  cache revalidate:  median %.3f ms  p95 %.3f ms  (%d runs)\n",
+        percentile(cachedSamples, 0.5), percentile(cachedSamples, 0.95), cachedRuns);
+
+    shutdownLogger();
+    return finish("bench_me3_discovery");
+}
@@ -0,0 +1,43 @@
+// =============================================
+// File: tests/log_alloc_stripped.cpp
+// Category: Test
+// Purpose: LOG_AT sites built the way a release build strips them
+//          (LUALOADER_MIN_LOG_LEVEL=2, set for this file only); driven by test_log_alloc.
+// =============================================
+#include "Logger.h"
+#include <string>
+
+#if LUALOADER_MIN_LOG_LEVEL != 2
+#error "log_alloc_stripped.cpp must be built with LUALOADER_MIN_LOG_LEVEL=2"
+#endif
+
+struct StrippedSiteCounts {
+    int traceEvaluations = 0;
+    int debugEvaluations = 0;
+    int infoEvaluations = 0;
+    size_t strippedAllocations = 0;
+};
+
+// test_log_alloc.cpp
+size_t currentThreadAllocations();
+
+namespace {
+    std::string counted(int& evaluations) {
+        ++evaluations;
+        return std::string(64, 'z');
+    }
+}
+
+StrippedSiteCounts logStrippedSites() {
+    StrippedSiteCounts counts;
+
+    size_t before = currentThreadAllocations();
+    for (int i = 0; i < 100; ++i) {
+        LOG_AT(LOG_TRACE, "Stripped", "trace ", i, ": ", counted(counts.traceEvaluations));
+        LOG_AT(LOG_DEBUG, "Stripped", "debug ", i, ": ", counted(counts.debugEvaluations));
+    }
+    counts.strippedAllocations = currentThreadAllocations() - before;
+
+    LOG_AT(LOG_INFO, "Stripped", "info: ", counted(counts.infoEvaluations));
+    return counts;
+}
@@ -0,0 +1,208 @@
+// =============================================
+// File: tests/test_atomic_write.cpp
+// Category: Test
+// Purpose: AtomicFileWriter and AtomicWriteBatch under injected faults (full disk,
+//          failed flush, rename and create) and concurrent writers: the target keeps
+//          its old contents or gets the new ones whole, and no temp file is left.
+// =============================================
+#include "TestSupport.h"
+#include "FileIO.h"
+#include "Logger.h"
+#include <windows.h>
+#include <thread>
+
+using namespace TestSupport;
+
+namespace {
+
+    const std::string OLD_CONTENT = "-- original c0000.hks\n";
+    const std::string NEW_CONTENT = std::string(4096, 'n') + "\n";
+
+    size_t tempFiles(const fs::path& dir) {
+        size_t count = 0;
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            count += entry.path().extension() == ".tmp" ? 1 : 0;
+        }
+        return count;
+    }
+
+    struct Scratch {
+        TempDir root{ "atomic-write" };
+        fs::path target = root / "c0000.hks";
+
+        Scratch() {
+            writeText(target, OLD_CONTENT);
+        }
+
+        // The failed write left the target and the directory as they were
+        void checkUntouched(const char* what) {
+            CHECK_MSG(readText(target) == OLD_CONTENT, what);
+            CHECK_MSG(tempFiles(root.path()) == 0, what);
+            Win32Stub::resetFaults();
+        }
+    };
+
+    bool writeNew(const fs::path& target, FsyncPolicy policy, std::string& error) {
+        AtomicFileWriter writer(target.string(), policy);
+        bool ok = writer.open() && writer.write(NEW_CONTENT.substr(0, 100)) && writer.write(NEW_CONTENT.substr(100)) && writer.commit();
+        error = writer.lastError();
+        return ok;
+    }
+
+    void testTempNameSkipsTakenNames() {
+        Scratch scratch;
+        // Leftovers from a crashed writer hold the names this process would try
+        // first; they are skipped, not truncated
+        const std::string prefix = scratch.target.string() + "." + std::to_string(GetCurrentProcessId()) + ".";
+        for (int n = 0; n < 4; ++n) {
+            writeText(prefix + std::to_string(n) + ".tmp", "leftover");
+        }
+
+        std::string error;
+        CHECK_MSG(writeNew(scratch.target, FsyncPolicy::Always, error), error);
+        CHECK(readText(scratch.target) == NEW_CONTENT);
+        for (int n = 0; n < 4; ++n) {
+            CHECK(readText(prefix + std::to_string(n) + ".tmp") == "leftover");
+        }
+    }
+
+    void testConcurrentWritersDoNotShareTemp() {
+        Scratch scratch;
+        AtomicFileWriter first(scratch.target.string());
+        AtomicFileWriter second(scratch.target.string());
+        CHECK(first.open() && second.open());
+        CHECK(first.write("first\n") && second.write("second\n"));
+        CHECK(tempFiles(scratch.root.path()) == 2);
+
+        // Each commit publishes its own complete file; the last one wins
+        CHECK(first.commit());
+        CHECK(readText(scratch.target) == "first\n");
+        CHECK(second.commit());
+        CHECK(readText(scratch.target) == "second\n");
+        CHECK(tempFiles(scratch.root.path()) == 0);
+
+        // Many threads at once: every commit succeeds and the result is one of them, whole
+        std::vector<std::thread> threads;
+        std::atomic<int> failures{ 0 };
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < 25; ++i) {
+                    std::string error;
+                    if (!writeFileAtomic(scratch.target.string(), std::string(1000 + t, static_cast<char>('a' + t)), FsyncPolicy::Never, error)) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CHECK(failures == 0);
+        std::string result = readText(scratch.target);
+        CHECK(result.size() >= 1000 && result.size() < 1008);
+        CHECK(result == std::string(result.size(), result[0]));
+        CHECK(tempFiles(scratch.root.path()) == 0);
+    }
+
+    void testDiskFull() {
+        for (long long budget : { 0LL, 1LL, 100LL, 4000LL }) {
+            Scratch scratch;
+            Win32Stub::failWritesAfter(budget);
+            std::string error;
+            CHECK(!writeNew(scratch.target, FsyncPolicy::Always, error));
+            CHECK(error.find("Write") != std::string::npos);
+            scratch.checkUntouched("disk full");
+        }
+    }
+
+    void testFlushFailure() {
+        Scratch scratch;
+        Win32Stub::failNextFlushes(1);
+        std::string error;
+        CHECK(!writeNew(scratch.target, FsyncPolicy::Always, error));
+        CHECK(error.find("Flush") != std::string::npos);
+        scratch.checkUntouched("flush");
+
+        // Without durability the flush is skipped entirely
+        Win32Stub::failNextFlushes(1);
+        CHECK_MSG(writeNew(scratch.target, FsyncPolicy::Never, error), error);
+        CHECK(readText(scratch.target) == NEW_CONTENT);
+        Win32Stub::resetFaults();
+    }
+
+    void testRenameFailure() {
+        Scratch scratch;
+        Win32Stub::failNextMoves(1);
+        std::string error;
+        CHECK(!writeNew(scratch.target, FsyncPolicy::Always, error));
+        CHECK(error.find("Unable to replace") != std::string::npos);
+        scratch.checkUntouched("rename");
+    }
+
+    void testCreateFailure() {
+        Scratch scratch;
+        Win32Stub::failNextCreates(1);
+        std::string error;
+        CHECK(!writeNew(scratch.target, FsyncPolicy::Always, error));
+        CHECK(error.find("temporary file") != std::string::npos);
+        scratch.checkUntouched("create");
+
+        // An error other than "name taken" is not retried under another name
+        Win32Stub::failNextCreates(1);
+        AtomicFileWriter writer(scratch.target.string());
+        CHECK(!writer.open());
+        CHECK(Win32Stub::faults().failCreates.load() == 0);
+        scratch.checkUntouched("create, no retry");
+    }
+
+    void testBatchFailures() {
+        // A failure before the renames leaves every target untouched
+        auto run = [](const char* what, auto injectFault) {
+            TempDir root("atomic-batch");
+            std::vector<fs::path> targets = { root / "a.hks", root / "b.hks", root / "c.hks" };
+            AtomicWriteBatch batch(FsyncPolicy::Always);
+            for (const auto& target : targets) {
+                writeText(target, OLD_CONTENT);
+                batch.add(target.string(), NEW_CONTENT);
+            }
+            injectFault();
+            CHECK_MSG(!batch.commit(), what);
+            Win32Stub::resetFaults();
+            for (const auto& target : targets) {
+                CHECK_MSG(readText(target) == OLD_CONTENT, what);
+            }
+            CHECK_MSG(tempFiles(root.path()) == 0, what);
+        };
+        run("batch: disk full on the second file", [] { Win32Stub::failWritesAfter(static_cast<long long>(NEW_CONTENT.size()) + 10); });
+        run("batch: second flush fails", [] { Win32Stub::failNextFlushes(2); });
+        run("batch: first create fails", [] { Win32Stub::failNextCreates(1); });
+
+        // A failed rename keeps the targets renamed before it, as documented
+        TempDir root("atomic-batch");
+        std::vector<fs::path> targets = { root / "a.hks", root / "b.hks" };
+        AtomicWriteBatch batch(FsyncPolicy::Always);
+        for (const auto& target : targets) {
+            writeText(target, OLD_CONTENT);
+            batch.add(target.string(), NEW_CONTENT);
+        }
+        Win32Stub::failNextMoves(1);
+        CHECK(!batch.commit());
+        Win32Stub::resetFaults();
+        CHECK(readText(targets[0]) == OLD_CONTENT);
+        CHECK(readText(targets[1]) == OLD_CONTENT);
+        CHECK(tempFiles(root.path()) == 0);
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    testTempNameSkipsTakenNames();
+    testConcurrentWritersDoNotShareTemp();
+    testDiskFull();
+    testFlushFailure();
+    testRenameFailure();
+    testCreateFailure();
+    testBatchFailures();
+    shutdownLogger();
+    return finish("test_atomic_write");
+}
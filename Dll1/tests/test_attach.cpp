@@ -0,0 +1,147 @@
+// =============================================
+// File: tests/test_attach.cpp
+// Category: Test
+// Purpose: Fake module-attach driver: each launch is a forked process that calls
+//          DllMain(DLL_PROCESS_ATTACH) and runs the setup script the way the HKS does.
+//          Reports attach wall time and checks the session barrier and flag token.
+// =============================================
+#include "TestSupport.h"
+#include "FakeGame.h"
+#include "FlagFile.h"
+#include "InitWorker.h"
+#include "BackgroundIO.h"
+#include "Logger.h"
+#include <windows.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+BOOL APIENTRY DllMain(HMODULE hMod, DWORD reason, LPVOID reserved);
+
+using namespace TestSupport;
+
+namespace {
+
+    enum class HksTiming {
+        AfterInit,      // The HKS first runs once initialization is done
+        DuringInit,     // The HKS runs right after attach, while the worker is busy
+    };
+
+    struct Launch {
+        const char* label;
+        HksTiming timing = HksTiming::AfterInit;
+        bool crash = false;                     // Exit without DLL_PROCESS_DETACH
+        InitState expected = InitState::Succeeded;
+    };
+
+    // One game launch in a child process; returns the child's failure count
+    int launch(const FakeGame& game, const Launch& options) {
+        std::fflush(stdout);
+        pid_t child = ::fork();
+        if (child == 0) {
+            // The exit status reports this launch's checks only
+            TestSupport::failures() = 0;
+
+            // Keep the loader's console banner out of the report
+            FILE* report = ::fdopen(::dup(STDOUT_FILENO), "w");
+            int devNull = ::open("/dev/null", O_WRONLY);
+            ::dup2(devNull, STDOUT_FILENO);
+            setSilentMode(true);
+            Win32Stub::setModuleFileName(game.dll.string());
+
+            Stopwatch attach;
+            DllMain(reinterpret_cast<HMODULE>(1), DLL_PROCESS_ATTACH, nullptr);
+            double attachMs = attach.ms();
+            // From here until it is done the init worker holds the DLL, so a
+            // FreeLibrary during startup cannot unmap the code it runs
+            CHECK(Win32Stub::moduleReferences() >= 1);
+
+            // Attach alone must already have replaced the last launch's session
+            std::string session = readText(game.sessionFile());
+            CHECK(session.find("PID:" + std::to_string(::getpid()) + "\n") != std::string::npos);
+            CHECK(session.find("SESSION:" + getSessionToken() + "\n") != std::string::npos);
+
+            if (options.timing == HksTiming::AfterInit) {
+                CHECK(waitForInitialization(10000) == options.expected);
+            }
+
+            Stopwatch hks;
+            LuaRun first = runLuaScript(game.script());
+            double hksMs = hks.ms();
+            CHECK_MSG(first.ok, first.error);
+            // Released by the worker's ready/failed state, not by the script's timeout
+            CHECK(hksMs < 5000.0);
+            CHECK(waitForInitialization(10000) == options.expected);
+
+            // The HKS runs again later in the same launch (e.g. a script reload)
+            LuaRun second = runLuaScript(game.script());
+            CHECK_MSG(second.ok, second.error);
+
+            std::fprintf(report, "  %-34s attach %.3f ms, first HKS run %.2f ms (init %.2f ms)\n",
+                options.label, attachMs, hksMs, getInitializationDurationMs());
+            std::fflush(report);
+
+            if (!options.crash) {
+                // Let queued launch backups land before the process "exits"
+                CHECK(waitForBackgroundIdle(5000));
+                DllMain(reinterpret_cast<HMODULE>(1), DLL_PROCESS_DETACH, nullptr);
+                // Every thread the loader started has left and let go of the DLL
+                CHECK(Win32Stub::waitForModuleReleased(5000));
+            }
+            ::_exit(TestSupport::failures());
+        }
+
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+    }
+}
+
+int main() {
+    FakeGame game;
+    CHECK(::chdir(game.root.str().c_str()) == 0);
+    const size_t moduleCount = FakeGame::MODULE_COUNT;
+
+    std::printf("fake attach driver\n");
+
+    // 1. First launch: generates the script, the HKS runs after init
+    CHECK(launch(game, { "first launch" }) == 0);
+    CHECK(game.loadCount() == moduleCount);
+
+    // 2. Unchanged launch, HKS runs during init; the process then dies without detaching,
+    //    leaving a "ready" session and a flag file behind
+    CHECK(launch(game, { "HKS during init, then crash", HksTiming::DuringInit, true }) == 0);
+    CHECK(game.loadCount() == 2 * moduleCount);
+    CHECK(readText(game.sessionFile()).find("STATE:ready") != std::string::npos);
+    CHECK(fs::exists(game.flagFile()));
+
+    // 3. Next launch must neither trust the stale "ready" state nor the stale flag
+    CHECK(launch(game, { "after crash, HKS during init", HksTiming::DuringInit }) == 0);
+    CHECK(game.loadCount() == 3 * moduleCount);
+
+    // Only the token counts: a flag from an older launch is ignored whatever PID it names
+    writeText(game.flagFile(), "PID:" + std::to_string(::getpid()) + "\nSESSION:" + std::to_string(::getpid()) + "-1\n");
+    CHECK(launch(game, { "flag with an older token" }) == 0);
+    CHECK(game.loadCount() == 4 * moduleCount);
+
+    // 4. backupHKSonLaunch backs up every launch: the changed TOML takes the
+    //    full path, the launch after it the fast path, and both queue a copy
+    game.writeConfig(true);
+    CHECK(launch(game, { "backupHKSonLaunch, full path" }) == 0);
+    CHECK(!game.tookFastPath());
+    CHECK(game.launchBackups() == 1);
+    CHECK(launch(game, { "backupHKSonLaunch, fast path" }) == 0);
+    CHECK(game.tookFastPath());
+    CHECK(game.launchBackups() == 2);
+
+    // 5. Initialization fails (config gone): the waiting script is released by
+    //    STATE:failed rather than its timeout, and runs the last generated setup
+    fs::remove(game.modDir / "LuaLoader.toml");
+    fs::remove(game.modDir / "LuaLoader.discovery");
+    CHECK(launch(game, { "failed init, HKS during init", HksTiming::DuringInit, false, InitState::Failed }) == 0);
+    CHECK(readText(game.sessionFile()).find("STATE:failed") != std::string::npos);
+    CHECK(readText(game.root / "CONOUT$").find("Loader initialization failed") != std::string::npos);
+
+    CHECK(readText(game.root / "CONOUT$").find("still running") == std::string::npos);
+    return finish("test_attach");
+}
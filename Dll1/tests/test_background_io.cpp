@@ -0,0 +1,203 @@
+// =============================================
+// File: tests/test_background_io.cpp
+// Category: Test
+// Purpose: Background I/O lane: submit never blocks on a busy lane, queued jobs
+//          start promptly once idle or released from a hold, the lane holds the
+//          module only while it has work, a same-named job replaces the waiting
+//          task, and stopping cancels what has not started.
+// =============================================
+#include "TestSupport.h"
+#include "BackgroundIO.h"
+#include "Logger.h"
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace TestSupport;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // A job that runs until release()
+    class Gate {
+    public:
+        std::function<bool()> job() {
+            return [this]() {
+                std::unique_lock<std::mutex> lock(mutex_);
+                started_ = true;
+                changed_.notify_all();
+                changed_.wait(lock, [this]() { return open_; });
+                return true;
+            };
+        }
+
+        bool waitStarted() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return changed_.wait_for(lock, std::chrono::seconds(5), [this]() { return started_; });
+        }
+
+        void release() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+            changed_.notify_all();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        bool started_ = false;
+        bool open_ = false;
+    };
+
+    // Submit cost while the lane is busy: the caller is a startup thread and must not wait
+    void testSubmitNeverBlocks() {
+        Gate gate;
+        CHECK(submitBackgroundJob("busy", gate.job()));
+        CHECK(gate.waitStarted());
+
+        std::vector<double> submitUs;
+        for (int i = 0; i < 64; ++i) {
+            Stopwatch timer;
+            CHECK(submitBackgroundJob("queued-" + std::to_string(i), []() { return true; }));
+            submitUs.push_back(timer.us());
+        }
+        // The queue is bounded; overflow is refused, also without waiting
+        size_t rejectedBefore = getBackgroundIOStats().rejected;
+        Stopwatch overflow;
+        CHECK(!submitBackgroundJob("overflow", []() { return true; }));
+        submitUs.push_back(overflow.us());
+        CHECK(getBackgroundIOStats().rejected == rejectedBefore + 1);
+
+        gate.release();
+        CHECK(waitForBackgroundIdle(5000));
+        double p99 = percentile(submitUs, 0.99);
+        std::printf("  submit on a busy lane: p50 %.1f us, p99 %.1f us\n", percentile(submitUs, 0.5), p99);
+        CHECK(p99 < 5000.0);
+    }
+
+    // Time from submit (or from releasing the last hold) to the job starting
+    void testStartLatency() {
+        std::vector<double> idleMs;
+        for (int i = 0; i < 100; ++i) {
+            std::atomic<double> startedAfter{ -1.0 };
+            Clock::time_point submitted = Clock::now();
+            CHECK(submitBackgroundJob("latency", [&startedAfter, submitted]() {
+                startedAfter = msSince(submitted);
+                return true;
+            }));
+            CHECK(waitForBackgroundIdle(5000));
+            idleMs.push_back(startedAfter.load());
+        }
+
+        std::vector<double> holdMs;
+        for (int i = 0; i < 20; ++i) {
+            std::atomic<double> startedAfter{ -1.0 };
+            Clock::time_point released;
+            {
+                BackgroundIOHold hold;
+                CHECK(submitBackgroundJob("held", [&startedAfter, &released]() {
+                    startedAfter = msSince(released);
+                    return true;
+                }));
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                CHECK(startedAfter.load() < 0.0);       // Not while held
+                released = Clock::now();
+            }
+            CHECK(waitForBackgroundIdle(5000));
+            holdMs.push_back(startedAfter.load());
+        }
+
+        double idleP99 = percentile(idleMs, 0.99);
+        double holdP99 = percentile(holdMs, 0.99);
+        std::printf("  start latency, idle lane:    p50 %.3f ms, p99 %.3f ms\n", percentile(idleMs, 0.5), idleP99);
+        std::printf("  start latency, hold release: p50 %.3f ms, p99 %.3f ms\n", percentile(holdMs, 0.5), holdP99);
+        CHECK(idleMs.front() >= 0.0 && holdMs.front() >= 0.0);
+        CHECK(idleP99 < 100.0);
+        CHECK(holdP99 < 100.0);
+    }
+
+    // The lane exists only while there is work, and holds the module meanwhile
+    void testLaneReleasesModuleWhenIdle() {
+        CHECK(Win32Stub::waitForModuleReleased(5000));
+        Gate gate;
+        CHECK(submitBackgroundJob("pinned", gate.job()));
+        CHECK(gate.waitStarted());
+        CHECK(Win32Stub::moduleReferences() == 1);
+        gate.release();
+        CHECK(waitForBackgroundIdle(5000));
+        CHECK(Win32Stub::waitForModuleReleased(5000));
+
+        // A new lane starts for the next job
+        std::atomic<int> ran{ 0 };
+        CHECK(submitBackgroundJob("after-idle", [&ran]() { ran++; return true; }));
+        CHECK(waitForBackgroundIdle(5000));
+        CHECK(ran == 1);
+        CHECK(Win32Stub::waitForModuleReleased(5000));
+    }
+
+    void testSameNameReplacesQueuedTask() {
+        std::atomic<int> ran{ 0 };
+        std::atomic<int> version{ 0 };
+        BackgroundIOStats before = getBackgroundIOStats();
+        {
+            BackgroundIOHold hold;
+            for (int v = 1; v <= 3; ++v) {
+                CHECK(submitBackgroundJob("backup:c0000.hks", [&ran, &version, v]() {
+                    ran++;
+                    version = v;
+                    return true;
+                }));
+            }
+        }
+        CHECK(waitForBackgroundIdle(5000));
+        BackgroundIOStats after = getBackgroundIOStats();
+        CHECK(ran == 1);
+        CHECK(version == 3);                            // The newest closure runs
+        CHECK(after.replaced == before.replaced + 2);
+        CHECK(after.completed == before.completed + 1);
+    }
+
+    // Runs last: the lane does not restart after stopBackgroundIO()
+    void testStopCancelsQueued() {
+        Gate gate;
+        CHECK(submitBackgroundJob("running", gate.job()));
+        CHECK(gate.waitStarted());
+        std::atomic<int> ran{ 0 };
+        for (int i = 0; i < 3; ++i) {
+            CHECK(submitBackgroundJob("pending-" + std::to_string(i), [&ran]() { ran++; return true; }));
+        }
+
+        BackgroundIOStats before = getBackgroundIOStats();
+        Stopwatch timer;
+        stopBackgroundIO();
+        CHECK(timer.ms() < 50.0);                       // Stopping never waits for the running job
+        CHECK(getBackgroundIOStats().cancelled == before.cancelled + 3);
+        CHECK(!waitForBackgroundIdle(20));              // Still running
+        CHECK(Win32Stub::moduleReferences() == 1);      // The running job keeps the DLL mapped
+        gate.release();
+        CHECK(waitForBackgroundIdle(5000));
+        CHECK(Win32Stub::waitForModuleReleased(5000));  // Then the lane leaves and lets go of it
+        CHECK(ran == 0);
+        CHECK(getBackgroundIOStats().completed == before.completed + 1);
+        CHECK(!submitBackgroundJob("late", []() { return true; }));
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    std::printf("background I/O lane\n");
+    testSubmitNeverBlocks();
+    testStartLatency();
+    testLaneReleasesModuleWhenIdle();
+    testSameNameReplacesQueuedTask();
+    testStopCancelsQueued();
+    shutdownLogger();
+    return finish("test_background_io");
+}
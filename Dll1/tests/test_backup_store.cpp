@@ -0,0 +1,362 @@
+// =============================================
+// File: tests/test_backup_store.cpp
+// Category: Test
+// Purpose: Content-addressed backup store: retention by on-disk size with deltas
+//          and per script in a shared folder, lookup, restore and verification,
+//          and Cleanup restoring a script whose injection block lost its closing
+//          line from the pre-injection backup.
+// =============================================
+#include "TestSupport.h"
+#include "BackupStore.h"
+#include "ContentHash.h"
+#include "HksInjector.h"
+#include "Cleanup.h"
+#include "Logger.h"
+
+using namespace TestSupport;
+
+namespace {
+
+    std::string makeScript(int revision) {
+        std::string lua;
+        for (int i = 0; lua.size() < 100 * 1024; ++i) {
+            lua += "function act_" + std::to_string(i) + "(ai) return env(ai, " + std::to_string(i % 97) + ") end\n";
+        }
+        return lua + "-- revision " + std::to_string(revision) + "\n";
+    }
+
+    unsigned long long objectsBytes(const std::string& backupDir) {
+        unsigned long long total = 0;
+        for (const auto& entry : fs::directory_iterator(getBackupObjectsDir(backupDir))) {
+            total += entry.file_size();
+        }
+        return total;
+    }
+
+    // A size limit counts each stored object once, deltas at their own size plus
+    // their base, not the logical size of every catalog entry
+    void testSizeRetentionCountsStoredBytes() {
+        TempDir root("backup-prune");
+        const std::string backupDir = (root / "backups").string();
+        const fs::path source = root / "c0000.hks";
+
+        BackupRetention unlimited;
+        for (int revision = 0; revision < 10; ++revision) {
+            writeText(source, makeScript(revision));
+            BackupResult result;
+            CHECK(storeBackup(source.string(), backupDir, "launch", true, unlimited, result));
+            CHECK(result.delta == (revision > 0));
+        }
+        // The same content again only adds a catalog entry
+        BackupResult repeat;
+        CHECK(storeBackup(source.string(), backupDir, "launch", true, unlimited, repeat));
+        CHECK(repeat.deduplicated);
+
+        // Ten 100 KB revisions are 1 MB of logical size but one blob plus small deltas on disk
+        unsigned long long stored = objectsBytes(backupDir);
+        CHECK(stored < 200 * 1024);
+
+        BackupRetention bySize;
+        bySize.maxBytes = stored;
+        CHECK(pruneBackups(backupDir, bySize) == 0);
+
+        std::vector<BackupEntry> entries;
+        CHECK(readBackupCatalog(backupDir, entries));
+        CHECK(entries.size() == 11);
+
+        // Below the base blob's size only the newest entry survives, with its base
+        bySize.maxBytes = 1024;
+        CHECK(pruneBackups(backupDir, bySize) == 9);
+        entries.clear();
+        CHECK(readBackupCatalog(backupDir, entries));
+        CHECK(entries.size() == 2);
+        std::string error;
+        CHECK_MSG(verifyBackup(backupDir, entries.back(), error), error);
+    }
+
+    // Scripts sharing one backup folder are pruned separately, and each keeps
+    // the pre-injection backup Cleanup restores from
+    void testRetentionPerSource() {
+        TempDir root("backup-prune");
+        const std::string backupDir = (root / "backups").string();
+        const fs::path first = root / "c0000.hks";
+        const fs::path second = root / "c1000.hks";
+        BackupRetention keepOne;
+        keepOne.keepCount = 1;
+        BackupResult result;
+
+        writeText(first, makeScript(1));
+        CHECK(storeBackup(first.string(), backupDir, "injection", true, keepOne, result));
+        writeText(second, makeScript(11));
+        CHECK(storeBackup(second.string(), backupDir, "injection", true, keepOne, result));
+        CHECK(result.pruned == 0);
+
+        // Launches of one script never push out the other's backups
+        for (int launch = 2; launch <= 5; ++launch) {
+            writeText(first, makeScript(launch));
+            CHECK(storeBackup(first.string(), backupDir, "launch", true, keepOne, result));
+            CHECK(result.delta);
+            writeText(second, makeScript(10 + launch));
+            CHECK(storeBackup(second.string(), backupDir, "launch", false, keepOne, result));
+        }
+
+        std::vector<BackupEntry> entries;
+        CHECK(readBackupCatalog(backupDir, entries));
+        CHECK(entries.size() == 4);
+        for (const char* source : { "c0000.hks", "c1000.hks" }) {
+            size_t launches = 0, injections = 0;
+            for (const auto& entry : entries) {
+                if (entry.source != source) continue;
+                (entry.context == "injection" ? injections : launches)++;
+            }
+            CHECK_MSG(launches == 1 && injections == 1, source);
+        }
+
+        // The kept delta still has its base, which is also the injection blob
+        BackupEntry latest;
+        CHECK(findLatestBackup(backupDir, "c0000.hks", "launch", latest));
+        const fs::path output = root / "restored.hks";
+        CHECK(restoreBackup(backupDir, latest.hash, output.string()));
+        CHECK(readText(output) == makeScript(5));
+        CHECK(restoreLatestBackup(backupDir, "c0000.hks", "injection", output.string()));
+        CHECK(readText(output) == makeScript(1));
+        CHECK(restoreLatestBackup(backupDir, "c1000.hks", "injection", output.string()));
+        CHECK(readText(output) == makeScript(11));
+        CHECK(restoreLatestBackup(backupDir, "c1000.hks", "launch", output.string()));
+        CHECK(readText(output) == makeScript(15));
+
+        // Dropped blobs and links are gone: two full blobs, one launch blob, one delta
+        size_t objects = 0;
+        for (const auto& file : fs::directory_iterator(getBackupObjectsDir(backupDir))) {
+            objects += file.is_regular_file() ? 1 : 0;
+        }
+        CHECK(objects == 4);
+        BackupVerifyReport report = verifyBackupStore(backupDir);
+        CHECK(report.checked == 4 && report.missing == 0 && report.corrupt == 0);
+
+        // A size limit below every blob still leaves each script its newest
+        // entry and its injection backup
+        BackupRetention bySize;
+        bySize.maxBytes = 1;
+        CHECK(pruneBackups(backupDir, bySize) == 0);
+    }
+
+    // The newest entry per script and context, restored byte for byte whether
+    // it is a full blob or a delta
+    void testFindAndRestore() {
+        TempDir root("backup-restore");
+        const std::string backupDir = (root / "backups").string();
+        const fs::path first = root / "c0000.hks";
+        const fs::path second = root / "c1000.hks";
+        BackupRetention unlimited;
+        BackupResult result;
+
+        writeText(first, makeScript(1));
+        CHECK(storeBackup(first.string(), backupDir, "injection", true, unlimited, result));
+        writeText(first, makeScript(2));
+        CHECK(storeBackup(first.string(), backupDir, "launch", true, unlimited, result));
+        CHECK(result.delta);
+        writeText(second, makeScript(3));
+        CHECK(storeBackup(second.string(), backupDir, "launch", true, unlimited, result));
+
+        BackupEntry entry;
+        CHECK(findLatestBackup(backupDir, "c0000.hks", "injection", entry));
+        CHECK(entry.source == "c0000.hks" && entry.context == "injection" && entry.base.empty());
+        const std::string injectionHash = entry.hash;
+        CHECK(findLatestBackup(backupDir, "c0000.hks", "", entry));      // Any context: the newest
+        CHECK(entry.context == "launch" && entry.base == injectionHash);
+        const std::string deltaHash = entry.hash;
+        CHECK(!findLatestBackup(backupDir, "c1000.hks", "injection", entry));
+        CHECK(!findLatestBackup(backupDir, "c2000.hks", "", entry));
+
+        const fs::path output = root / "restored.hks";
+        CHECK(restoreBackup(backupDir, injectionHash, output.string()));
+        CHECK(readText(output) == makeScript(1));
+        CHECK(restoreBackup(backupDir, deltaHash, output.string()));
+        CHECK(readText(output) == makeScript(2));
+
+        BackupEntry restored;
+        CHECK(restoreLatestBackup(backupDir, "c1000.hks", "launch", output.string(), &restored));
+        CHECK(readText(output) == makeScript(3));
+        CHECK(restored.source == "c1000.hks");
+        CHECK(!restoreLatestBackup(backupDir, "c1000.hks", "injection", output.string()));
+        CHECK(readText(output) == makeScript(3));
+
+        BackupVerifyReport report = verifyBackupStore(backupDir);
+        CHECK(report.checked == 3 && report.missing == 0 && report.corrupt == 0);
+    }
+
+    // Damaged content is reported and never written over the output
+    void testVerifyDetectsDamage() {
+        TempDir root("backup-verify");
+        const std::string backupDir = (root / "backups").string();
+        const fs::path source = root / "c0000.hks";
+        BackupRetention unlimited;
+        BackupResult result;
+        std::vector<std::string> hashes;
+        for (int revision = 0; revision < 3; ++revision) {
+            writeText(source, makeScript(revision));
+            CHECK(storeBackup(source.string(), backupDir, "launch", revision == 2, unlimited, result));
+            BackupEntry entry;
+            CHECK(findLatestBackup(backupDir, "c0000.hks", "launch", entry));
+            hashes.push_back(entry.hash);
+        }
+
+        std::vector<BackupEntry> entries;
+        CHECK(readBackupCatalog(backupDir, entries));
+        CHECK(entries.size() == 3);
+        std::string error;
+        for (const auto& entry : entries) {
+            CHECK_MSG(verifyBackup(backupDir, entry, error), error);
+        }
+
+        // Same size, one byte changed: only the hash check catches it
+        std::string damaged = makeScript(0);
+        damaged[damaged.size() / 2] ^= 1;
+        writeText(getBackupBlobPath(backupDir, hashes[0]), damaged);
+        fs::remove(getBackupBlobPath(backupDir, hashes[1]));
+
+        CHECK(!verifyBackup(backupDir, entries[0], error));
+        CHECK(!error.empty());
+        CHECK(!verifyBackup(backupDir, entries[1], error));
+        const fs::path output = root / "restored.hks";
+        writeText(output, "untouched");
+        CHECK(!restoreBackup(backupDir, hashes[0], output.string()));
+        CHECK(readText(output) == "untouched");
+
+        // The delta's base is the newest full blob (revision 1), now gone too
+        BackupVerifyReport report = verifyBackupStore(backupDir);
+        CHECK(report.checked == 3);
+        CHECK(report.corrupt == 1);
+        CHECK(report.missing == 2);
+    }
+
+    // A delta is rebuilt straight into the output's temp file while it is
+    // hashed; a mismatch discards the temp file instead of publishing it
+    void testDeltaRestoreStreamsAndChecksHash() {
+        const std::string script = makeScript(7);
+        ContentHasher hasher;
+        for (size_t offset = 0, piece = 1; offset < script.size(); offset += piece, piece = piece * 3 % 37 + 1) {
+            hasher.update(std::string_view(script).substr(offset, piece));
+        }
+        CHECK(hasher.finish() == hashBuffer(script.data(), script.size()));
+        CHECK(hasher.length() == script.size());
+
+        TempDir root("backup-stream");
+        const std::string backupDir = (root / "backups").string();
+        const fs::path source = root / "c0000.hks";
+        BackupRetention unlimited;
+        BackupResult result;
+        writeText(source, makeScript(0));
+        CHECK(storeBackup(source.string(), backupDir, "launch", true, unlimited, result));
+        writeText(source, script);
+        CHECK(storeBackup(source.string(), backupDir, "launch", true, unlimited, result));
+        CHECK(result.delta);
+        BackupEntry entry;
+        CHECK(findLatestBackup(backupDir, "c0000.hks", "launch", entry));
+
+        const fs::path output = root / "out/restored.hks";
+        writeText(output, "untouched");
+        CHECK(restoreBackup(backupDir, entry.hash, output.string()));
+        CHECK(readText(output) == script);
+
+        // The revision line is a literal at the end of the delta
+        std::string delta = readText(result.blobPath);
+        delta[delta.size() - 2] ^= 1;
+        writeText(result.blobPath, delta);
+        writeText(output, "untouched");
+        CHECK(!restoreBackup(backupDir, entry.hash, output.string()));
+        CHECK(readText(output) == "untouched");
+        for (const auto& file : fs::directory_iterator(output.parent_path())) {
+            CHECK_MSG(file.path().extension() != ".tmp", file.path().string());
+        }
+        std::string error;
+        CHECK(!verifyBackup(backupDir, entry, error));
+        CHECK(error.find("hash") != std::string::npos);
+    }
+
+    LoaderConfig cleanupConfig(const TempDir& root) {
+        LoaderConfig config;
+        config.configFile = (root / "LuaLoader.toml").string();
+        config.configDir = root.str();
+        config.gameScriptPath = PathInfo("action/script", (root / "action/script").string(), root.str());
+        config.modulePath = PathInfo("action/script/lua", (root / "action/script/lua").string(), root.str());
+        config.hksTargets = { "c0000.hks" };
+        config.backupHKSonLaunch = false;
+        config.backupHKSFolder = "backups";
+        config.backupDir = resolveHksBackupDir("", config);
+        return config;
+    }
+
+    void testCleanupRestoresUnclosedInjection() {
+        TempDir root("backup-cleanup");
+        fs::create_directories(root / "action/script/lua");
+        LoaderConfig config = cleanupConfig(root);
+        const fs::path hks = root / "action/script/c0000.hks";
+        const std::string original = makeScript(0);
+        writeText(hks, original);
+        CHECK(resolveHksBackupDir(hks.string(), config) == config.backupDir);
+
+        // A closed block is cut out in place
+        CHECK(injectIntoHksFile(config));
+        CHECK(readText(hks) != original);
+        CHECK(Cleanup::performFullCleanup(config));
+        CHECK(readText(hks) == original);
+
+        // Without its dofile line the block would run to the end of the file;
+        // the script comes back from the backup taken before injection instead
+        CHECK(injectIntoHksFile(config));
+        std::string injected = readText(hks);
+        size_t dofile = injected.find("dofile(");
+        CHECK(dofile != std::string::npos);
+        size_t lineEnd = injected.find('\n', dofile);
+        writeText(hks, injected.substr(0, dofile) + injected.substr(lineEnd + 1));
+        CHECK(Cleanup::performFullCleanup(config));
+        CHECK(readText(hks) == original);
+
+        BackupEntry entry;
+        CHECK(findLatestBackup(config.backupDir, "c0000.hks", "cleanup", entry));
+        for (const auto& file : fs::directory_iterator(hks.parent_path())) {
+            CHECK_MSG(file.path().extension() != ".tmp", file.path().string());
+        }
+    }
+
+    // No usable backup: the damaged script stays as it is rather than being truncated
+    void testCleanupLeavesUnclosedInjectionWithoutBackup() {
+        TempDir root("backup-cleanup");
+        fs::create_directories(root / "action/script/lua");
+        LoaderConfig config = cleanupConfig(root);
+        const fs::path hks = root / "action/script/c0000.hks";
+        const std::string damaged = "-- ========================================\n-- Lua Loader\n"
+            "-- ========================================\n\n" + makeScript(0);
+        writeText(hks, damaged);
+
+        CHECK(!Cleanup::cleanupHksInjection(hks.string()));
+        CHECK(readText(hks) == damaged);
+        CHECK(!Cleanup::cleanupHksInjection(hks.string(), config.backupDir));
+        CHECK(readText(hks) == damaged);
+
+        // A store with a damaged entry fails the final verification
+        CHECK(!Cleanup::performFullCleanup(config));
+        CHECK(readText(hks) == damaged);
+        BackupEntry entry;
+        CHECK(findLatestBackup(config.backupDir, "c0000.hks", "cleanup", entry));
+        writeText(getBackupBlobPath(config.backupDir, entry.hash), "x");
+        writeText(hks, makeScript(1));
+        CHECK(!Cleanup::performFullCleanup(config));
+        CHECK(readText(hks) == makeScript(1));
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    testSizeRetentionCountsStoredBytes();
+    testRetentionPerSource();
+    testFindAndRestore();
+    testVerifyDetectsDamage();
+    testDeltaRestoreStreamsAndChecksHash();
+    testCleanupRestoresUnclosedInjection();
+    testCleanupLeavesUnclosedInjectionWithoutBackup();
+    shutdownLogger();
+    return finish("test_backup_store");
+}
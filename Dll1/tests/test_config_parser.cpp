@@ -0,0 +1,236 @@
+// =============================================
+// File: tests/test_config_parser.cpp
+// Category: Test
+// Purpose: TOML values that span lines or hold quoted separators: hksTargets
+//          items keep commas inside quotes, and an array missing its ']' ends at
+//          the next key or table instead of swallowing them. setConfigValue
+//          patches values in place through the parsed layout, byte for byte.
+// =============================================
+#include "TestSupport.h"
+#include "ConfigParser.h"
+#include "Logger.h"
+
+using namespace TestSupport;
+
+namespace {
+
+    LoaderConfig parse(const TempDir& root, const std::string& body) {
+        const fs::path toml = root / "LuaLoader.toml";
+        writeText(toml, "configVersion = 1\ngameScriptPath = \"action/script\"\n" + body);
+        LoaderConfig config;
+        CHECK(parseTomlConfig(toml.string(), config));
+        return config;
+    }
+
+    void testQuotedItems() {
+        TempDir root("config-parse");
+        LoaderConfig config = parse(root, "hksTargets = [\"c0000.hks\", \"mods, extra/c1000.hks\", 'c[2]*.hks']\n");
+        CHECK(config.hksTargets.size() == 3);
+        CHECK(config.hksTargets == std::vector<std::string>({ "c0000.hks", "mods, extra/c1000.hks", "c[2]*.hks" }));
+
+        config = parse(root, "hksTargets = \"c0000.hks, c1000.hks\"\n");
+        CHECK(config.hksTargets == std::vector<std::string>({ "c0000.hks", "c1000.hks" }));
+    }
+
+    void testMultiLineArray() {
+        TempDir root("config-parse");
+        LoaderConfig config = parse(root,
+            "hksTargets = [\n"
+            "    \"c0000.hks\",   # the player\n"
+            "    \"c1000.hks\",\n"
+            "]\n"
+            "backupKeepCount = 4\n");
+        CHECK(config.hksTargets == std::vector<std::string>({ "c0000.hks", "c1000.hks" }));
+        CHECK(config.backupKeepCount == 4);
+    }
+
+    void testUnclosedArrayStopsAtNextKey() {
+        TempDir root("config-parse");
+        LoaderConfig config = parse(root,
+            "hksTargets = [\"c0000.hks\",\n"
+            "    \"c1000.hks\",\n"
+            "backupKeepCount = 4\n"
+            "durableWrites = false\n"
+            "[modules.alpha]\n"
+            "enabled = false\n");
+        CHECK(config.hksTargets == std::vector<std::string>({ "c0000.hks", "c1000.hks" }));
+        CHECK(config.backupKeepCount == 4);
+        CHECK(!config.durableWrites);
+        CHECK(config.modulePolicy->size() == 1);
+
+        // A table right after the open array ends it too
+        config = parse(root,
+            "hksTargets = [\"c0000.hks\"\n"
+            "[modules.beta]\n"
+            "enabled = false\n");
+        CHECK(config.hksTargets == std::vector<std::string>({ "c0000.hks" }));
+        CHECK(config.modulePolicy->size() == 1);
+    }
+
+    // In-place patches through the layout recorded by the parse: each call
+    // must leave every byte outside the value exactly as it was
+    struct PatchFixture {
+        TempDir root{ "config-patch" };
+        fs::path toml = root / "LuaLoader.toml";
+        LoaderConfig config;
+
+        explicit PatchFixture(const std::string& content) {
+            writeText(toml, content);
+            CHECK(parseTomlConfig(toml.string(), config));
+        }
+
+        std::string text() const { return readText(toml); }
+
+        // The shifted spans must match what a fresh parse of the new file records
+        void checkLayoutCurrent(const char* what) {
+            LoaderConfig fresh;
+            CHECK_MSG(parseTomlConfig(toml.string(), fresh), what);
+            CHECK_MSG(fresh.layout.firstTableOffset == config.layout.firstTableOffset, what);
+            for (const auto& span : fresh.layout.values) {
+                auto kept = std::find_if(config.layout.values.begin(), config.layout.values.end(),
+                    [&](const ConfigValueSpan& value) { return value.key == span.key; });
+                CHECK_MSG(kept != config.layout.values.end(), std::string(what) + ": " + span.key);
+                if (kept == config.layout.values.end()) continue;
+                CHECK_MSG(kept->offset == span.offset && kept->text == span.text, std::string(what) + ": " + span.key);
+            }
+        }
+    };
+
+    const std::string PATCH_HEAD = "configVersion = 1\r\ngameScriptPath = \"action/script\"\r\n";
+
+    void testReplaceKeepsBytesAndCrlf() {
+        const std::string before = PATCH_HEAD +
+            "logLevel = \"info\"   # console detail\r\n"
+            "hksTargets = [\r\n"
+            "    \"c0000.hks\",   # the player\r\n"
+            "    \"c1000.hks\",\r\n"
+            "]\r\n"
+            "cleanupOnNextLaunch = false # set by the uninstaller\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n";
+        PatchFixture f(before);
+        CHECK(f.config.layout.newline == "\r\n");
+
+        const std::string flagOn = PATCH_HEAD +
+            "logLevel = \"info\"   # console detail\r\n"
+            "hksTargets = [\r\n"
+            "    \"c0000.hks\",   # the player\r\n"
+            "    \"c1000.hks\",\r\n"
+            "]\r\n"
+            "cleanupOnNextLaunch = true # set by the uninstaller\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n";
+        CHECK(updateCleanupFlag(f.toml.string(), true, &f.config.layout));
+        CHECK(f.text() == flagOn);
+        f.checkLayoutCurrent("flag on");
+        CHECK(updateCleanupFlag(f.toml.string(), false, &f.config.layout));
+        CHECK(f.text() == before);
+        f.checkLayoutCurrent("flag off");
+
+        // A longer value earlier in the file moves every span behind it
+        CHECK(setConfigValue(f.toml.string(), "logLevel", "\"debug\"", &f.config.layout));
+        f.checkLayoutCurrent("longer value");
+        // A multi-line array replaced by one line moves them back
+        CHECK(setConfigValue(f.toml.string(), "hksTargets", "[\"c0000.hks\"]", &f.config.layout));
+        f.checkLayoutCurrent("array collapsed");
+        CHECK(updateCleanupFlag(f.toml.string(), true, &f.config.layout));
+        CHECK(f.text() == PATCH_HEAD +
+            "logLevel = \"debug\"   # console detail\r\n"
+            "hksTargets = [\"c0000.hks\"]\r\n"
+            "cleanupOnNextLaunch = true # set by the uninstaller\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n");
+        f.checkLayoutCurrent("flag after both");
+    }
+
+    void testInsertAboveFirstTable() {
+        const std::string before = PATCH_HEAD +
+            "logLevel = \"info\"\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n";
+        PatchFixture f(before);
+
+        // Added above the table with a blank line kept before it
+        CHECK(updateCleanupFlag(f.toml.string(), true, &f.config.layout));
+        const std::string inserted = PATCH_HEAD +
+            "logLevel = \"info\"\r\n"
+            "\r\n"
+            "cleanupOnNextLaunch = true\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n";
+        CHECK(f.text() == inserted);
+        f.checkLayoutCurrent("inserted");
+
+        // The second call patches the recorded span in place
+        CHECK(updateCleanupFlag(f.toml.string(), false, &f.config.layout));
+        CHECK(f.text() == PATCH_HEAD +
+            "logLevel = \"info\"\r\n"
+            "\r\n"
+            "cleanupOnNextLaunch = false\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n");
+
+        // The table moved down; the next new key still lands right above it
+        CHECK(setConfigValue(f.toml.string(), "backupDeltas", "true", &f.config.layout));
+        CHECK(f.text() == PATCH_HEAD +
+            "logLevel = \"info\"\r\n"
+            "\r\n"
+            "cleanupOnNextLaunch = false\r\n"
+            "\r\n"
+            "backupDeltas = true\r\n"
+            "\r\n"
+            "[modules.alpha]\r\n"
+            "enabled = true\r\n");
+        f.checkLayoutCurrent("second insert");
+    }
+
+    void testInsertAtEofWithoutNewline() {
+        // LF file, no table, last line unterminated
+        const std::string before = "configVersion = 1\ngameScriptPath = \"action/script\"\nlogLevel = \"info\"";
+        PatchFixture f(before);
+        CHECK(f.config.layout.newline == "\n");
+
+        CHECK(updateCleanupFlag(f.toml.string(), true, &f.config.layout));
+        CHECK(f.text() == before + "\ncleanupOnNextLaunch = true\n");
+        f.checkLayoutCurrent("appended");
+        CHECK(updateCleanupFlag(f.toml.string(), false, &f.config.layout));
+        CHECK(f.text() == before + "\ncleanupOnNextLaunch = false\n");
+        f.checkLayoutCurrent("patched");
+    }
+
+    void testOutsideEditRescans() {
+        const std::string before = PATCH_HEAD + "cleanupOnNextLaunch = false\r\n";
+        PatchFixture f(before);
+
+        // Edited after the parse: the recorded offset now points into the new line
+        const std::string edited = "# edited by hand\r\n" + before;
+        writeText(f.toml, edited);
+        CHECK(updateCleanupFlag(f.toml.string(), true, &f.config.layout));
+        CHECK(f.text() == "# edited by hand\r\n" + PATCH_HEAD + "cleanupOnNextLaunch = true\r\n");
+        f.checkLayoutCurrent("rescanned");
+
+        // Same length, same offset, but the key before it changed: not trusted either
+        writeText(f.toml, "# edited by hand\r\n" + PATCH_HEAD + "cleanupOnLastLaunch = true\r\ncleanupOnNextLaunch = true\r\n");
+        CHECK(updateCleanupFlag(f.toml.string(), false, &f.config.layout));
+        CHECK(f.text() == "# edited by hand\r\n" + PATCH_HEAD + "cleanupOnLastLaunch = true\r\ncleanupOnNextLaunch = false\r\n");
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    testQuotedItems();
+    testMultiLineArray();
+    testUnclosedArrayStopsAtNextKey();
+    testReplaceKeepsBytesAndCrlf();
+    testInsertAboveFirstTable();
+    testInsertAtEofWithoutNewline();
+    testOutsideEditRescans();
+    shutdownLogger();
+    return finish("test_config_parser");
+}
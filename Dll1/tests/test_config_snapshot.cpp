@@ -0,0 +1,97 @@
+// =============================================
+// File: tests/test_config_snapshot.cpp
+// Category: Test
+// Purpose: Config snapshots record which base each configured path resolved
+//          against, and are refused once a created folder would change that.
+// =============================================
+#include "TestSupport.h"
+#include "ConfigParser.h"
+#include "ConfigSnapshot.h"
+#include "PathUtils.h"
+#include "Logger.h"
+
+using namespace TestSupport;
+
+namespace {
+
+    void testResolvedBases() {
+        TempDir root("path-base");
+        fs::create_directories(root / "cfg");
+        fs::create_directories(root / "work/game");
+        const std::string configDir = (root / "cfg").string();
+
+        PathBase base = PathBase::Fallback;
+        resolvePathWithFallbacks((root / "anywhere").string(), configDir, &base);
+        CHECK(base == PathBase::Absolute);
+        resolvePathWithFallbacks("backups", configDir, &base);
+        CHECK(base == PathBase::ConfigDir);
+        resolvePathWithFallbacks("nowhere/at/all", configDir, &base);
+        CHECK(base == PathBase::Fallback);
+
+        fs::path previous = fs::current_path();
+        fs::current_path(root / "work");
+        std::string resolved = resolvePathWithFallbacks("game/scripts", configDir, &base);
+        CHECK(base == PathBase::WorkingDir);
+        CHECK(resolved == normalizePath((root / "work/game/scripts").string()));
+        CHECK(isPathBaseCurrent("game/scripts", configDir, PathBase::WorkingDir));
+
+        // The config-relative candidate is tried first, so creating it moves the path
+        fs::create_directories(root / "cfg/game");
+        CHECK(!isPathBaseCurrent("game/scripts", configDir, PathBase::WorkingDir));
+        CHECK(isPathBaseCurrent("game/scripts", configDir, PathBase::ConfigDir));
+        fs::current_path(previous);
+    }
+
+    void testSnapshotReprobesBases() {
+        TempDir root("snapshot-base");
+        fs::create_directories(root / "work/game/scripts/lua");
+        const fs::path toml = root / "cfg/LuaLoader.toml";
+        writeText(toml,
+            "gameScriptPath = \"game/scripts\"\n"
+            "modulePath = \"game/scripts/lua\"\n"
+            "backupHKSFolder = \"backups\"\n");
+
+        fs::path previous = fs::current_path();
+        fs::current_path(root / "work");
+
+        // Only the working directory has the game folder
+        LoaderConfig parsed;
+        CHECK(parseTomlConfig(toml.string(), parsed));
+        CHECK(parsed.gameScriptPath.resolvedBase == PathBase::WorkingDir);
+        CHECK(parsed.modulePath.resolvedBase == PathBase::WorkingDir);
+        CHECK(parsed.backupDirBase == PathBase::ConfigDir);
+        CHECK(saveConfigSnapshot(toml.string(), "", parsed));
+
+        LoaderConfig loaded;
+        CHECK(loadConfigSnapshot(toml.string(), "", loaded));
+        CHECK(loaded.gameScriptPath.absolutePath == parsed.gameScriptPath.absolutePath);
+        CHECK(loaded.gameScriptPath.resolvedBase == PathBase::WorkingDir);
+        CHECK(loaded.modulePath.resolvedBase == PathBase::WorkingDir);
+        CHECK(loaded.backupDirBase == PathBase::ConfigDir);
+
+        // Same TOML, same working directory, but a parse would now pick the
+        // config folder; the snapshot must not keep the old absolute path
+        fs::create_directories(root / "cfg/game/scripts");
+        LoaderConfig stale;
+        stale.configFile = "untouched";
+        CHECK(!loadConfigSnapshot(toml.string(), "", stale));
+        CHECK(stale.configFile == "untouched");
+
+        LoaderConfig reparsed;
+        CHECK(parseTomlConfig(toml.string(), reparsed));
+        CHECK(reparsed.gameScriptPath.resolvedBase == PathBase::ConfigDir);
+        CHECK(reparsed.gameScriptPath.absolutePath == normalizePath((root / "cfg/game/scripts").string()));
+        CHECK(saveConfigSnapshot(toml.string(), "", reparsed));
+        CHECK(loadConfigSnapshot(toml.string(), "", loaded));
+        CHECK(loaded.gameScriptPath.absolutePath == reparsed.gameScriptPath.absolutePath);
+        fs::current_path(previous);
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    testResolvedBases();
+    testSnapshotReprobesBases();
+    shutdownLogger();
+    return finish("test_config_snapshot");
+}
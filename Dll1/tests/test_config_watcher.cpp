@@ -0,0 +1,93 @@
+// =============================================
+// File: tests/test_config_watcher.cpp
+// Category: Test
+// Purpose: Live TOML reload: hot keys reach the active config and the logger and
+//          fsync globals, a reader's config outlives the reload that replaces it,
+//          and a file that fails to parse leaves every setting as it was.
+// =============================================
+#include "TestSupport.h"
+#include "ConfigWatcher.h"
+#include "ConfigParser.h"
+#include "FileIO.h"
+#include "Logger.h"
+#include <windows.h>
+#include <thread>
+
+using namespace TestSupport;
+
+namespace {
+
+    std::string toml(const std::string& logLevel, bool durableWrites, unsigned keepCount, bool withGamePath = true) {
+        return std::string("configVersion = 1\n") +
+            (withGamePath ? "gameScriptPath = \"action/script\"\n" : "") +
+            "logLevel = \"" + logLevel + "\"\n"
+            "durableWrites = " + (durableWrites ? "true" : "false") + "\n"
+            "backupKeepCount = " + std::to_string(keepCount) + "\n";
+    }
+
+    template <typename Condition>
+    bool waitFor(Condition condition) {
+        Stopwatch timer;
+        while (timer.ms() < 5000.0) {
+            if (condition()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+
+    unsigned activeKeepCount() {
+        std::shared_ptr<const LoaderConfig> active = getActiveConfig();
+        return active ? active->backupKeepCount : 0;
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    TempDir root("config-watch");
+    fs::create_directories(root / "action/script");
+    const fs::path path = root / "LuaLoader.toml";
+
+    CHECK(!getActiveConfig());
+    writeText(path, toml("warning", true, 1));
+    LoaderConfig config;
+    CHECK(parseTomlConfig(path.string(), config));
+    CHECK(config.logLevel == LOG_WARNING);
+    publishActiveConfig(config);
+    CHECK(startConfigWatcher(path.string()));
+    CHECK(Win32Stub::moduleReferences() == 1);          // The watcher keeps the DLL mapped
+
+    std::shared_ptr<const LoaderConfig> before = getActiveConfig();
+    CHECK(before && before->backupKeepCount == 1);
+
+    // Hot keys: the merged config drives the globals
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeText(path, toml("error", false, 3));
+    CHECK(waitFor([] { return activeKeepCount() == 3; }));
+    std::shared_ptr<const LoaderConfig> reloaded = getActiveConfig();
+    CHECK(reloaded->logLevel == LOG_ERROR);
+    CHECK(!reloaded->durableWrites);
+    CHECK(getLogLevel() == LOG_ERROR);
+    CHECK(getDefaultFsyncPolicy() == FsyncPolicy::Never);
+
+    // The reader that loaded the old config still holds it, unchanged
+    CHECK(before->backupKeepCount == 1 && before->logLevel == LOG_WARNING && before->durableWrites);
+    CHECK(before.get() != reloaded.get());
+
+    // No gameScriptPath: the parse sets logLevel and durableWrites, then fails
+    writeText(path, toml("trace", true, 9, false));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    CHECK(getLogLevel() == LOG_ERROR);
+    CHECK(getDefaultFsyncPolicy() == FsyncPolicy::Never);
+    CHECK(getActiveConfig().get() == reloaded.get());
+
+    // The watcher keeps going after a failed reload
+    writeText(path, toml("info", true, 5));
+    CHECK(waitFor([] { return activeKeepCount() == 5; }));
+    CHECK(getLogLevel() == LOG_INFO);
+    CHECK(getDefaultFsyncPolicy() == FsyncPolicy::Always);
+
+    stopConfigWatcher();
+    CHECK(Win32Stub::waitForModuleReleased(5000));      // It exits and lets go once stopped
+    shutdownLogger();
+    return finish("test_config_watcher");
+}
@@ -0,0 +1,191 @@
+// =============================================
+// File: tests/test_injection_state.cpp
+// Category: Test
+// Purpose: The injection state sidecar: a matching size, mtime and line hash
+//          skips the read, anything else (a changed target, a corrupt or
+//          truncated sidecar) falls back to full detection, and the sidecar is
+//          rewritten only when one of its entries changed.
+// =============================================
+#include "TestSupport.h"
+#include "HksInjector.h"
+#include "InjectionState.h"
+#include "PathUtils.h"
+#include "Logger.h"
+#include <functional>
+
+using namespace TestSupport;
+
+namespace {
+
+    const std::string BODY = "-- game script\nfunction Update() end\n";
+
+    // Game folder with every target injected once and its sidecar written
+    struct InjectFixture {
+        TempDir root{ "inject-state" };
+        LoaderConfig config;
+        std::string injectionLine;
+        fs::path statePath;
+
+        explicit InjectFixture(const std::vector<std::string>& targets = { "c0000.hks" }) {
+            config.configFile = (root / "LuaLoader.toml").string();
+            config.configDir = root.str();
+            config.gameScriptPath = PathInfo("action/script", (root / "action/script").string(), root.str());
+            config.modulePath = PathInfo("action/script/lua", (root / "action/script/lua").string(), root.str());
+            config.hksTargets = targets;
+            config.backupHKSonLaunch = false;
+            config.backupHKSFolder = "backups";
+            config.backupDir = (root / "backups").string();
+            injectionLine = "dofile('" + config.modulePath.absolutePath + "/_module_loader/module_loader_setup.lua')";
+            statePath = getInjectionStatePath(config.modulePath.absolutePath);
+            fs::create_directories(statePath.parent_path());    // Made with the setup script at launch
+
+            for (const auto& target : targets) {
+                writeText(hks(target), BODY);
+            }
+            for (const auto& result : run()) {
+                CHECK(result.injected);
+            }
+            InjectionStateMap states;
+            CHECK(loadInjectionState(statePath.string(), states) && states.size() == targets.size());
+        }
+
+        fs::path hks(const std::string& name = "c0000.hks") const { return root / "action/script" / name; }
+
+        std::vector<HksTargetResult> run() {
+            std::vector<HksTargetResult> results;
+            CHECK(injectIntoHksFiles(config, results));
+            CHECK(results.size() == config.hksTargets.size());
+            return results;
+        }
+
+        bool hasInjection() const { return readText(hks()).find(injectionLine) != std::string::npos; }
+
+        // Blanks the injection line without changing the size, then puts the
+        // mtime back: only reading the file can tell it changed
+        void hideInjection() {
+            auto writeTime = fs::last_write_time(hks());
+            std::string text = readText(hks());
+            size_t at = text.find(injectionLine);
+            CHECK(at != std::string::npos);
+            if (at == std::string::npos) return;
+            text.replace(at, injectionLine.size(), std::string(injectionLine.size(), '-'));
+            writeText(hks(), text);
+            fs::last_write_time(hks(), writeTime);
+        }
+
+        // Re-detected: the full read found the line gone and injected it again
+        void checkReinjected(const char* what) {
+            std::vector<HksTargetResult> results = run();
+            CHECK_MSG(results[0].injected && !results[0].alreadyPresent, what);
+            CHECK_MSG(hasInjection(), what);
+            InjectionStateMap states;
+            CHECK_MSG(loadInjectionState(statePath.string(), states) && states.size() == 1, what);
+        }
+    };
+
+    // The fast path is a stat-only hint: an unchanged entry hides even a
+    // same-size edit, which is what every fallback below has to undo
+    void testMatchingStateSkipsRead() {
+        InjectFixture f;
+        f.hideInjection();
+        std::vector<HksTargetResult> results = f.run();
+        CHECK(results[0].alreadyPresent && !results[0].injected);
+        CHECK(!f.hasInjection());
+    }
+
+    void testDamagedSidecarFallsBack() {
+        const std::vector<std::pair<const char*, std::function<void(std::string&)>>> damage = {
+            { "garbled size", [](std::string& text) { text[text.find('\t') + 1] = 'x'; } },
+            { "corrupt line hash", [](std::string& text) { text[text.size() - 2] = 'x'; } },
+            { "truncated entry", [](std::string& text) { text.resize(text.find('\t') + 4); } },
+            { "range past the end", [](std::string& text) {
+                size_t size = text.find('\t') + 1;
+                text.replace(size, text.find(' ', size) - size, "1");
+            } },
+            { "wrong header", [](std::string& text) { text[0] = 'l'; } },
+        };
+        for (const auto& [what, edit] : damage) {
+            InjectFixture f;
+            f.hideInjection();
+            std::string text = readText(f.statePath);
+            edit(text);
+            writeText(f.statePath, text);
+            InjectionStateMap states;
+            CHECK_MSG(!loadInjectionState(f.statePath.string(), states) && states.empty(), what);
+            f.checkReinjected(what);
+        }
+    }
+
+    void testChangedTargetFallsBack() {
+        // Size: the line removed outright, mtime put back
+        {
+            InjectFixture f;
+            auto writeTime = fs::last_write_time(f.hks());
+            std::string text = readText(f.hks());
+            text.erase(text.find(f.injectionLine), f.injectionLine.size());
+            writeText(f.hks(), text);
+            fs::last_write_time(f.hks(), writeTime);
+            f.checkReinjected("size changed");
+        }
+        // Mtime: same-size edit, mtime moved on
+        {
+            InjectFixture f;
+            f.hideInjection();
+            fs::last_write_time(f.hks(), fs::last_write_time(f.hks()) + std::chrono::seconds(2));
+            f.checkReinjected("mtime changed");
+        }
+        // Line hash: the entry was taken against another injection line
+        {
+            InjectFixture f;
+            f.hideInjection();
+            InjectionStateMap states;
+            CHECK(loadInjectionState(f.statePath.string(), states) && states.size() == 1);
+            states.begin()->second.lineHash = hashInjectionLine("dofile('elsewhere/module_loader_setup.lua')");
+            CHECK(saveInjectionState(f.statePath.string(), states));
+            f.checkReinjected("line hash changed");
+        }
+    }
+
+    void testSidecarRewrittenOnlyOnChange() {
+        InjectFixture f({ "c0000.hks", "c1000.hks" });
+        const auto stamp = fs::last_write_time(f.statePath) - std::chrono::hours(1);
+        auto untouched = [&]() { return fs::last_write_time(f.statePath) == stamp; };
+
+        // Nothing changed: every target took the fast path, the sidecar is left alone
+        fs::last_write_time(f.statePath, stamp);
+        for (const auto& result : f.run()) {
+            CHECK(result.alreadyPresent);
+        }
+        CHECK(untouched());
+
+        // A target edited but still injected: read again, entry updated
+        const std::string before = readText(f.statePath);
+        writeText(f.hks(), readText(f.hks()) + "-- edited\n");
+        f.run();
+        CHECK(!untouched());
+        InjectionStateMap states;
+        CHECK(loadInjectionState(f.statePath.string(), states) && states.size() == 2);
+        CHECK(states[normalizePath(f.hks().string())].size == fs::file_size(f.hks()));
+        CHECK(readText(f.statePath) != before);
+
+        // A target leaving the list drops its entry
+        fs::last_write_time(f.statePath, stamp);
+        f.run();
+        CHECK(untouched());
+        f.config.hksTargets = { "c0000.hks" };
+        f.run();
+        CHECK(!untouched());
+        CHECK(loadInjectionState(f.statePath.string(), states) && states.size() == 1);
+        CHECK(states.count(normalizePath(f.hks().string())) == 1);
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    testMatchingStateSkipsRead();
+    testDamagedSidecarFallsBack();
+    testChangedTargetFallsBack();
+    testSidecarRewrittenOnlyOnChange();
+    shutdownLogger();
+    return finish("test_injection_state");
+}
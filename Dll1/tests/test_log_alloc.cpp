@@ -0,0 +1,114 @@
+// =============================================
+// File: tests/test_log_alloc.cpp
+// Category: Test
+// Purpose: Counts operator new on the logging thread: LOG_AT sites that are filtered
+//          out allocate nothing and never evaluate their arguments, and enabled short
+//          messages stop allocating once the logger's buffers are warm. The sites in
+//          log_alloc_stripped.cpp are built with LUALOADER_MIN_LOG_LEVEL=2.
+// =============================================
+#include "TestSupport.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <new>
+
+using namespace TestSupport;
+
+namespace {
+    thread_local size_t t_allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+// log_alloc_stripped.cpp
+struct StrippedSiteCounts {
+    int traceEvaluations = 0;
+    int debugEvaluations = 0;
+    int infoEvaluations = 0;
+    size_t strippedAllocations = 0;
+};
+StrippedSiteCounts logStrippedSites();
+
+namespace {
+
+    int g_evaluations = 0;
+
+    // Stands in for an argument that is costly to produce
+    std::string expensive() {
+        ++g_evaluations;
+        return std::string(64, 'x');
+    }
+
+    void testFilteredSitesDoNotAllocate() {
+        setLogLevel(LOG_WARNING);
+        const std::string candidate = "C:/Games/ELDEN RING/Game/mods/action/script";
+        g_evaluations = 0;
+
+        size_t before = t_allocations;
+        for (int i = 0; i < 1000; ++i) {
+            LOG_AT(LOG_TRACE, "PathUtils", "Trying CWD-relative path: ", candidate);
+            LOG_AT(LOG_DEBUG, "PathUtils", "Resolved ", i, " of ", 1000, ": ", expensive());
+            LOG_AT(LOG_INFO, "PathUtils", expensive());
+        }
+        CHECK(t_allocations == before);
+        CHECK(g_evaluations == 0);
+    }
+
+    void testEnabledSitesStopAllocating() {
+        setLogLevel(LOG_TRACE);
+        const std::string candidate = "C:/Games/ELDEN RING/Game/mods/action/script";
+
+        // Warm every ring slot, the formatting buffer and the batch
+        for (int i = 0; i < 10000; ++i) {
+            LOG_AT(LOG_TRACE, "PathUtils", "Trying CWD-relative path: ", candidate, " #", i);
+        }
+        flushLog();
+
+        size_t before = t_allocations;
+        for (int i = 0; i < 1000; ++i) {
+            LOG_AT(LOG_TRACE, "PathUtils", "Trying CWD-relative path: ", candidate, " #", i);
+        }
+        CHECK(t_allocations == before);
+
+        // Past the stack buffer the message moves to the heap (and the counter sees it)
+        const std::string longPart(600, 'y');
+        before = t_allocations;
+        LOG_AT(LOG_TRACE, "PathUtils", "Long: ", longPart);
+        CHECK(t_allocations > before);
+    }
+
+    void testCompiledOutSites() {
+        // With the runtime level at TRACE, only the compile-time threshold filters
+        setLogLevel(LOG_TRACE);
+        StrippedSiteCounts counts = logStrippedSites();
+        CHECK(counts.traceEvaluations == 0);
+        CHECK(counts.debugEvaluations == 0);
+        CHECK(counts.strippedAllocations == 0);
+        CHECK(counts.infoEvaluations == 1);
+    }
+}
+
+size_t currentThreadAllocations() {
+    return t_allocations;
+}
+
+int main() {
+    testFilteredSitesDoNotAllocate();
+    testEnabledSitesStopAllocating();
+    testCompiledOutSites();
+    shutdownLogger();
+    return finish("test_log_alloc");
+}
@@ -0,0 +1,157 @@
+// =============================================
+// File: tests/test_me3_document.cpp
+// Category: Test
+// Purpose: setConfigPath edits a .me3 file as byte ranges: an existing entry
+//          keeps its line and comment, repeats are dropped, a new entry lands
+//          after profileVersion or at the end, and every other byte (CRLF
+//          included) is written back exactly as it was read.
+// =============================================
+#include "TestSupport.h"
+#include "Me3Document.h"
+#include "Logger.h"
+
+using namespace TestSupport;
+
+namespace {
+
+    // Loads content, points luaLoaderConfigPath at value and saves
+    struct Me3Fixture {
+        TempDir root{ "me3-doc" };
+        fs::path me3 = root / "profile.me3";
+        Me3Document doc;
+
+        explicit Me3Fixture(const std::string& content) {
+            writeText(me3, content);
+            CHECK(doc.load(me3.string()));
+        }
+
+        Me3Placement set(const std::string& value) {
+            Me3Placement placement = doc.setConfigPath(value);
+            CHECK(doc.isModified());
+            std::string error;
+            CHECK_MSG(doc.save(error), error);
+            CHECK(!doc.isModified());
+            return placement;
+        }
+
+        std::string text() const { return readText(me3); }
+
+        // The saved document answers as a fresh load of the file does
+        void checkReloads(const std::string& value) {
+            std::string_view found;
+            CHECK(doc.find(ME3_CONFIG_PATH_KEY, found) && found == value);
+            Me3Document fresh;
+            CHECK(fresh.load(me3.string()));
+            CHECK(fresh.find(ME3_CONFIG_PATH_KEY, found) && found == value);
+        }
+    };
+
+    const std::string CRLF_HEAD =
+        "# Mod profile\r\n"
+        "profileVersion = \"v1\"\r\n"
+        "\r\n";
+    const std::string CRLF_TAIL =
+        "\r\n"
+        "[[packages]]\r\n"
+        "id = \"mods\"   # keep = this\r\n"
+        "path = 'mods'\r\n";
+
+    void testReplaceKeepsComment() {
+        Me3Fixture f(CRLF_HEAD + "luaLoaderConfigPath  =  \"old/LuaLoader.toml\"   # set by LuaLoader\r\n" + CRLF_TAIL);
+        CHECK(f.set("LuaLoader/LuaLoader.toml") == Me3Placement::Replaced);
+        CHECK(f.text() == CRLF_HEAD + "luaLoaderConfigPath  =  \"LuaLoader/LuaLoader.toml\"   # set by LuaLoader\r\n" + CRLF_TAIL);
+        f.checkReloads("LuaLoader/LuaLoader.toml");
+
+        // A shorter value through the re-indexed buffer
+        CHECK(f.set("x.toml") == Me3Placement::Replaced);
+        CHECK(f.text() == CRLF_HEAD + "luaLoaderConfigPath  =  \"x.toml\"   # set by LuaLoader\r\n" + CRLF_TAIL);
+        f.checkReloads("x.toml");
+    }
+
+    void testDuplicatesDropped() {
+        Me3Fixture f(CRLF_HEAD +
+            "luaLoaderConfigPath = 'first.toml'\r\n"
+            "savefile = \"a.sl2\"\r\n"
+            "luaLoaderConfigPath = \"second.toml\" # stale\r\n"
+            "luaLoaderConfigPath = \"third.toml\"\r\n" + CRLF_TAIL);
+        CHECK(f.set("new.toml") == Me3Placement::Replaced);
+        // Each repeat goes with its line ending
+        CHECK(f.text() == CRLF_HEAD +
+            "luaLoaderConfigPath = \"new.toml\"\r\n"
+            "savefile = \"a.sl2\"\r\n" + CRLF_TAIL);
+        f.checkReloads("new.toml");
+
+        // Only one entry left to rewrite
+        CHECK(f.set("again.toml") == Me3Placement::Replaced);
+        CHECK(f.text() == CRLF_HEAD +
+            "luaLoaderConfigPath = \"again.toml\"\r\n"
+            "savefile = \"a.sl2\"\r\n" + CRLF_TAIL);
+    }
+
+    void testInsertAfterProfileVersion() {
+        const std::string before = "# Mod profile\r\nprofileVersion = \"v1\"\r\n[[packages]]\r\nid = \"mods\"\r\n";
+        Me3Fixture f(before);
+        CHECK(f.set("LuaLoader.toml") == Me3Placement::AfterProfileVersion);
+        CHECK(f.text() ==
+            "# Mod profile\r\nprofileVersion = \"v1\"\r\n"
+            "\r\n# LuaLoader Configuration (relative path for portability)\r\n"
+            "luaLoaderConfigPath = \"LuaLoader.toml\"\r\n\r\n"
+            "[[packages]]\r\nid = \"mods\"\r\n");
+        f.checkReloads("LuaLoader.toml");
+
+        // Saved once, the entry is replaced rather than inserted again
+        CHECK(f.set("other.toml") == Me3Placement::Replaced);
+        CHECK(f.text().find("luaLoaderConfigPath = \"other.toml\"\r\n") != std::string::npos);
+        CHECK(f.text().find("LuaLoader.toml") == std::string::npos);
+    }
+
+    void testInsertAfterUnterminatedLastLine() {
+        // LF file whose profileVersion line is the last one, with no newline
+        const std::string before = "# Mod profile\nprofileVersion = \"v1\"";
+        Me3Fixture f(before);
+        CHECK(f.set("LuaLoader.toml") == Me3Placement::AfterProfileVersion);
+        CHECK(f.text() == before +
+            "\n\n# LuaLoader Configuration (relative path for portability)\n"
+            "luaLoaderConfigPath = \"LuaLoader.toml\"\n\n");
+        f.checkReloads("LuaLoader.toml");
+    }
+
+    void testAppendWithoutProfileVersion() {
+        const std::string before = CRLF_TAIL.substr(2);
+        Me3Fixture f(before);
+        CHECK(f.set("LuaLoader.toml") == Me3Placement::AppendedAtEnd);
+        CHECK(f.text() == before + "\r\n# --- Added by LuaLoader ---\r\nluaLoaderConfigPath = \"LuaLoader.toml\"\r\n");
+        f.checkReloads("LuaLoader.toml");
+
+        // Unterminated last line: the file's own newline is added before the entry
+        Me3Fixture g("[[packages]]\nid = \"mods\"");
+        CHECK(g.set("LuaLoader.toml") == Me3Placement::AppendedAtEnd);
+        CHECK(g.text() == "[[packages]]\nid = \"mods\"\n\n# --- Added by LuaLoader ---\nluaLoaderConfigPath = \"LuaLoader.toml\"\n");
+
+        // Empty file
+        Me3Fixture e("");
+        CHECK(e.set("LuaLoader.toml") == Me3Placement::AppendedAtEnd);
+        CHECK(e.text() == "\r\n# --- Added by LuaLoader ---\r\nluaLoaderConfigPath = \"LuaLoader.toml\"\r\n");
+    }
+
+    void testLookupIgnoresQuotedSeparators() {
+        Me3Fixture f("note = \"a # b = c\"\r\nluaLoaderConfigPath = \"dir # 1/LuaLoader.toml\" # real comment\r\n");
+        std::string_view found;
+        CHECK(f.doc.find("note", found) && found == "a # b = c");
+        CHECK(f.doc.find(ME3_CONFIG_PATH_KEY, found) && found == "dir # 1/LuaLoader.toml");
+        CHECK(f.set("plain.toml") == Me3Placement::Replaced);
+        CHECK(f.text() == "note = \"a # b = c\"\r\nluaLoaderConfigPath = \"plain.toml\" # real comment\r\n");
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    testReplaceKeepsComment();
+    testDuplicatesDropped();
+    testInsertAfterProfileVersion();
+    testInsertAfterUnterminatedLastLine();
+    testAppendWithoutProfileVersion();
+    testLookupIgnoresQuotedSeparators();
+    shutdownLogger();
+    return finish("test_me3_document");
+}
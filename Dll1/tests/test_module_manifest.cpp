@@ -0,0 +1,156 @@
+// =============================================
+// File: tests/test_module_manifest.cpp
+// Category: Test
+// Purpose: Checks that the setup script notices added and rewritten modules through
+//          module_index.txt, and that it never spawns a process to list the directory.
+// =============================================
+#include "TestSupport.h"
+#include "LuaSetup.h"
+#include "FlagFile.h"
+#include "ModuleManifest.h"
+#include "ModuleWatcher.h"
+#include "Logger.h"
+#include <windows.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace TestSupport;
+
+namespace {
+
+    // One session for the whole run, begun in main like the DLL does at attach
+    std::string& sessionDll() {
+        static std::string path;
+        return path;
+    }
+
+    std::string sessionFile() {
+        return getSessionFilePath(sessionDll());
+    }
+
+    struct Fixture {
+        TempDir root{ "manifest" };
+        LoaderConfig config;
+        std::string script;
+
+        Fixture() {
+            CHECK(::chdir(root.str().c_str()) == 0);
+            config.configDir = root.str();
+            config.modulePath = PathInfo("mods", (root / "mods").string(), root.str());
+            config.gameScriptPath = PathInfo("script", (root / "script").string(), root.str());
+            addModule("alpha", "return {}\n");
+            addModule("beta", "return {}\n");
+            script = config.modulePath.absolutePath + "/_module_loader/module_loader_setup.lua";
+        }
+
+        bool generate() {
+            return createWorkingSetupScript(config, sessionFile());
+        }
+
+        void addModule(const std::string& name, const std::string& body) {
+            writeText(root / ("mods/" + name + ".lua"), body);
+        }
+
+        // One HKS bootstrap; returns what the script printed
+        std::string bootstrap() {
+            std::error_code ec;
+            fs::remove(getFlagFilePath(config.modulePath.absolutePath), ec);
+            fs::remove(root / "CONOUT$", ec);
+            LuaRun run = runLuaScript(script);
+            CHECK_MSG(run.ok, run.error);
+            CHECK(run.popenCalls == 0);
+            return readText(root / "CONOUT$");
+        }
+    };
+
+    bool contains(const std::string& text, const std::string& part) {
+        return text.find(part) != std::string::npos;
+    }
+
+    void testCurrentManifest() {
+        Fixture f;
+        CHECK(f.generate());
+
+        std::string out = f.bootstrap();
+        CHECK(contains(out, "Loaded: alpha"));
+        CHECK(contains(out, "Loaded: beta"));
+        CHECK(!contains(out, "stale"));
+    }
+
+    void testAddedModuleSeenThroughIndex() {
+        Fixture f;
+        CHECK(f.generate());
+
+        // Existence and size of the baked entries are unchanged; only the listing grew
+        f.addModule("gamma", "return {}\n");
+        CHECK(writeModuleIndex(f.config.modulePath.absolutePath, scanModuleDirectory(f.config.modulePath.absolutePath)));
+
+        std::string out = f.bootstrap();
+        CHECK(contains(out, "using the loader's module index"));
+        CHECK(contains(out, "Loaded: gamma"));
+    }
+
+    void testSameSizeEditChangesStamp() {
+        Fixture f;
+        CHECK(f.generate());
+        std::string before = readText(getModuleIndexPath(f.config.modulePath.absolutePath));
+
+        // Same size, later write time
+        fs::path alpha = f.root / "mods/alpha.lua";
+        auto writeTime = fs::last_write_time(alpha);
+        f.addModule("alpha", "return{ }\n");
+        fs::last_write_time(alpha, writeTime + std::chrono::seconds(5));
+
+        CHECK(writeModuleIndex(f.config.modulePath.absolutePath, scanModuleDirectory(f.config.modulePath.absolutePath)));
+        std::string after = readText(getModuleIndexPath(f.config.modulePath.absolutePath));
+        CHECK(before.substr(0, before.find('\n')) != after.substr(0, after.find('\n')));
+    }
+
+    void testMissingIndexFallsBackToManifest() {
+        Fixture f;
+        CHECK(f.generate());
+        fs::remove(getModuleIndexPath(f.config.modulePath.absolutePath));
+        fs::remove(f.root / "mods/beta.lua");
+
+        std::string out = f.bootstrap();
+        CHECK(contains(out, "no module index was found"));
+        CHECK(contains(out, "Loaded: alpha"));
+        CHECK(!contains(out, "beta"));
+    }
+
+    void testWatcherRefreshesIndex() {
+        Fixture f;
+        CHECK(f.generate());
+        CHECK(startModuleWatcher(f.config.modulePath.absolutePath));
+        CHECK(Win32Stub::moduleReferences() == 1);      // The watcher keeps the DLL mapped
+        // Let the watcher's initial sync finish, so only the change notification can add delta
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        f.addModule("delta", "return {}\n");
+        const std::string indexPath = getModuleIndexPath(f.config.modulePath.absolutePath);
+        bool seen = false;
+        for (int i = 0; i < 200 && !seen; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            seen = contains(readText(indexPath), "delta\n");
+        }
+        CHECK(seen);
+        stopModuleWatcher();
+        // Gone, with its reference, before the fixture removes the folder it watches
+        CHECK(Win32Stub::waitForModuleReleased(5000));
+    }
+}
+
+int main() {
+    setSilentMode(true);
+    TempDir session("manifest-session");
+    sessionDll() = (session / "LuaLoader.dll").string();
+    CHECK(beginSession(sessionDll()));
+    CHECK(updateSessionState(SESSION_STATE_READY));
+    testCurrentManifest();
+    testAddedModuleSeenThroughIndex();
+    testSameSizeEditChangesStamp();
+    testMissingIndexFallsBackToManifest();
+    testWatcherRefreshesIndex();
+    shutdownLogger();
+    return finish("test_module_manifest");
+}
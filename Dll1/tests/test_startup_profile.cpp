@@ -0,0 +1,75 @@
+// =============================================
+// File: tests/test_startup_profile.cpp
+// Category: Test
+// Purpose: Headless launch through DllMain that checks startup_profile.json: every
+//          startup phase timed, filesystem counters attributed, summary line present.
+// =============================================
+#include "TestSupport.h"
+#include "FakeGame.h"
+#include "InitWorker.h"
+#include "BackgroundIO.h"
+#include "StartupProfiler.h"
+#include "Logger.h"
+#include <windows.h>
+#include <unistd.h>
+
+BOOL APIENTRY DllMain(HMODULE hMod, DWORD reason, LPVOID reserved);
+
+using namespace TestSupport;
+
+namespace {
+
+    // The report line for a phase, or "" if the phase is missing
+    std::string phaseLine(const std::string& report, const std::string& name) {
+        size_t at = report.find("{ \"name\": \"" + name + "\"");
+        if (at == std::string::npos) {
+            return "";
+        }
+        return report.substr(at, report.find('\n', at) - at);
+    }
+
+    unsigned long long counter(const std::string& line, const std::string& name) {
+        size_t at = line.find("\"" + name + "\": ");
+        return at == std::string::npos ? 0 : std::stoull(line.substr(at + name.size() + 4));
+    }
+}
+
+int main() {
+    FakeGame game;
+    CHECK(::chdir(game.root.str().c_str()) == 0);
+    setSilentMode(true);
+    Win32Stub::setModuleFileName(game.dll.string());
+
+    // A first launch on a fresh tree takes every phase
+    DllMain(reinterpret_cast<HMODULE>(1), DLL_PROCESS_ATTACH, nullptr);
+    CHECK(waitForInitialization(10000) == InitState::Succeeded);
+
+    std::string report = game.profile();
+    CHECK(report.find("\"clock\": \"steady_clock\"") != std::string::npos);
+
+    const char* phases[] = {
+        "initializePaths", "parseTomlConfig", "handleCleanupIfRequested", "validatePaths",
+        "isStartupUnchanged", "createWorkingSetupScript", "injectIntoHksFile",
+    };
+    for (const char* phase : phases) {
+        CHECK_MSG(!phaseLine(report, phase).empty(), phase);
+    }
+
+    // parseTomlConfig runs inside initializePaths
+    CHECK(phaseLine(report, "parseTomlConfig").find("\"parent\": \"initializePaths\"") != std::string::npos);
+
+    // The HKS injection read the script and wrote it back; the setup script was written
+    std::string inject = phaseLine(report, "injectIntoHksFile");
+    CHECK(counter(inject, "open") > 0);
+    CHECK(counter(inject, "read_bytes") > 0);
+    CHECK(counter(phaseLine(report, "createWorkingSetupScript"), "write_bytes") > 0);
+
+    std::string summary = StartupProfiler::formatSummary();
+    CHECK(!summary.empty());
+
+    std::printf("%s\n%s", summary.c_str(), report.c_str());
+
+    CHECK(waitForBackgroundIdle(5000));
+    DllMain(reinterpret_cast<HMODULE>(1), DLL_PROCESS_DETACH, nullptr);
+    return finish("test_startup_profile");
+}
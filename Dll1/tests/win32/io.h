@@ -0,0 +1,7 @@
+// =============================================
+// File: tests/win32/io.h
+// Category: Test Harness
+// Purpose: Empty stand-in for the MSVC <io.h> header included by Console.cpp.
+// =============================================
+#pragma once
+#include <unistd.h>
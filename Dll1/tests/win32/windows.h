@@ -0,0 +1,602 @@
+// =============================================
+// File: tests/win32/windows.h
+// Category: Test Harness
+// Purpose: POSIX stand-in for the Win32 calls the loader sources make, so they build and run on Linux.
+// =============================================
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// =============================================
+// Types and constants
+// =============================================
+
+using HANDLE = void*;
+using HMODULE = void*;
+using LPVOID = void*;
+using DWORD = std::uint32_t;
+using BOOL = int;
+using WORD = std::uint16_t;
+using LPCWSTR = const wchar_t*;
+
+union LARGE_INTEGER {
+    std::int64_t QuadPart;
+};
+
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define APIENTRY
+#define WINAPI
+#define __declspec(x)
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<std::intptr_t>(-1)))
+
+#define GENERIC_READ 0x80000000u
+#define GENERIC_WRITE 0x40000000u
+#define FILE_SHARE_READ 0x1u
+#define FILE_SHARE_WRITE 0x2u
+#define FILE_SHARE_DELETE 0x4u
+#define CREATE_NEW 1u
+#define CREATE_ALWAYS 2u
+#define OPEN_EXISTING 3u
+#define FILE_ATTRIBUTE_NORMAL 0x80u
+#define FILE_FLAG_SEQUENTIAL_SCAN 0x08000000u
+#define PAGE_READONLY 0x02u
+#define FILE_MAP_READ 0x04u
+#define MOVEFILE_REPLACE_EXISTING 0x1u
+#define MOVEFILE_WRITE_THROUGH 0x8u
+
+#define ERROR_SUCCESS 0u
+#define ERROR_FILE_NOT_FOUND 2u
+#define ERROR_ACCESS_DENIED 5u
+#define ERROR_INVALID_HANDLE 6u
+#define ERROR_WRITE_FAULT 29u
+#define ERROR_FILE_EXISTS 80u
+#define ERROR_DISK_FULL 112u
+#define ERROR_ALREADY_EXISTS 183u
+
+#define THREAD_MODE_BACKGROUND_BEGIN 0x00010000
+#define GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT 0x2u
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS 0x4u
+#define INFINITE 0xFFFFFFFFu
+#define WAIT_OBJECT_0 0u
+#define WAIT_TIMEOUT 258u
+#define WAIT_FAILED 0xFFFFFFFFu
+
+#define FILE_NOTIFY_CHANGE_FILE_NAME 0x1u
+#define FILE_NOTIFY_CHANGE_DIR_NAME 0x2u
+#define FILE_NOTIFY_CHANGE_SIZE 0x8u
+#define FILE_NOTIFY_CHANGE_LAST_WRITE 0x10u
+
+#define DLL_PROCESS_DETACH 0
+#define DLL_PROCESS_ATTACH 1
+
+#define CP_UTF8 65001u
+#define STD_OUTPUT_HANDLE (static_cast<DWORD>(-11))
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x4u
+#define FOREGROUND_BLUE 0x1u
+#define FOREGROUND_GREEN 0x2u
+#define FOREGROUND_RED 0x4u
+
+// =============================================
+// Test hooks
+// =============================================
+// Tests use these to pose as the loaded DLL and to inject I/O faults.
+namespace Win32Stub {
+
+    struct Faults {
+        std::atomic<long long> writeBudget{ -1 };   // Bytes WriteFile may still write; -1 = unlimited
+        std::atomic<int> failFlushes{ 0 };          // Next N FlushFileBuffers calls fail
+        std::atomic<int> failMoves{ 0 };            // Next N MoveFileExW calls fail
+        std::atomic<int> failCreates{ 0 };          // Next N CreateFileW calls for writing fail
+        std::atomic<int> flushDelayMs{ 0 };         // Added to every FlushFileBuffers call, like a slow disk
+    };
+
+    inline Faults& faults() {
+        static Faults instance;
+        return instance;
+    }
+
+    // Simulates a full disk: writes stop after bytes more bytes
+    inline void failWritesAfter(long long bytes) { faults().writeBudget.store(bytes); }
+    inline void failNextFlushes(int count) { faults().failFlushes.store(count); }
+    inline void failNextMoves(int count) { faults().failMoves.store(count); }
+    inline void failNextCreates(int count) { faults().failCreates.store(count); }
+    inline void delayFlushes(int milliseconds) { faults().flushDelayMs.store(milliseconds); }
+
+    inline void resetFaults() {
+        faults().writeBudget.store(-1);
+        faults().failFlushes.store(0);
+        faults().failMoves.store(0);
+        faults().failCreates.store(0);
+        faults().flushDelayMs.store(0);
+    }
+
+    inline bool consumeFault(std::atomic<int>& counter) {
+        int current = counter.load();
+        while (current > 0) {
+            if (counter.compare_exchange_weak(current, current - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // File name GetModuleFileNameA reports for a module handle other than the executable
+    inline std::string& moduleFileName() {
+        static std::string path;
+        return path;
+    }
+
+    inline void setModuleFileName(const std::string& path) { moduleFileName() = path; }
+
+    // References GetModuleHandleExW has taken on the loader and FreeLibrary not yet
+    // dropped; zero once no thread pins it
+    inline std::atomic<int>& moduleReferences() {
+        static std::atomic<int> count{ 0 };
+        return count;
+    }
+
+    // Polls until moduleReferences() reaches zero (threads exit asynchronously)
+    inline bool waitForModuleReleased(int timeoutMs) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (moduleReferences().load() != 0) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // Where writes to "CONOUT$" go; /dev/null unless LUALOADER_TEST_CONSOLE names a file
+    inline const char* consolePath() {
+        const char* path = std::getenv("LUALOADER_TEST_CONSOLE");
+        return path && *path ? path : "/dev/null";
+    }
+
+    inline DWORD& lastError() {
+        thread_local DWORD error = ERROR_SUCCESS;
+        return error;
+    }
+
+    // Every HANDLE the shim hands out points at one of these
+    struct Object {
+        enum Kind { File, Mapping, Event, Change, Thread };
+        explicit Object(Kind k) : kind(k) {}
+        virtual ~Object() = default;
+        Kind kind;
+    };
+
+    struct FileObject : Object {
+        FileObject() : Object(File) {}
+        int fd = -1;
+    };
+
+    struct MappingObject : Object {
+        MappingObject() : Object(Mapping) {}
+        int fd = -1;
+        size_t size = 0;
+    };
+
+    struct EventObject : Object {
+        EventObject() : Object(Event) {}
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool signaled = false;
+        bool manualReset = true;
+    };
+
+    // Signalled once the thread has exited
+    struct ThreadObject : Object {
+        ThreadObject() : Object(Thread) {}
+        std::shared_ptr<std::atomic<bool>> exited = std::make_shared<std::atomic<bool>>(false);
+    };
+
+    // Directory change notification, emulated by polling a listing stamp
+    struct ChangeObject : Object {
+        ChangeObject() : Object(Change) {}
+        std::string directory;
+        std::string armedStamp;
+    };
+
+    inline std::string stampDirectory(const std::string& directory) {
+        std::string stamp;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            struct stat info {};
+            if (::stat(it->path().c_str(), &info) != 0) continue;
+            stamp += it->path().filename().string();
+            stamp += '|' + std::to_string(info.st_size) + '|' + std::to_string(info.st_mtim.tv_sec) + '.' +
+                std::to_string(info.st_mtim.tv_nsec) + '\n';
+        }
+        return stamp;
+    }
+
+    inline std::mutex& viewMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    inline std::map<const void*, size_t>& viewSizes() {
+        static std::map<const void*, size_t> sizes;
+        return sizes;
+    }
+
+    inline std::string narrow(const wchar_t* path) {
+        return std::filesystem::path(path).string();
+    }
+
+    inline bool isSignaled(Object* object) {
+        if (object->kind == Object::Event) {
+            auto* event = static_cast<EventObject*>(object);
+            std::lock_guard<std::mutex> lock(event->mutex);
+            return event->signaled;
+        }
+        if (object->kind == Object::Change) {
+            auto* change = static_cast<ChangeObject*>(object);
+            return stampDirectory(change->directory) != change->armedStamp;
+        }
+        if (object->kind == Object::Thread) {
+            return static_cast<ThreadObject*>(object)->exited->load();
+        }
+        return false;
+    }
+
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(5);
+}
+
+// =============================================
+// Errors, processes, modules, threads
+// =============================================
+
+inline DWORD GetLastError() { return Win32Stub::lastError(); }
+inline void SetLastError(DWORD error) { Win32Stub::lastError() = error; }
+
+inline DWORD GetCurrentProcessId() { return static_cast<DWORD>(::getpid()); }
+
+inline DWORD GetModuleFileNameA(HMODULE module, char* buffer, DWORD size) {
+    std::string path;
+    if (module) {
+        path = Win32Stub::moduleFileName();
+    }
+    else {
+        std::error_code ec;
+        path = std::filesystem::read_symlink("/proc/self/exe", ec).string();
+    }
+    if (path.empty() || size == 0) {
+        return 0;
+    }
+    size_t copied = std::min<size_t>(path.size(), size - 1);
+    std::memcpy(buffer, path.data(), copied);
+    buffer[copied] = '\0';
+    return static_cast<DWORD>(copied);
+}
+
+inline BOOL DisableThreadLibraryCalls(HMODULE) { return TRUE; }
+inline HANDLE GetCurrentThread() { return reinterpret_cast<HANDLE>(static_cast<std::intptr_t>(-2)); }
+inline BOOL SetThreadPriority(HANDLE, int) { return TRUE; }
+
+// Every address belongs to the one module under test; its references are counted
+inline BOOL GetModuleHandleExW(DWORD flags, LPCWSTR, HMODULE* module) {
+    if ((flags & GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT) == 0) {
+        Win32Stub::moduleReferences()++;
+    }
+    *module = reinterpret_cast<HMODULE>(1);
+    return TRUE;
+}
+
+inline BOOL FreeLibrary(HMODULE) {
+    Win32Stub::moduleReferences()--;
+    return TRUE;
+}
+
+// Drops the reference and ends the calling thread (a pthread started by CreateThread)
+[[noreturn]] inline void FreeLibraryAndExitThread(HMODULE module, DWORD) {
+    FreeLibrary(module);
+    ::pthread_exit(nullptr);
+}
+
+using LPTHREAD_START_ROUTINE = DWORD (*)(LPVOID);
+
+namespace Win32Stub {
+    struct ThreadStart {
+        LPTHREAD_START_ROUTINE routine;
+        LPVOID parameter;
+        std::shared_ptr<std::atomic<bool>> exited;
+    };
+
+    inline void markExited(void* exited) {
+        static_cast<std::atomic<bool>*>(exited)->store(true);
+    }
+
+    inline void* threadMain(void* parameter) {
+        ThreadStart start = *static_cast<ThreadStart*>(parameter);
+        delete static_cast<ThreadStart*>(parameter);
+        // Also runs when the thread leaves through pthread_exit
+        pthread_cleanup_push(markExited, start.exited.get());
+        start.routine(start.parameter);
+        pthread_cleanup_pop(1);
+        return nullptr;
+    }
+}
+
+inline HANDLE CreateThread(void*, size_t, LPTHREAD_START_ROUTINE routine, LPVOID parameter, DWORD, DWORD*) {
+    auto* thread = new Win32Stub::ThreadObject();
+    auto* start = new Win32Stub::ThreadStart{ routine, parameter, thread->exited };
+    pthread_t id;
+    if (::pthread_create(&id, nullptr, Win32Stub::threadMain, start) != 0) {
+        delete start;
+        delete thread;
+        SetLastError(ERROR_ACCESS_DENIED);
+        return nullptr;
+    }
+    ::pthread_detach(id);
+    return thread;
+}
+
+// =============================================
+// Files and mappings
+// =============================================
+
+inline HANDLE CreateFileW(const wchar_t* path, DWORD access, DWORD, void*, DWORD disposition, DWORD, HANDLE) {
+    bool writing = (access & GENERIC_WRITE) != 0;
+    if (writing && Win32Stub::consumeFault(Win32Stub::faults().failCreates)) {
+        SetLastError(ERROR_ACCESS_DENIED);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    int flags = writing ? O_WRONLY : O_RDONLY;
+    if (disposition == CREATE_ALWAYS) flags |= O_CREAT | O_TRUNC;
+    if (disposition == CREATE_NEW) flags |= O_CREAT | O_EXCL;
+    int fd = ::open(Win32Stub::narrow(path).c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        SetLastError(errno == EEXIST ? ERROR_FILE_EXISTS : errno == ENOENT ? ERROR_FILE_NOT_FOUND : ERROR_ACCESS_DENIED);
+        return INVALID_HANDLE_VALUE;
+    }
+    auto* file = new Win32Stub::FileObject();
+    file->fd = fd;
+    return file;
+}
+
+inline BOOL GetFileSizeEx(HANDLE handle, LARGE_INTEGER* size) {
+    auto* file = static_cast<Win32Stub::FileObject*>(handle);
+    struct stat info {};
+    if (::fstat(file->fd, &info) != 0) {
+        return FALSE;
+    }
+    size->QuadPart = info.st_size;
+    return TRUE;
+}
+
+inline BOOL WriteFile(HANDLE handle, const void* data, DWORD length, DWORD* written, void*) {
+    auto* file = static_cast<Win32Stub::FileObject*>(handle);
+    *written = 0;
+
+    // A full disk accepts what fits and then fails
+    DWORD allowed = length;
+    long long budget = Win32Stub::faults().writeBudget.load();
+    if (budget >= 0) {
+        allowed = static_cast<DWORD>(std::min<long long>(budget, length));
+        Win32Stub::faults().writeBudget.store(budget - allowed);
+    }
+
+    const char* bytes = static_cast<const char*>(data);
+    while (*written < allowed) {
+        ssize_t done = ::write(file->fd, bytes + *written, allowed - *written);
+        if (done <= 0) {
+            SetLastError(ERROR_WRITE_FAULT);
+            return FALSE;
+        }
+        *written += static_cast<DWORD>(done);
+    }
+    if (allowed < length) {
+        SetLastError(ERROR_DISK_FULL);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+inline BOOL FlushFileBuffers(HANDLE handle) {
+    if (Win32Stub::consumeFault(Win32Stub::faults().failFlushes)) {
+        SetLastError(ERROR_WRITE_FAULT);
+        return FALSE;
+    }
+    if (int delay = Win32Stub::faults().flushDelayMs.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    }
+    return ::fsync(static_cast<Win32Stub::FileObject*>(handle)->fd) == 0 ? TRUE : FALSE;
+}
+
+inline HANDLE CreateFileMappingW(HANDLE handle, void*, DWORD, DWORD, DWORD, const wchar_t*) {
+    auto* file = static_cast<Win32Stub::FileObject*>(handle);
+    struct stat info {};
+    if (::fstat(file->fd, &info) != 0 || info.st_size == 0) {
+        return nullptr;
+    }
+    auto* mapping = new Win32Stub::MappingObject();
+    mapping->fd = file->fd;
+    mapping->size = static_cast<size_t>(info.st_size);
+    return mapping;
+}
+
+inline void* MapViewOfFile(HANDLE handle, DWORD, DWORD, DWORD, size_t) {
+    auto* mapping = static_cast<Win32Stub::MappingObject*>(handle);
+    void* view = ::mmap(nullptr, mapping->size, PROT_READ, MAP_PRIVATE, mapping->fd, 0);
+    if (view == MAP_FAILED) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(Win32Stub::viewMutex());
+    Win32Stub::viewSizes()[view] = mapping->size;
+    return view;
+}
+
+inline BOOL UnmapViewOfFile(const void* view) {
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> lock(Win32Stub::viewMutex());
+        auto it = Win32Stub::viewSizes().find(view);
+        if (it == Win32Stub::viewSizes().end()) {
+            return FALSE;
+        }
+        size = it->second;
+        Win32Stub::viewSizes().erase(it);
+    }
+    return ::munmap(const_cast<void*>(view), size) == 0 ? TRUE : FALSE;
+}
+
+inline BOOL MoveFileExW(const wchar_t* from, const wchar_t* to, DWORD) {
+    if (Win32Stub::consumeFault(Win32Stub::faults().failMoves)) {
+        SetLastError(ERROR_ACCESS_DENIED);
+        return FALSE;
+    }
+    if (::rename(Win32Stub::narrow(from).c_str(), Win32Stub::narrow(to).c_str()) != 0) {
+        SetLastError(ERROR_ACCESS_DENIED);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+inline BOOL DeleteFileW(const wchar_t* path) {
+    return ::unlink(Win32Stub::narrow(path).c_str()) == 0 ? TRUE : FALSE;
+}
+
+// =============================================
+// Events and change notifications
+// =============================================
+
+inline HANDLE CreateEventW(void*, BOOL manualReset, BOOL initialState, const wchar_t*) {
+    auto* event = new Win32Stub::EventObject();
+    event->manualReset = manualReset != FALSE;
+    event->signaled = initialState != FALSE;
+    return event;
+}
+
+inline BOOL SetEvent(HANDLE handle) {
+    auto* event = static_cast<Win32Stub::EventObject*>(handle);
+    {
+        std::lock_guard<std::mutex> lock(event->mutex);
+        event->signaled = true;
+    }
+    event->changed.notify_all();
+    return TRUE;
+}
+
+inline BOOL ResetEvent(HANDLE handle) {
+    auto* event = static_cast<Win32Stub::EventObject*>(handle);
+    std::lock_guard<std::mutex> lock(event->mutex);
+    event->signaled = false;
+    return TRUE;
+}
+
+inline HANDLE FindFirstChangeNotificationW(const wchar_t* directory, BOOL, DWORD) {
+    std::string dir = Win32Stub::narrow(directory);
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) {
+        SetLastError(ERROR_FILE_NOT_FOUND);
+        return INVALID_HANDLE_VALUE;
+    }
+    auto* change = new Win32Stub::ChangeObject();
+    change->directory = dir;
+    change->armedStamp = Win32Stub::stampDirectory(dir);
+    return change;
+}
+
+inline BOOL FindNextChangeNotification(HANDLE handle) {
+    auto* change = static_cast<Win32Stub::ChangeObject*>(handle);
+    change->armedStamp = Win32Stub::stampDirectory(change->directory);
+    return TRUE;
+}
+
+inline BOOL FindCloseChangeNotification(HANDLE handle) {
+    delete static_cast<Win32Stub::ChangeObject*>(handle);
+    return TRUE;
+}
+
+inline DWORD WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL, DWORD timeoutMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        for (DWORD i = 0; i < count; ++i) {
+            auto* object = static_cast<Win32Stub::Object*>(handles[i]);
+            if (Win32Stub::isSignaled(object)) {
+                if (object->kind == Win32Stub::Object::Event && !static_cast<Win32Stub::EventObject*>(object)->manualReset) {
+                    ResetEvent(object);
+                }
+                return WAIT_OBJECT_0 + i;
+            }
+        }
+        if (timeoutMs != INFINITE && std::chrono::steady_clock::now() >= deadline) {
+            return WAIT_TIMEOUT;
+        }
+        std::this_thread::sleep_for(Win32Stub::POLL_INTERVAL);
+    }
+}
+
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD timeoutMs) {
+    return WaitForMultipleObjects(1, &handle, FALSE, timeoutMs);
+}
+
+inline BOOL CloseHandle(HANDLE handle) {
+    auto* object = static_cast<Win32Stub::Object*>(handle);
+    if (!object || handle == INVALID_HANDLE_VALUE) {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+    if (object->kind == Win32Stub::Object::File) {
+        ::close(static_cast<Win32Stub::FileObject*>(object)->fd);
+    }
+    delete object;
+    return TRUE;
+}
+
+// =============================================
+// Console (no console on Linux; logging goes to Win32Stub::consolePath())
+// =============================================
+
+inline BOOL AllocConsole() { return TRUE; }
+inline BOOL FreeConsole() { return TRUE; }
+inline BOOL SetConsoleTitleW(const wchar_t*) { return TRUE; }
+#define SetConsoleTitle SetConsoleTitleW
+inline BOOL SetConsoleOutputCP(unsigned) { return TRUE; }
+inline BOOL SetConsoleCP(unsigned) { return TRUE; }
+inline HANDLE GetStdHandle(DWORD) { return nullptr; }
+inline BOOL GetConsoleMode(HANDLE, DWORD* mode) { *mode = 0; return TRUE; }
+inline BOOL SetConsoleMode(HANDLE, DWORD) { return TRUE; }
+inline BOOL SetConsoleTextAttribute(HANDLE, WORD) { return TRUE; }
+
+// =============================================
+// MSVC CRT functions
+// =============================================
+
+inline int fopen_s(FILE** file, const char* path, const char* mode) {
+    if (std::strcmp(path, "CONOUT$") == 0) {
+        path = Win32Stub::consolePath();
+    }
+    *file = std::fopen(path, mode);
+    return *file ? 0 : errno;
+}
+
+// The test process keeps its own standard streams
+inline int freopen_s(FILE**, const char*, const char*, FILE*) { return 0; }
+
+inline int localtime_s(std::tm* out, const std::time_t* time) {
+    return ::localtime_r(time, out) ? 0 : EINVAL;
+}